@@ -89,6 +89,20 @@ void HandleHeap::markWeakHandles(HeapRootMarker& heapRootMarker)
     }
 }
 
+#if ENABLE(GGC)
+// A minor collection does not trace old objects, so it never sees the opaque
+// roots that keep weakly held objects alive. New objects held by weak handles
+// survive until the next full collection instead.
+void HandleHeap::markWeakHandlesAsStrong(HeapRootMarker& heapRootMarker)
+{
+    Node* end = m_weakList.end();
+    for (Node* node = m_weakList.begin(); node != end; node = node->next()) {
+        ASSERT(isValidWeakNode(node));
+        heapRootMarker.mark(node->slot());
+    }
+}
+#endif
+
 void HandleHeap::finalizeWeakHandles()
 {
     Node* end = m_weakList.end();
@@ -63,6 +63,9 @@ public:
 
     void markStrongHandles(HeapRootMarker&);
     void markWeakHandles(HeapRootMarker&);
+#if ENABLE(GGC)
+    void markWeakHandlesAsStrong(HeapRootMarker&);
+#endif
     void finalizeWeakHandles();
 
     void writeBarrier(HandleSlot, const JSValue&);
@@ -31,6 +31,11 @@
 #include "JSONObject.h"
 #include "Tracing.h"
 #include <algorithm>
+#include <wtf/CurrentTime.h>
+
+#if ENABLE(PARALLEL_GC) && OS(UNIX)
+#include <unistd.h>
+#endif
 
 #define COLLECT_ON_EVERY_SLOW_ALLOCATION 0
 
@@ -40,6 +45,25 @@ namespace JSC {
 
 const size_t minBytesPerCycle = 512 * 1024;
 
+#if ENABLE(PARALLEL_GC)
+const unsigned maxDefaultMarkerCount = 4;
+
+static unsigned coreCount()
+{
+#if OS(UNIX)
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores > 1)
+        return static_cast<unsigned>(cores);
+#endif
+    return 1;
+}
+
+static unsigned defaultMarkerCount()
+{
+    return min(coreCount(), maxDefaultMarkerCount);
+}
+#endif
+
 Heap::Heap(JSGlobalData* globalData)
     : m_operationInProgress(NoOperation)
     , m_markedSpace(globalData)
@@ -47,11 +71,24 @@ Heap::Heap(JSGlobalData* globalData)
     , m_activityCallback(DefaultGCActivityCallback::create(this))
     , m_globalData(globalData)
     , m_machineThreads(this)
+#if ENABLE(PARALLEL_GC)
+    , m_markStackSharedData(globalData->jsArrayVPtr)
+    , m_markStack(globalData->jsArrayVPtr, &m_markStackSharedData)
+#else
     , m_markStack(globalData->jsArrayVPtr)
+#endif
     , m_handleHeap(globalData)
     , m_extraCost(0)
+    , m_shrinkAfterSweep(false)
+#if ENABLE(GGC)
+    , m_sizeAfterLastCollection(0)
+    , m_sizeAfterLastFullCollection(0)
+#endif
 {
     m_markedSpace.setHighWaterMark(minBytesPerCycle);
+#if ENABLE(PARALLEL_GC)
+    m_markStackSharedData.setMarkerCount(defaultMarkerCount());
+#endif
     (*m_activityCallback)();
 }
 
@@ -119,7 +156,7 @@ void* Heap::allocateSlowCase(size_t bytes)
     ASSERT(m_operationInProgress == NoOperation);
 #endif
 
-    reset(DoNotSweep);
+    reset(DoNotSweep, MinorCollection);
 
     m_operationInProgress = Allocation;
     void* result = m_markedSpace.allocate(bytes);
@@ -190,7 +227,7 @@ inline RegisterFile& Heap::registerFile()
     return m_globalData->interpreter->registerFile();
 }
 
-void Heap::markRoots()
+void Heap::markRoots(CollectionType collectionType)
 {
 #ifndef NDEBUG
     if (m_globalData->isSharedInstance()) {
@@ -219,7 +256,16 @@ void Heap::markRoots()
     ConservativeRoots registerFileRoots(this);
     registerFile().gatherConservativeRoots(registerFileRoots);
 
-    m_markedSpace.clearMarks();
+#if ENABLE(GGC)
+    // Old cells keep their mark bits through a minor collection, which makes
+    // the trace stop at them. Only cells allocated since the last collection
+    // are traced, plus the children of the old cells the write barrier
+    // remembered.
+    if (collectionType == MinorCollection)
+        m_markedSpace.clearNewlyAllocatedMarks();
+    else
+#endif
+        m_markedSpace.clearMarks();
 
     markStack.append(machineThreadRoots);
     markStack.drain();
@@ -227,6 +273,16 @@ void Heap::markRoots()
     markStack.append(registerFileRoots);
     markStack.drain();
 
+#if ENABLE(GGC)
+    if (collectionType == MinorCollection) {
+        for (size_t i = 0; i < m_rememberedSet.size(); ++i)
+            markStack.appendChildren(m_rememberedSet[i]);
+        markStack.drain();
+    }
+#else
+    UNUSED_PARAM(collectionType);
+#endif
+
     markProtectedObjects(heapRootMarker);
     markStack.drain();
     
@@ -251,6 +307,13 @@ void Heap::markRoots()
     m_globalData->smallStrings.markChildren(heapRootMarker);
     markStack.drain();
     
+#if ENABLE(GGC)
+    if (collectionType == MinorCollection) {
+        m_handleHeap.markWeakHandlesAsStrong(heapRootMarker);
+        markStack.drain();
+    }
+#endif
+
     // Weak handles must be marked last, because their owners use the set of
     // opaque roots to determine reachability.
     int lastOpaqueRootCount;
@@ -261,6 +324,12 @@ void Heap::markRoots()
     // If the set of opaque roots has grown, more weak handles may have become reachable.
     } while (lastOpaqueRootCount != markStack.opaqueRootCount());
 
+#if ENABLE(GGC)
+    // Every new cell that survived is old once marking is done, so nothing
+    // remembered so far can point to a new cell any more.
+    clearRememberedSet();
+#endif
+
     markStack.reset();
 
     m_operationInProgress = NoOperation;
@@ -386,12 +455,82 @@ void Heap::collectAllGarbage()
     reset(DoSweep);
 }
 
-void Heap::reset(SweepToggle sweepToggle)
+bool Heap::sweepIncrementally(double timeSlice)
+{
+    ASSERT(globalData()->identifierTable == wtfThreadData().currentIdentifierTable());
+    ASSERT(m_operationInProgress == NoOperation);
+    if (m_operationInProgress != NoOperation)
+        CRASH();
+
+    m_operationInProgress = Collection;
+    bool done = m_markedSpace.sweepIncrementally(currentTime() + timeSlice);
+    if (done && m_shrinkAfterSweep) {
+        m_markedSpace.shrink();
+        m_shrinkAfterSweep = false;
+    }
+    m_operationInProgress = NoOperation;
+
+    return done;
+}
+
+#if ENABLE(GGC)
+void writeBarrier(JSGlobalData& globalData, const JSCell* owner, JSValue value)
+{
+    if (value.isCell())
+        writeBarrier(globalData, owner, value.asCell());
+}
+
+void writeBarrier(JSGlobalData& globalData, const JSCell* owner, JSCell* cell)
+{
+    if (owner && cell)
+        globalData.heap.writeBarrier(owner, cell);
+}
+#endif
+
+void Heap::setMarkerCount(unsigned count)
+{
+    ASSERT(m_operationInProgress == NoOperation);
+#if ENABLE(PARALLEL_GC)
+    // more markers than cores only adds contention
+    m_markStackSharedData.setMarkerCount(min(max(count, 1u), coreCount()));
+#else
+    UNUSED_PARAM(count);
+#endif
+}
+
+unsigned Heap::markerCount() const
+{
+#if ENABLE(PARALLEL_GC)
+    return m_markStackSharedData.markerCount();
+#else
+    return 1;
+#endif
+}
+
+#if ENABLE(GGC)
+void Heap::clearRememberedSet()
+{
+    for (size_t i = 0; i < m_rememberedSet.size(); ++i)
+        MarkedBlock::blockFor(m_rememberedSet[i])->clearRemembered(m_rememberedSet[i]);
+    m_rememberedSet.clear();
+}
+#endif
+
+void Heap::reset(SweepToggle sweepToggle, CollectionType collectionType)
 {
     ASSERT(globalData()->identifierTable == wtfThreadData().currentIdentifierTable());
     JAVASCRIPTCORE_GC_BEGIN();
 
-    markRoots();
+#if ENABLE(GGC)
+    // Only a full collection reclaims old cells that have died, so fall back
+    // to one once the old generation has doubled since the last.
+    if (m_sizeAfterLastCollection > 2 * max(m_sizeAfterLastFullCollection, minBytesPerCycle))
+        collectionType = FullCollection;
+#else
+    collectionType = FullCollection;
+#endif
+
+    markRoots(collectionType);
     m_handleHeap.finalizeWeakHandles();
 
     JAVASCRIPTCORE_GC_MARKED();
@@ -399,22 +538,51 @@ void Heap::reset(SweepToggle sweepToggle)
     m_markedSpace.reset();
     m_extraCost = 0;
 
+    // Garbage from this collection is not flagged for sweeping unless it is
+    // a DoSweep collection, so a shrink left over from an earlier one is no
+    // longer safe.
+    m_shrinkAfterSweep = false;
+
 #if ENABLE(JSC_ZOMBIES)
     sweepToggle = DoSweep;
 #endif
 
     if (sweepToggle == DoSweep) {
-        m_markedSpace.sweep();
-        m_markedSpace.shrink();
+        // Unswept garbage may still point into empty blocks, and conservative
+        // scanning can find it again, so empty blocks are only released once
+        // every block has been swept. The sweep runs while the heap is idle
+        // if the platform can schedule it; destructors for the garbage run
+        // as the allocator reuses the cells until then. Zombies are created
+        // by the sweep itself, so it is never deferred.
+#if ENABLE(JSC_ZOMBIES)
+        bool deferSweep = false;
+#else
+        m_markedSpace.setNeedsSweep();
+        bool deferSweep = m_activityCallback->scheduleSweep();
+#endif
+        if (deferSweep)
+            m_shrinkAfterSweep = true;
+        else {
+            m_markedSpace.sweep();
+            m_markedSpace.shrink();
+        }
     }
 
     // To avoid pathological GC churn in large heaps, we set the allocation high
     // water mark to be proportional to the current size of the heap. The exact
     // proportion is a bit arbitrary. A 2X multiplier gives a 1:1 (heap size :
     // new bytes allocated) proportion, and seems to work well in benchmarks.
+    // Minor and full collections share the policy; after a minor collection
+    // the size includes old cells that may have died since the last full one.
     size_t proportionalBytes = 2 * m_markedSpace.size();
     m_markedSpace.setHighWaterMark(max(proportionalBytes, minBytesPerCycle));
 
+#if ENABLE(GGC)
+    m_sizeAfterLastCollection = m_markedSpace.size();
+    if (collectionType == FullCollection)
+        m_sizeAfterLastFullCollection = m_sizeAfterLastCollection;
+#endif
+
     JAVASCRIPTCORE_GC_END();
 
     (*m_activityCallback)();
@@ -76,8 +76,22 @@ namespace JSC {
         void* allocate(size_t);
         void collectAllGarbage();
 
+        // Finishes a sweep deferred by collectAllGarbage(), spending at most
+        // about timeSlice seconds. Returns true once the heap is fully swept.
+        bool sweepIncrementally(double timeSlice);
+
+        // Number of threads marking during a collection, including the
+        // collecting one, clamped to the number of cores. Always 1 without
+        // ENABLE(PARALLEL_GC).
+        void setMarkerCount(unsigned);
+        unsigned markerCount() const;
+
         void reportExtraMemoryCost(size_t cost);
 
+#if ENABLE(GGC)
+        void writeBarrier(const JSCell* owner, JSCell*);
+#endif
+
         void protect(JSValue);
         bool unprotect(JSValue); // True when the protect count drops to 0.
 
@@ -113,12 +127,17 @@ namespace JSC {
         void* allocateSlowCase(size_t);
         void reportExtraMemoryCostSlowCase(size_t);
 
-        void markRoots();
+        enum CollectionType { FullCollection, MinorCollection };
+        void markRoots(CollectionType);
         void markProtectedObjects(HeapRootMarker&);
         void markTempSortVectors(HeapRootMarker&);
 
         enum SweepToggle { DoNotSweep, DoSweep };
-        void reset(SweepToggle);
+        void reset(SweepToggle, CollectionType = FullCollection);
+
+#if ENABLE(GGC)
+        void clearRememberedSet();
+#endif
 
         RegisterFile& registerFile();
 
@@ -135,11 +154,21 @@ namespace JSC {
         JSGlobalData* m_globalData;
         
         MachineThreads m_machineThreads;
+#if ENABLE(PARALLEL_GC)
+        MarkStackSharedData m_markStackSharedData;
+#endif
         MarkStack m_markStack;
         HandleHeap m_handleHeap;
         HandleStack m_handleStack;
 
         size_t m_extraCost;
+        bool m_shrinkAfterSweep;
+
+#if ENABLE(GGC)
+        Vector<JSCell*> m_rememberedSet; // Old cells that were given a pointer to a new cell.
+        size_t m_sizeAfterLastCollection;
+        size_t m_sizeAfterLastFullCollection;
+#endif
     };
 
     inline bool Heap::isMarked(const JSCell* cell)
@@ -168,6 +197,20 @@ namespace JSC {
             reportExtraMemoryCostSlowCase(cost);
     }
 
+#if ENABLE(GGC)
+    inline void Heap::writeBarrier(const JSCell* owner, JSCell* cell)
+    {
+        if (!MarkedBlock::blockFor(cell)->isNewlyAllocated(cell))
+            return;
+
+        MarkedBlock* ownerBlock = MarkedBlock::blockFor(owner);
+        if (ownerBlock->isNewlyAllocated(owner) || ownerBlock->testAndSetRemembered(owner))
+            return;
+
+        m_rememberedSet.append(const_cast<JSCell*>(owner));
+    }
+#endif
+
     template <typename Functor> inline void Heap::forEach(Functor& functor)
     {
         m_markedSpace.forEach(functor);
@@ -36,6 +36,11 @@
 
 namespace JSC {
 
+#if ENABLE(PARALLEL_GC)
+// A marker shares cells once it has more than this, and others have none
+static const size_t minimumCellsToDonate = 64;
+#endif
+
 size_t MarkStack::s_pageSize = 0;
 
 void MarkStack::reset()
@@ -84,6 +89,20 @@ inline void MarkStack::markChildren(JSCell* cell)
 
 void MarkStack::drain()
 {
+#if ENABLE(PARALLEL_GC)
+    if (m_sharedData && m_sharedData->markerCount() > 1) {
+        drainInParallel();
+        return;
+    }
+#endif
+    drainLocal();
+}
+
+void MarkStack::drainLocal()
+{
+#if ENABLE(PARALLEL_GC)
+    bool canDonate = m_sharedData && m_sharedData->markerCount() > 1;
+#endif
 #if !ASSERT_DISABLED
     ASSERT(!m_isDraining);
     m_isDraining = true;
@@ -124,12 +143,148 @@ void MarkStack::drain()
 
             markChildren(cell);
         }
-        while (!m_values.isEmpty())
+        while (!m_values.isEmpty()) {
             markChildren(m_values.removeLast());
+#if ENABLE(PARALLEL_GC)
+            // The unlocked read of the shared cells is only a hint
+            if (canDonate && m_values.size() > minimumCellsToDonate
+                && m_sharedData->m_sharedCells.isEmpty())
+                donateCells();
+#endif
+        }
     }
 #if !ASSERT_DISABLED
     m_isDraining = false;
 #endif
 }
 
+#if ENABLE(PARALLEL_GC)
+void MarkStack::donateCells()
+{
+    MutexLocker locker(m_sharedData->m_markingLock);
+    size_t donation = m_values.size() / 2;
+    for (size_t i = 0; i < donation; ++i)
+        m_sharedData->m_sharedCells.append(m_values.removeLast());
+    m_sharedData->m_markingCondition.broadcast();
+}
+
+// Must be called with the marking lock held.
+bool MarkStack::takeSharedCells()
+{
+    Vector<JSCell*>& sharedCells = m_sharedData->m_sharedCells;
+    if (sharedCells.isEmpty())
+        return false;
+
+    // Leave some for the other markers
+    size_t markerCount = m_sharedData->markerCount();
+    size_t count = (sharedCells.size() + markerCount - 1) / markerCount;
+    for (size_t i = 0; i < count; ++i) {
+        m_values.append(sharedCells.last());
+        sharedCells.removeLast();
+    }
+    return true;
+}
+
+// Must be called with the marking lock held.
+void MarkStack::donateOpaqueRoots()
+{
+    HashSet<void*>::iterator end = m_opaqueRoots.end();
+    for (HashSet<void*>::iterator it = m_opaqueRoots.begin(); it != end; ++it)
+        m_sharedData->m_opaqueRoots.add(*it);
+    m_opaqueRoots.clear();
+}
+
+void MarkStack::drainInParallel()
+{
+    MarkStackSharedData& sharedData = *m_sharedData;
+    while (true) {
+        drainLocal();
+
+        MutexLocker locker(sharedData.m_markingLock);
+        while (!takeSharedCells()) {
+            if (!sharedData.m_activeHelpers) {
+                // Nobody has cells left to mark, the helpers are done and
+                // waiting for the next drain.
+                HashSet<void*>::iterator end = sharedData.m_opaqueRoots.end();
+                for (HashSet<void*>::iterator it = sharedData.m_opaqueRoots.begin(); it != end; ++it)
+                    m_opaqueRoots.add(*it);
+                sharedData.m_opaqueRoots.clear();
+                return;
+            }
+            sharedData.m_markingCondition.wait(sharedData.m_markingLock);
+        }
+    }
+}
+
+MarkStackSharedData::MarkStackSharedData(void* jsArrayVPtr)
+    : m_jsArrayVPtr(jsArrayVPtr)
+    , m_markerCount(1)
+    , m_activeHelpers(0)
+    , m_helpersShouldExit(false)
+{
+}
+
+MarkStackSharedData::~MarkStackSharedData()
+{
+    stopMarkingThreads();
+}
+
+void MarkStackSharedData::setMarkerCount(unsigned count)
+{
+    stopMarkingThreads();
+
+    m_helpersShouldExit = false;
+    m_markerCount = 1;
+    for (unsigned i = 1; i < count; ++i) {
+        ThreadIdentifier thread = createThread(markingThreadStartFunc, this, "JavaScriptCore::Marking");
+        if (!thread)
+            break;
+        m_markingThreads.append(thread);
+        m_markerCount++;
+    }
+}
+
+void MarkStackSharedData::stopMarkingThreads()
+{
+    {
+        MutexLocker locker(m_markingLock);
+        m_helpersShouldExit = true;
+        m_markingCondition.broadcast();
+    }
+    for (size_t i = 0; i < m_markingThreads.size(); ++i)
+        waitForThreadCompletion(m_markingThreads[i], 0);
+    m_markingThreads.clear();
+    m_markerCount = 1;
+}
+
+void* MarkStackSharedData::markingThreadStartFunc(void* sharedData)
+{
+    static_cast<MarkStackSharedData*>(sharedData)->markingThreadMain();
+    return 0;
+}
+
+void MarkStackSharedData::markingThreadMain()
+{
+    MarkStack markStack(m_jsArrayVPtr, this);
+    while (true) {
+        {
+            MutexLocker locker(m_markingLock);
+            while (!markStack.takeSharedCells()) {
+                if (m_helpersShouldExit)
+                    return;
+                m_markingCondition.wait(m_markingLock);
+            }
+            m_activeHelpers++;
+        }
+
+        markStack.drainLocal();
+
+        MutexLocker locker(m_markingLock);
+        markStack.donateOpaqueRoots();
+        if (!--m_activeHelpers)
+            m_markingCondition.broadcast();
+    }
+}
+#endif // ENABLE(PARALLEL_GC)
+
 } // namespace JSC
@@ -34,10 +34,19 @@
 #include <wtf/Noncopyable.h>
 #include <wtf/OSAllocator.h>
 
+#if ENABLE(PARALLEL_GC)
+#include <wtf/Threading.h>
+
+#if !USE(ATOMIC_COMPARE_AND_SWAP)
+#error "Parallel marking needs an atomic compare and swap"
+#endif
+#endif
+
 namespace JSC {
 
     class ConservativeRoots;
     class JSGlobalData;
+    class MarkStackSharedData;
     class Register;
     
     enum MarkSetProperties { MayContainNullValues, NoNullValues };
@@ -45,8 +54,9 @@ namespace JSC {
     class MarkStack {
         WTF_MAKE_NONCOPYABLE(MarkStack);
     public:
-        MarkStack(void* jsArrayVPtr)
+        MarkStack(void* jsArrayVPtr, MarkStackSharedData* sharedData = 0)
             : m_jsArrayVPtr(jsArrayVPtr)
+            , m_sharedData(sharedData)
 #if !ASSERT_DISABLED
             , m_isCheckingForDefaultMarkViolation(false)
             , m_isDraining(false)
@@ -72,6 +82,12 @@ namespace JSC {
         
         void append(ConservativeRoots&);
 
+#if ENABLE(GGC)
+        // Traces the children of a cell that is already marked. Minor
+        // collections use this for the old cells in the remembered set.
+        void appendChildren(JSCell* cell) { m_values.append(cell); }
+#endif
+
         bool addOpaqueRoot(void* root) { return m_opaqueRoots.add(root).second; }
         bool containsOpaqueRoot(void* root) { return m_opaqueRoots.contains(root); }
         int opaqueRootCount() { return m_opaqueRoots.size(); }
@@ -81,6 +97,7 @@ namespace JSC {
 
     private:
         friend class HeapRootMarker; // Allowed to mark a JSValue* or JSCell** directly.
+        friend class MarkStackSharedData;
         void append(JSValue*);
         void append(JSValue*, size_t count);
         void append(JSCell**);
@@ -88,6 +105,14 @@ namespace JSC {
         void internalAppend(JSCell*);
         void internalAppend(JSValue);
         void markChildren(JSCell*);
+        void drainLocal();
+
+#if ENABLE(PARALLEL_GC)
+        void drainInParallel();
+        void donateCells();
+        bool takeSharedCells();
+        void donateOpaqueRoots();
+#endif
 
         struct MarkSet {
             MarkSet(JSValue* values, JSValue* end, MarkSetProperties properties)
@@ -190,6 +215,7 @@ namespace JSC {
         };
 
         void* m_jsArrayVPtr;
+        MarkStackSharedData* m_sharedData; // 0 when marking on a single thread
         MarkStackArray<MarkSet> m_markSets;
         MarkStackArray<JSCell*> m_values;
         static size_t s_pageSize;
@@ -202,6 +228,40 @@ namespace JSC {
 #endif
     };
 
+#if ENABLE(PARALLEL_GC)
+    // Work shared by the markers of a Heap. The collecting thread and the
+    // helper threads each drain their own MarkStack, donate cells here when
+    // others are short of work, and take from here when they run out.
+    class MarkStackSharedData {
+        WTF_MAKE_NONCOPYABLE(MarkStackSharedData);
+    public:
+        MarkStackSharedData(void* jsArrayVPtr);
+        ~MarkStackSharedData();
+
+        // The count includes the collecting thread, 1 marks serially.
+        void setMarkerCount(unsigned);
+        unsigned markerCount() const { return m_markerCount; }
+
+    private:
+        friend class MarkStack;
+
+        static void* markingThreadStartFunc(void*);
+        void markingThreadMain();
+        void stopMarkingThreads();
+
+        void* m_jsArrayVPtr;
+        unsigned m_markerCount;
+        Vector<ThreadIdentifier> m_markingThreads;
+
+        Mutex m_markingLock;
+        ThreadCondition m_markingCondition;
+        Vector<JSCell*> m_sharedCells;
+        unsigned m_activeHelpers; // helpers draining cells they took
+        bool m_helpersShouldExit;
+        HashSet<void*> m_opaqueRoots; // found by the helpers
+    };
+#endif
+
     inline void MarkStack::append(JSValue* slot, size_t count)
     {
         if (!count)
@@ -52,6 +52,7 @@ MarkedBlock::MarkedBlock(const PageAllocationAligned& allocation, JSGlobalData*
     : m_nextAtom(firstAtom())
     , m_allocation(allocation)
     , m_heap(&globalData->heap)
+    , m_needsSweep(false)
     , m_prev(0)
     , m_next(0)
 {
@@ -84,6 +85,8 @@ void MarkedBlock::sweep()
         new (cell) JSCell(*m_heap->globalData(), dummyMarkableCellStructure);
 #endif
     }
+
+    m_needsSweep = false;
 }
 
 } // namespace JSC
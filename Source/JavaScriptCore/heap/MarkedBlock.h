@@ -57,6 +57,11 @@ namespace JSC {
         void* allocate();
         void reset();
         void sweep();
+
+        // True once a collection has found garbage in this block that neither
+        // sweep() nor the allocator has destroyed yet.
+        bool needsSweep();
+        void setNeedsSweep();
         
         bool isEmpty();
 
@@ -73,6 +78,17 @@ namespace JSC {
         bool isMarked(const void*);
         bool testAndSetMarked(const void*);
         void setMarked(const void*);
+
+#if ENABLE(GGC)
+        // Cells allocated since the last collection; every other live cell is
+        // old and keeps its mark bit across minor collections.
+        bool isNewlyAllocated(const void*);
+        void clearNewlyAllocatedMarks();
+
+        // Old cells the write barrier has already put in the remembered set.
+        bool testAndSetRemembered(const void*);
+        void clearRemembered(const void*);
+#endif
         
         template <typename Functor> void forEach(Functor&);
 
@@ -93,8 +109,13 @@ namespace JSC {
         size_t m_endAtom; // This is a fuzzy end. Always test for < m_endAtom.
         size_t m_atomsPerCell;
         WTF::Bitmap<blockSize / atomSize> m_marks;
+#if ENABLE(GGC)
+        WTF::Bitmap<blockSize / atomSize> m_newlyAllocated;
+        WTF::Bitmap<blockSize / atomSize> m_remembered;
+#endif
         PageAllocationAligned m_allocation;
         Heap* m_heap;
+        bool m_needsSweep;
         MarkedBlock* m_prev;
         MarkedBlock* m_next;
     };
@@ -147,6 +168,20 @@ namespace JSC {
     inline void MarkedBlock::reset()
     {
         m_nextAtom = firstAtom();
+#if ENABLE(GGC)
+        // Whatever survived the collection is old from now on.
+        m_newlyAllocated.clearAll();
+#endif
+    }
+
+    inline bool MarkedBlock::needsSweep()
+    {
+        return m_needsSweep;
+    }
+
+    inline void MarkedBlock::setNeedsSweep()
+    {
+        m_needsSweep = true;
     }
 
     inline bool MarkedBlock::isEmpty()
@@ -202,7 +237,12 @@ namespace JSC {
 
     inline bool MarkedBlock::testAndSetMarked(const void* p)
     {
+#if ENABLE(PARALLEL_GC)
+        // Several markers may race to mark the same cell
+        return m_marks.concurrentTestAndSet(atomNumber(p));
+#else
         return m_marks.testAndSet(atomNumber(p));
+#endif
     }
 
     inline void MarkedBlock::setMarked(const void* p)
@@ -210,6 +250,28 @@ namespace JSC {
         m_marks.set(atomNumber(p));
     }
 
+#if ENABLE(GGC)
+    inline bool MarkedBlock::isNewlyAllocated(const void* p)
+    {
+        return m_newlyAllocated.get(atomNumber(p));
+    }
+
+    inline void MarkedBlock::clearNewlyAllocatedMarks()
+    {
+        m_marks.exclude(m_newlyAllocated);
+    }
+
+    inline bool MarkedBlock::testAndSetRemembered(const void* p)
+    {
+        return m_remembered.testAndSet(atomNumber(p));
+    }
+
+    inline void MarkedBlock::clearRemembered(const void* p)
+    {
+        m_remembered.clear(atomNumber(p));
+    }
+#endif
+
     template <typename Functor> inline void MarkedBlock::forEach(Functor& functor)
     {
         for (size_t i = firstAtom(); i < m_endAtom; i += m_atomsPerCell) {
@@ -26,6 +26,7 @@
 #include "JSLock.h"
 #include "JSObject.h"
 #include "ScopeChain.h"
+#include <wtf/CurrentTime.h>
 
 namespace JSC {
 
@@ -114,6 +115,15 @@ void MarkedSpace::clearMarks()
         (*it)->clearMarks();
 }
 
+#if ENABLE(GGC)
+void MarkedSpace::clearNewlyAllocatedMarks()
+{
+    BlockIterator end = m_blocks.end();
+    for (BlockIterator it = m_blocks.begin(); it != end; ++it)
+        (*it)->clearNewlyAllocatedMarks();
+}
+#endif
+
 void MarkedSpace::sweep()
 {
     BlockIterator end = m_blocks.end();
@@ -121,6 +131,29 @@ void MarkedSpace::sweep()
         (*it)->sweep();
 }
 
+void MarkedSpace::setNeedsSweep()
+{
+    BlockIterator end = m_blocks.end();
+    for (BlockIterator it = m_blocks.begin(); it != end; ++it)
+        (*it)->setNeedsSweep();
+}
+
+bool MarkedSpace::sweepIncrementally(double deadline)
+{
+    BlockIterator end = m_blocks.end();
+    for (BlockIterator it = m_blocks.begin(); it != end; ++it) {
+        MarkedBlock* block = *it;
+        if (!block->needsSweep())
+            continue;
+
+        // Always sweep at least one block, so that every call makes progress.
+        block->sweep();
+        if (currentTime() >= deadline)
+            return false;
+    }
+    return true;
+}
+
 size_t MarkedSpace::objectCount() const
 {
     size_t result = 0;
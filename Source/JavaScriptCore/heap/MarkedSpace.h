@@ -66,11 +66,19 @@ namespace JSC {
         void* allocate(size_t);
 
         void clearMarks();
+#if ENABLE(GGC)
+        void clearNewlyAllocatedMarks();
+#endif
         void markRoots();
         void reset();
         void sweep();
         void shrink();
 
+        // Defers sweeping: blocks are swept by the allocator as it reaches
+        // them, or by sweepIncrementally() when the heap is idle.
+        void setNeedsSweep();
+        bool sweepIncrementally(double deadline); // True when no block needs sweeping.
+
         size_t size() const;
         size_t capacity() const;
         size_t objectCount() const;
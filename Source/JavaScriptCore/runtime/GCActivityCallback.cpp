@@ -50,5 +50,10 @@ void DefaultGCActivityCallback::synchronize()
 {
 }
 
+bool DefaultGCActivityCallback::scheduleSweep()
+{
+    return false;
+}
+
 }
 
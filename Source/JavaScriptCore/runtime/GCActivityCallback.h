@@ -45,6 +45,10 @@ public:
     virtual ~GCActivityCallback() {}
     virtual void operator()() {}
     virtual void synchronize() {}
+    // Asks for Heap::sweepIncrementally() to be called while the heap is idle.
+    // Returns false if the platform cannot do that, in which case the
+    // collector sweeps before returning.
+    virtual bool scheduleSweep() { return false; }
 
 protected:
     GCActivityCallback() {}
@@ -61,6 +65,7 @@ public:
 
     void operator()();
     void synchronize();
+    bool scheduleSweep();
 
 #if USE(CF)
 protected:
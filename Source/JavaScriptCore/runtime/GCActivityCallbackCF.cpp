@@ -46,14 +46,18 @@ namespace JSC {
 
 struct DefaultGCActivityCallbackPlatformData {
     static void trigger(CFRunLoopTimerRef, void *info);
+    static void triggerSweep(CFRunLoopTimerRef, void *info);
 
     RetainPtr<CFRunLoopTimerRef> timer;
+    RetainPtr<CFRunLoopTimerRef> sweepTimer;
     RetainPtr<CFRunLoopRef> runLoop;
     CFRunLoopTimerContext context;
 };
 
 const CFTimeInterval decade = 60 * 60 * 24 * 365 * 10;
 const CFTimeInterval triggerInterval = 2; // seconds
+const CFTimeInterval sweepInterval = 0.1; // seconds
+const double sweepTimeSlice = 0.01; // seconds
 
 void DefaultGCActivityCallbackPlatformData::trigger(CFRunLoopTimerRef timer, void *info)
 {
@@ -63,6 +67,14 @@ void DefaultGCActivityCallbackPlatformData::trigger(CFRunLoopTimerRef timer, voi
     CFRunLoopTimerSetNextFireDate(timer, CFAbsoluteTimeGetCurrent() + decade);
 }
 
+void DefaultGCActivityCallbackPlatformData::triggerSweep(CFRunLoopTimerRef timer, void *info)
+{
+    Heap* heap = static_cast<Heap*>(info);
+    APIEntryShim shim(heap->globalData());
+    bool done = heap->sweepIncrementally(sweepTimeSlice);
+    CFRunLoopTimerSetNextFireDate(timer, CFAbsoluteTimeGetCurrent() + (done ? decade : sweepInterval));
+}
+
 DefaultGCActivityCallback::DefaultGCActivityCallback(Heap* heap)
 {
     commonConstructor(heap, CFRunLoopGetCurrent());
@@ -76,10 +88,13 @@ DefaultGCActivityCallback::DefaultGCActivityCallback(Heap* heap, CFRunLoopRef ru
 DefaultGCActivityCallback::~DefaultGCActivityCallback()
 {
     CFRunLoopRemoveTimer(d->runLoop.get(), d->timer.get(), kCFRunLoopCommonModes);
+    CFRunLoopRemoveTimer(d->runLoop.get(), d->sweepTimer.get(), kCFRunLoopCommonModes);
     CFRunLoopTimerInvalidate(d->timer.get());
+    CFRunLoopTimerInvalidate(d->sweepTimer.get());
     d->context.info = 0;
     d->runLoop = 0;
     d->timer = 0;
+    d->sweepTimer = 0;
 }
 
 void DefaultGCActivityCallback::commonConstructor(Heap* heap, CFRunLoopRef runLoop)
@@ -91,6 +106,8 @@ void DefaultGCActivityCallback::commonConstructor(Heap* heap, CFRunLoopRef runLo
     d->runLoop = runLoop;
     d->timer.adoptCF(CFRunLoopTimerCreate(0, decade, decade, 0, 0, DefaultGCActivityCallbackPlatformData::trigger, &d->context));
     CFRunLoopAddTimer(d->runLoop.get(), d->timer.get(), kCFRunLoopCommonModes);
+    d->sweepTimer.adoptCF(CFRunLoopTimerCreate(0, decade, decade, 0, 0, DefaultGCActivityCallbackPlatformData::triggerSweep, &d->context));
+    CFRunLoopAddTimer(d->runLoop.get(), d->sweepTimer.get(), kCFRunLoopCommonModes);
 }
 
 void DefaultGCActivityCallback::operator()()
@@ -98,13 +115,21 @@ void DefaultGCActivityCallback::operator()()
     CFRunLoopTimerSetNextFireDate(d->timer.get(), CFAbsoluteTimeGetCurrent() + triggerInterval);
 }
 
+bool DefaultGCActivityCallback::scheduleSweep()
+{
+    CFRunLoopTimerSetNextFireDate(d->sweepTimer.get(), CFAbsoluteTimeGetCurrent() + sweepInterval);
+    return true;
+}
+
 void DefaultGCActivityCallback::synchronize()
 {
     if (CFRunLoopGetCurrent() == d->runLoop.get())
         return;
     CFRunLoopRemoveTimer(d->runLoop.get(), d->timer.get(), kCFRunLoopCommonModes);
+    CFRunLoopRemoveTimer(d->runLoop.get(), d->sweepTimer.get(), kCFRunLoopCommonModes);
     d->runLoop = CFRunLoopGetCurrent();
     CFRunLoopAddTimer(d->runLoop.get(), d->timer.get(), kCFRunLoopCommonModes);
+    CFRunLoopAddTimer(d->runLoop.get(), d->sweepTimer.get(), kCFRunLoopCommonModes);
 }
 
 }
@@ -33,6 +33,7 @@
 #include "dtoa.h"
 #include "Identifier.h"
 #include "JSGlobalObject.h"
+#include "RegExpCache.h"
 #include "UString.h"
 #include <wtf/DateMath.h>
 #include <wtf/Threading.h>
@@ -59,6 +60,7 @@ static void initializeThreadingOnce()
     s_dtoaP5Mutex = new Mutex;
     initializeDates();
     RegisterFile::initializeThreading();
+    RegExpCache::initializeThreading();
 #endif
 }
 
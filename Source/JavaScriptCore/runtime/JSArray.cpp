@@ -28,9 +28,9 @@
 #include "Error.h"
 #include "Executable.h"
 #include "PropertyNameArray.h"
-#include <wtf/AVLTree.h>
 #include <wtf/Assertions.h>
 #include <wtf/OwnPtr.h>
+#include <wtf/TimSort.h>
 #include <Operations.h>
 
 using namespace std;
@@ -862,19 +862,94 @@ void JSArray::markChildren(MarkStack& markStack)
     markChildrenDirect(markStack);
 }
 
-static int compareNumbersForQSort(const void* a, const void* b)
-{
-    double da = static_cast<const JSValue*>(a)->uncheckedGetNumber();
-    double db = static_cast<const JSValue*>(b)->uncheckedGetNumber();
-    return (da > db) - (da < db);
-}
+struct Int32Less {
+    bool operator()(JSValue a, JSValue b) { return a.asInt32() < b.asInt32(); }
+};
 
-static int compareByStringPairForQSort(const void* a, const void* b)
-{
-    const ValueStringPair* va = static_cast<const ValueStringPair*>(a);
-    const ValueStringPair* vb = static_cast<const ValueStringPair*>(b);
-    return codePointCompare(va->second, vb->second);
-}
+struct NumberLess {
+    bool operator()(JSValue a, JSValue b) { return a.uncheckedGetNumber() < b.uncheckedGetNumber(); }
+};
+
+// Orders int32 values the way the default comparison orders their string
+// forms, without creating the strings.
+struct Int32AsStringLess {
+    static size_t toDigits(int32_t value, char* buffer)
+    {
+        char digits[10];
+        size_t count = 0;
+        uint32_t magnitude = value < 0 ? -static_cast<uint32_t>(value) : value;
+        do {
+            digits[count++] = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude);
+
+        size_t length = 0;
+        if (value < 0)
+            buffer[length++] = '-';
+        while (count)
+            buffer[length++] = digits[--count];
+        return length;
+    }
+
+    bool operator()(JSValue a, JSValue b)
+    {
+        char aDigits[11];
+        char bDigits[11];
+        size_t aLength = toDigits(a.asInt32(), aDigits);
+        size_t bLength = toDigits(b.asInt32(), bDigits);
+        int result = memcmp(aDigits, bDigits, min(aLength, bLength));
+        return result ? result < 0 : aLength < bLength;
+    }
+};
+
+struct StringPairLess {
+    bool operator()(const ValueStringPair* a, const ValueStringPair* b) { return codePointCompare(a->second, b->second) < 0; }
+};
+
+struct CompareFunctionLess {
+    CompareFunctionLess(ExecState* exec, JSValue compareFunction, CallType callType, const CallData& callData)
+        : m_exec(exec)
+        , m_compareFunction(compareFunction)
+        , m_compareCallType(callType)
+        , m_compareCallData(callData)
+        , m_globalThisValue(exec->globalThisValue())
+    {
+        if (callType == CallTypeJS)
+            m_cachedCall = adoptPtr(new CachedCall(exec, asFunction(compareFunction), 2));
+    }
+
+    bool operator()(const ValueStringPair* a, const ValueStringPair* b)
+    {
+        JSValue va = a->first;
+        JSValue vb = b->first;
+        ASSERT(!va.isUndefined());
+        ASSERT(!vb.isUndefined());
+
+        if (m_exec->hadException())
+            return false;
+
+        double compareResult;
+        if (m_cachedCall) {
+            m_cachedCall->setThis(m_globalThisValue);
+            m_cachedCall->setArgument(0, va);
+            m_cachedCall->setArgument(1, vb);
+            compareResult = m_cachedCall->call().toNumber(m_cachedCall->newCallFrame(m_exec));
+        } else {
+            MarkedArgumentBuffer arguments;
+            arguments.append(va);
+            arguments.append(vb);
+            compareResult = call(m_exec, m_compareFunction, m_compareCallType, m_compareCallData, m_globalThisValue, arguments).toNumber(m_exec);
+        }
+        return compareResult < 0;
+    }
+
+    ExecState* m_exec;
+    JSValue m_compareFunction;
+    CallType m_compareCallType;
+    const CallData& m_compareCallData;
+    JSValue m_globalThisValue;
+    OwnPtr<CachedCall> m_cachedCall;
+};
 
 void JSArray::sortNumeric(ExecState* exec, JSValue compareFunction, CallType callType, const CallData& callData)
 {
@@ -889,10 +964,15 @@ void JSArray::sortNumeric(ExecState* exec, JSValue compareFunction, CallType cal
     if (!lengthNotIncludingUndefined)
         return;
         
+    bool allValuesAreInt32 = true;
     bool allValuesAreNumbers = true;
     size_t size = storage->m_numValuesInVector;
     for (size_t i = 0; i < size; ++i) {
-        if (!storage->m_vector[i].isNumber()) {
+        JSValue value = storage->m_vector[i].get();
+        if (value.isInt32())
+            continue;
+        allValuesAreInt32 = false;
+        if (!value.isNumber()) {
             allValuesAreNumbers = false;
             break;
         }
@@ -901,10 +981,19 @@ void JSArray::sortNumeric(ExecState* exec, JSValue compareFunction, CallType cal
     if (!allValuesAreNumbers)
         return sort(exec, compareFunction, callType, callData);
 
-    // For numeric comparison, which is fast, qsort is faster than mergesort. We
-    // also don't require mergesort's stability, since there's no user visible
-    // side-effect from swapping the order of equal primitive values.
-    qsort(storage->m_vector, size, sizeof(JSValue), compareNumbersForQSort);
+    // Numbers are sorted in place, and no collection can happen while they are.
+    // Stability is not required, since there's no user visible side-effect from
+    // swapping the order of equal primitive values, but the merge sort is
+    // linear on input that is already sorted.
+    JSValue* values = storage->m_vector[0].slot();
+    Vector<JSValue> scratch;
+    if (allValuesAreInt32) {
+        Int32Less compareLess;
+        timSort(values, size, scratch, compareLess);
+    } else {
+        NumberLess compareLess;
+        timSort(values, size, scratch, compareLess);
+    }
 
     checkConsistency(SortConsistencyCheck);
 }
@@ -922,6 +1011,24 @@ void JSArray::sort(ExecState* exec)
     if (!lengthNotIncludingUndefined)
         return;
 
+    bool allValuesAreInt32 = true;
+    for (size_t i = 0; i < lengthNotIncludingUndefined; i++) {
+        if (!storage->m_vector[i].get().isInt32()) {
+            allValuesAreInt32 = false;
+            break;
+        }
+    }
+
+    if (allValuesAreInt32) {
+        // Converting int32 values to strings has no side effects, so they are
+        // compared by their digits directly and sorted in place.
+        Vector<JSValue> scratch;
+        Int32AsStringLess compareLess;
+        timSort(storage->m_vector[0].slot(), lengthNotIncludingUndefined, scratch, compareLess);
+        checkConsistency(SortConsistencyCheck);
+        return;
+    }
+
     // Converting JavaScript values to strings can be expensive, so we do it once up front and sort based on that.
     // This is a considerable improvement over doing it twice per comparison, though it requires a large temporary
     // buffer. Besides, this protects us from crashing if some objects have custom toString methods that return
@@ -955,108 +1062,32 @@ void JSArray::sort(ExecState* exec)
     // FIXME: Since we sort by string value, a fast algorithm might be to use a radix sort. That would be O(N) rather
     // than O(N log N).
 
-#if HAVE(MERGESORT)
-    mergesort(values.begin(), values.size(), sizeof(ValueStringPair), compareByStringPairForQSort);
-#else
-    // FIXME: The qsort library function is likely to not be a stable sort.
-    // ECMAScript-262 does not specify a stable sort, but in practice, browsers perform a stable sort.
-    qsort(values.begin(), values.size(), sizeof(ValueStringPair), compareByStringPairForQSort);
-#endif
+    // Sorting pointers to the pairs avoids churning the reference counts of the strings.
+    Vector<ValueStringPair*> order(lengthNotIncludingUndefined);
+    for (size_t i = 0; i < lengthNotIncludingUndefined; i++)
+        order[i] = &values[i];
+
+    Vector<ValueStringPair*> scratch;
+    StringPairLess compareLess;
+    timSort(order.data(), order.size(), scratch, compareLess);
 
     // If the toString function changed the length of the array or vector storage,
     // increase the length to handle the orignal number of actual values.
     if (m_vectorLength < lengthNotIncludingUndefined)
         increaseVectorLength(lengthNotIncludingUndefined);
+    storage = m_storage;
     if (storage->m_length < lengthNotIncludingUndefined)
         storage->m_length = lengthNotIncludingUndefined;
 
     JSGlobalData& globalData = exec->globalData();
     for (size_t i = 0; i < lengthNotIncludingUndefined; i++)
-        storage->m_vector[i].set(globalData, this, values[i].first);
+        storage->m_vector[i].set(globalData, this, order[i]->first);
 
     Heap::heap(this)->popTempSortVector(&values);
     
     checkConsistency(SortConsistencyCheck);
 }
 
-struct AVLTreeNodeForArrayCompare {
-    JSValue value;
-
-    // Child pointers.  The high bit of gt is robbed and used as the
-    // balance factor sign.  The high bit of lt is robbed and used as
-    // the magnitude of the balance factor.
-    int32_t gt;
-    int32_t lt;
-};
-
-struct AVLTreeAbstractorForArrayCompare {
-    typedef int32_t handle; // Handle is an index into m_nodes vector.
-    typedef JSValue key;
-    typedef int32_t size;
-
-    Vector<AVLTreeNodeForArrayCompare> m_nodes;
-    ExecState* m_exec;
-    JSValue m_compareFunction;
-    CallType m_compareCallType;
-    const CallData* m_compareCallData;
-    JSValue m_globalThisValue;
-    OwnPtr<CachedCall> m_cachedCall;
-
-    handle get_less(handle h) { return m_nodes[h].lt & 0x7FFFFFFF; }
-    void set_less(handle h, handle lh) { m_nodes[h].lt &= 0x80000000; m_nodes[h].lt |= lh; }
-    handle get_greater(handle h) { return m_nodes[h].gt & 0x7FFFFFFF; }
-    void set_greater(handle h, handle gh) { m_nodes[h].gt &= 0x80000000; m_nodes[h].gt |= gh; }
-
-    int get_balance_factor(handle h)
-    {
-        if (m_nodes[h].gt & 0x80000000)
-            return -1;
-        return static_cast<unsigned>(m_nodes[h].lt) >> 31;
-    }
-
-    void set_balance_factor(handle h, int bf)
-    {
-        if (bf == 0) {
-            m_nodes[h].lt &= 0x7FFFFFFF;
-            m_nodes[h].gt &= 0x7FFFFFFF;
-        } else {
-            m_nodes[h].lt |= 0x80000000;
-            if (bf < 0)
-                m_nodes[h].gt |= 0x80000000;
-            else
-                m_nodes[h].gt &= 0x7FFFFFFF;
-        }
-    }
-
-    int compare_key_key(key va, key vb)
-    {
-        ASSERT(!va.isUndefined());
-        ASSERT(!vb.isUndefined());
-
-        if (m_exec->hadException())
-            return 1;
-
-        double compareResult;
-        if (m_cachedCall) {
-            m_cachedCall->setThis(m_globalThisValue);
-            m_cachedCall->setArgument(0, va);
-            m_cachedCall->setArgument(1, vb);
-            compareResult = m_cachedCall->call().toNumber(m_cachedCall->newCallFrame(m_exec));
-        } else {
-            MarkedArgumentBuffer arguments;
-            arguments.append(va);
-            arguments.append(vb);
-            compareResult = call(m_exec, m_compareFunction, m_compareCallType, *m_compareCallData, m_globalThisValue, arguments).toNumber(m_exec);
-        }
-        return (compareResult < 0) ? -1 : 1; // Not passing equality through, because we need to store all values, even if equivalent.
-    }
-
-    int compare_key_node(key k, handle h) { return compare_key_key(k, m_nodes[h].value); }
-    int compare_node_node(handle h1, handle h2) { return compare_key_key(m_nodes[h1].value, m_nodes[h2].value); }
-
-    static handle null() { return 0x7FFFFFFF; }
-};
-
 void JSArray::sort(ExecState* exec, JSValue compareFunction, CallType callType, const CallData& callData)
 {
     checkConsistency();
@@ -1065,58 +1096,39 @@ void JSArray::sort(ExecState* exec, JSValue compareFunction, CallType callType,
 
     // FIXME: This ignores exceptions raised in the compare function or in toNumber.
 
-    // The maximum tree depth is compiled in - but the caller is clearly up to no good
-    // if a larger array is passed.
-    ASSERT(storage->m_length <= static_cast<unsigned>(std::numeric_limits<int>::max()));
-    if (storage->m_length > static_cast<unsigned>(std::numeric_limits<int>::max()))
-        return;
-
     unsigned usedVectorLength = min(storage->m_length, m_vectorLength);
     unsigned nodeCount = usedVectorLength + (storage->m_sparseValueMap ? storage->m_sparseValueMap->size() : 0);
 
     if (!nodeCount)
         return;
 
-    AVLTree<AVLTreeAbstractorForArrayCompare, 44> tree; // Depth 44 is enough for 2^31 items
-    tree.abstractor().m_exec = exec;
-    tree.abstractor().m_compareFunction = compareFunction;
-    tree.abstractor().m_compareCallType = callType;
-    tree.abstractor().m_compareCallData = &callData;
-    tree.abstractor().m_globalThisValue = exec->globalThisValue();
-    tree.abstractor().m_nodes.grow(nodeCount);
-
-    if (callType == CallTypeJS)
-        tree.abstractor().m_cachedCall = adoptPtr(new CachedCall(exec, asFunction(compareFunction), 2));
-
-    if (!tree.abstractor().m_nodes.begin()) {
+    // The values are kept in a vector the collector marks, and only pointers to
+    // its entries are sorted, so the compare function is free to allocate.
+    Vector<ValueStringPair> values(nodeCount);
+    if (!values.begin()) {
         throwOutOfMemoryError(exec);
         return;
     }
 
-    // FIXME: If the compare function modifies the array, the vector, map, etc. could be modified
-    // right out from under us while we're building the tree here.
+    Heap::heap(this)->pushTempSortVector(&values);
 
     unsigned numDefined = 0;
     unsigned numUndefined = 0;
 
-    // Iterate over the array, ignoring missing values, counting undefined ones, and inserting all other ones into the tree.
+    // Iterate over the array, ignoring missing values and counting undefined ones.
     for (; numDefined < usedVectorLength; ++numDefined) {
         JSValue v = storage->m_vector[numDefined].get();
         if (!v || v.isUndefined())
             break;
-        tree.abstractor().m_nodes[numDefined].value = v;
-        tree.insert(numDefined);
+        values[numDefined].first = v;
     }
     for (unsigned i = numDefined; i < usedVectorLength; ++i) {
         JSValue v = storage->m_vector[i].get();
         if (v) {
             if (v.isUndefined())
                 ++numUndefined;
-            else {
-                tree.abstractor().m_nodes[numDefined].value = v;
-                tree.insert(numDefined);
-                ++numDefined;
-            }
+            else
+                values[numDefined++].first = v;
         }
     }
 
@@ -1124,51 +1136,57 @@ void JSArray::sort(ExecState* exec, JSValue compareFunction, CallType callType,
 
     if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
         newUsedVectorLength += map->size();
-        if (newUsedVectorLength > m_vectorLength) {
-            // Check that it is possible to allocate an array large enough to hold all the entries.
-            if ((newUsedVectorLength > MAX_STORAGE_VECTOR_LENGTH) || !increaseVectorLength(newUsedVectorLength)) {
-                throwOutOfMemoryError(exec);
-                return;
-            }
-        }
-        
-        storage = m_storage;
 
         SparseArrayValueMap::iterator end = map->end();
-        for (SparseArrayValueMap::iterator it = map->begin(); it != end; ++it) {
-            tree.abstractor().m_nodes[numDefined].value = it->second.get();
-            tree.insert(numDefined);
-            ++numDefined;
-        }
+        for (SparseArrayValueMap::iterator it = map->begin(); it != end; ++it)
+            values[numDefined++].first = it->second.get();
 
         delete map;
         storage->m_sparseValueMap = 0;
     }
 
-    ASSERT(tree.abstractor().m_nodes.size() >= numDefined);
+    ASSERT(values.size() >= numDefined);
+
+    Vector<ValueStringPair*> order(numDefined);
+    for (unsigned i = 0; i < numDefined; ++i)
+        order[i] = &values[i];
 
-    // FIXME: If the compare function changed the length of the array, the following might be
-    // modifying the vector incorrectly.
+    Vector<ValueStringPair*> scratch;
+    CompareFunctionLess compareLess(exec, compareFunction, callType, callData);
+    timSort(order.data(), order.size(), scratch, compareLess);
+
+    // The compare function may have changed the array, so make sure that the
+    // storage can still hold every value before copying them back.
+    if (newUsedVectorLength > m_vectorLength) {
+        // Check that it is possible to allocate an array large enough to hold all the entries.
+        if ((newUsedVectorLength > MAX_STORAGE_VECTOR_LENGTH) || !increaseVectorLength(newUsedVectorLength)) {
+            Heap::heap(this)->popTempSortVector(&values);
+            throwOutOfMemoryError(exec);
+            return;
+        }
+    }
+    storage = m_storage;
+    if (storage->m_length < newUsedVectorLength)
+        storage->m_length = newUsedVectorLength;
 
     // Copy the values back into m_storage.
-    AVLTree<AVLTreeAbstractorForArrayCompare, 44>::Iterator iter;
-    iter.start_iter_least(tree);
     JSGlobalData& globalData = exec->globalData();
-    for (unsigned i = 0; i < numDefined; ++i) {
-        storage->m_vector[i].set(globalData, this, tree.abstractor().m_nodes[*iter].value);
-        ++iter;
-    }
+    for (unsigned i = 0; i < numDefined; ++i)
+        storage->m_vector[i].set(globalData, this, order[i]->first);
 
     // Put undefined values back in.
     for (unsigned i = numDefined; i < newUsedVectorLength; ++i)
         storage->m_vector[i].setUndefined();
 
     // Ensure that unused values in the vector are zeroed out.
-    for (unsigned i = newUsedVectorLength; i < usedVectorLength; ++i)
+    unsigned clearEnd = min(usedVectorLength, m_vectorLength);
+    for (unsigned i = newUsedVectorLength; i < clearEnd; ++i)
         storage->m_vector[i].clear();
 
     storage->m_numValuesInVector = newUsedVectorLength;
 
+    Heap::heap(this)->popTempSortVector(&values);
+
     checkConsistency(SortConsistencyCheck);
 }
 
@@ -355,6 +355,9 @@ namespace JSC {
     {
         while (m_nextAtom < m_endAtom) {
             if (!m_marks.testAndSet(m_nextAtom)) {
+#if ENABLE(GGC)
+                m_newlyAllocated.set(m_nextAtom);
+#endif
                 JSCell* cell = reinterpret_cast<JSCell*>(&atoms()[m_nextAtom]);
                 m_nextAtom += m_atomsPerCell;
                 cell->~JSCell();
@@ -363,6 +366,9 @@ namespace JSC {
             m_nextAtom += m_atomsPerCell;
         }
 
+        // Every dead cell in the block has been destroyed and handed out, so
+        // there is nothing left for a deferred sweep to do.
+        m_needsSweep = false;
         return 0;
     }
     
@@ -28,6 +28,7 @@
 
 #include "ExecutableAllocator.h"
 #include "JSGlobalData.h"
+#include "RegExpCache.h"
 #include "RegisterFile.h"
 
 namespace JSC {
@@ -42,6 +43,12 @@ GlobalMemoryStatistics globalMemoryStatistics()
 #else
     stats.JITBytes = 0;
 #endif
+
+    RegExpCacheStatistics regExpCacheStatistics = RegExpCache::statistics();
+    stats.regExpCacheBytes = regExpCacheStatistics.cachedBytes;
+    stats.regExpCacheHits = regExpCacheStatistics.hits;
+    stats.regExpCacheMisses = regExpCacheStatistics.misses;
+    stats.regExpCacheEvictions = regExpCacheStatistics.evictions;
     return stats;
 }
 
@@ -35,6 +35,10 @@ namespace JSC {
 struct GlobalMemoryStatistics {
     size_t stackBytes;
     size_t JITBytes;
+    size_t regExpCacheBytes;
+    size_t regExpCacheHits;
+    size_t regExpCacheMisses;
+    size_t regExpCacheEvictions;
 };
 
 GlobalMemoryStatistics globalMemoryStatistics();
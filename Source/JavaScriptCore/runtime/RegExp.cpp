@@ -130,6 +130,17 @@ RegExp::RegExpState RegExp::compile(JSGlobalData* globalData)
     return res;
 }
 
+size_t RegExp::estimatedSize() const
+{
+    size_t size = sizeof(RegExp) + sizeof(RegExpRepresentation) + m_patternString.length() * sizeof(UChar);
+#if ENABLE(YARR_JIT)
+    size += m_representation->m_regExpJITCode.size();
+#endif
+    if (m_representation->m_regExpBytecode)
+        size += m_representation->m_regExpBytecode->estimatedSize();
+    return size;
+}
+
 int RegExp::match(const UString& s, int startOffset, Vector<int, 32>* ovector)
 {
     if (startOffset < 0)
@@ -51,6 +51,10 @@ namespace JSC {
 
         int match(const UString&, int startOffset, Vector<int, 32>* ovector = 0);
         unsigned numSubpatterns() const { return m_numSubpatterns; }
+
+        // Approximate number of bytes held by this RegExp and its compiled
+        // JIT code or bytecode.
+        size_t estimatedSize() const;
         
 #if ENABLE(REGEXP_TRACING)
         void printTraceData();
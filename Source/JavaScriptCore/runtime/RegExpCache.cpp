@@ -29,49 +29,149 @@
 
 #include "RegExpCache.h"
 
+#include <wtf/HashSet.h>
+#include <wtf/Threading.h>
+
 namespace JSC {
 
+// Each cache counts for itself; the lock only guards the set of live caches
+// and the totals of the ones that have been destroyed.
+static RegExpCacheStatistics destroyedCacheStatistics;
+
+static Mutex& regExpCacheStatisticsMutex()
+{
+    DEFINE_STATIC_LOCAL(Mutex, staticMutex, ());
+    return staticMutex;
+}
+
+static HashSet<RegExpCache*>& liveCaches()
+{
+    DEFINE_STATIC_LOCAL(HashSet<RegExpCache*>, caches, ());
+    return caches;
+}
+
 PassRefPtr<RegExp> RegExpCache::lookupOrCreate(const UString& patternString, RegExpFlags flags)
 {
-    if (patternString.length() < maxCacheablePatternLength) {
-        pair<RegExpCacheMap::iterator, bool> result = m_cacheMap.add(RegExpKey(flags, patternString), 0);
-        if (!result.second)
-            return result.first->second;
-        else
-            return create(patternString, flags, result.first);
+    RegExpKey key(flags, patternString);
+
+    RegExpCacheMap::iterator iterator = m_cacheMap.find(key);
+    if (iterator != m_cacheMap.end()) {
+        Entry* entry = iterator->second;
+        didUse(entry);
+        ++m_hits;
+        return entry->regExp;
     }
-    return create(patternString, flags, m_cacheMap.end());
+
+    ++m_misses;
+
+    RefPtr<RegExp> regExp = RegExp::create(m_globalData, patternString, flags);
+    size_t size = regExp->estimatedSize();
+    if (size <= maxEntrySize)
+        add(key, regExp, size);
+    return regExp.release();
 }
 
-PassRefPtr<RegExp> RegExpCache::create(const UString& patternString, RegExpFlags flags, RegExpCacheMap::iterator iterator) 
+void RegExpCache::add(const RegExpKey& key, PassRefPtr<RegExp> regExp, size_t size)
 {
-    RefPtr<RegExp> regExp = RegExp::create(m_globalData, patternString, flags);
+    Entry* entry = new Entry(key, regExp, size);
+    m_cacheMap.set(key, entry);
+    m_probationList.append(entry);
+    m_probationSize += size;
+
+    // The protected list never holds more than maxProtectedSize, and no entry
+    // is larger than maxEntrySize, so the probation list is never empty here.
+    while (m_probationSize + m_protectedSize > maxCacheSize) {
+        ASSERT(!m_probationList.isEmpty());
+        evict(m_probationList.head());
+    }
+}
+
+void RegExpCache::didUse(Entry* entry)
+{
+    if (entry->isProtected) {
+        m_protectedList.remove(entry);
+        m_protectedList.append(entry);
+        return;
+    }
 
-    if (patternString.length() >= maxCacheablePatternLength)
-        return regExp;
+    m_probationList.remove(entry);
+    m_probationSize -= entry->size;
+    entry->isProtected = true;
+    m_protectedList.append(entry);
+    m_protectedSize += entry->size;
 
-    RegExpKey key = RegExpKey(flags, patternString);
-    iterator->first = key;
-    iterator->second = regExp;
+    // Give the least recently used protected entries another chance on probation.
+    while (m_protectedSize > maxProtectedSize) {
+        Entry* demoted = m_protectedList.head();
+        m_protectedList.remove(demoted);
+        m_protectedSize -= demoted->size;
+        demoted->isProtected = false;
+        m_probationList.append(demoted);
+        m_probationSize += demoted->size;
+    }
+}
 
-    ++m_nextKeyToEvict;
-    if (m_nextKeyToEvict == maxCacheableEntries) {
-        m_nextKeyToEvict = 0;
-        m_isFull = true;
+void RegExpCache::evict(Entry* entry)
+{
+    if (entry->isProtected) {
+        m_protectedList.remove(entry);
+        m_protectedSize -= entry->size;
+    } else {
+        m_probationList.remove(entry);
+        m_probationSize -= entry->size;
     }
-    if (m_isFull)
-        m_cacheMap.remove(RegExpKey(patternKeyArray[m_nextKeyToEvict].flagsValue, patternKeyArray[m_nextKeyToEvict].pattern));
 
-    patternKeyArray[m_nextKeyToEvict].flagsValue = key.flagsValue;
-    patternKeyArray[m_nextKeyToEvict].pattern = patternString.impl();
-    return regExp;
+    m_cacheMap.remove(entry->key);
+    ++m_evictions;
+    delete entry;
 }
 
 RegExpCache::RegExpCache(JSGlobalData* globalData)
-    : m_globalData(globalData)
-    , m_nextKeyToEvict(-1)
-    , m_isFull(false)
+    : m_probationSize(0)
+    , m_protectedSize(0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_evictions(0)
+    , m_globalData(globalData)
+{
+    MutexLocker locker(regExpCacheStatisticsMutex());
+    liveCaches().add(this);
+}
+
+RegExpCache::~RegExpCache()
+{
+    {
+        MutexLocker locker(regExpCacheStatisticsMutex());
+        liveCaches().remove(this);
+        destroyedCacheStatistics.hits += m_hits;
+        destroyedCacheStatistics.misses += m_misses;
+        destroyedCacheStatistics.evictions += m_evictions;
+    }
+    deleteAllValues(m_cacheMap);
+}
+
+RegExpCacheStatistics RegExpCache::statistics()
+{
+    MutexLocker locker(regExpCacheStatisticsMutex());
+
+    // The counters of live caches are read without their owners' locks, so
+    // the totals may be slightly stale.
+    RegExpCacheStatistics statistics = destroyedCacheStatistics;
+    HashSet<RegExpCache*>::iterator end = liveCaches().end();
+    for (HashSet<RegExpCache*>::iterator it = liveCaches().begin(); it != end; ++it) {
+        RegExpCache* cache = *it;
+        statistics.cachedBytes += cache->m_probationSize + cache->m_protectedSize;
+        statistics.hits += cache->m_hits;
+        statistics.misses += cache->m_misses;
+        statistics.evictions += cache->m_evictions;
+    }
+    return statistics;
+}
+
+void RegExpCache::initializeThreading()
 {
+    regExpCacheStatisticsMutex();
+    liveCaches();
 }
 
 }
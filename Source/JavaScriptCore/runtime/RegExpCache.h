@@ -28,7 +28,7 @@
 #include "RegExp.h"
 #include "RegExpKey.h"
 #include "UString.h"
-#include <wtf/FixedArray.h>
+#include <wtf/DoublyLinkedList.h>
 #include <wtf/HashMap.h>
 
 #ifndef RegExpCache_h
@@ -36,31 +36,83 @@
 
 namespace JSC {
 
-class RegExpCache {
+struct RegExpCacheStatistics {
+    size_t cachedBytes;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+};
 
-typedef HashMap<RegExpKey, RefPtr<RegExp> > RegExpCacheMap;
+// Keeps recently used RegExps alive within a budget of compiled bytes. New
+// entries start out on probation, and move to the protected list when they
+// are used again; eviction takes the least recently used entry on probation
+// first, so patterns that are used once do not push out hot ones.
+class RegExpCache {
+    WTF_MAKE_NONCOPYABLE(RegExpCache);
 
 public:
     PassRefPtr<RegExp> lookupOrCreate(const UString& patternString, RegExpFlags);
-    PassRefPtr<RegExp> create(const UString& patternString, RegExpFlags, RegExpCacheMap::iterator);
     RegExpCache(JSGlobalData* globalData);
+    ~RegExpCache();
 
-private:
-    static const unsigned maxCacheablePatternLength = 256;
+    // Totals over every RegExpCache in the process.
+    static RegExpCacheStatistics statistics();
+    static void initializeThreading();
 
+private:
 #if PLATFORM(IOS)
     // The RegExpCache can currently hold onto multiple Mb of memory;
     // as a short-term fix some embedded platforms may wish to reduce the cache size.
-    static const int maxCacheableEntries = 32;
+    static const size_t maxCacheSize = 128 * 1024;
 #else
-    static const int maxCacheableEntries = 256;
+    static const size_t maxCacheSize = 1024 * 1024;
 #endif
+    static const size_t maxProtectedSize = maxCacheSize / 5 * 4;
+    static const size_t maxEntrySize = maxCacheSize / 8;
+
+    class Entry {
+        WTF_MAKE_FAST_ALLOCATED;
+    public:
+        Entry(const RegExpKey& key, PassRefPtr<RegExp> regExp, size_t size)
+            : key(key)
+            , regExp(regExp)
+            , size(size)
+            , isProtected(false)
+            , m_prev(0)
+            , m_next(0)
+        {
+        }
+
+        Entry* prev() const { return m_prev; }
+        Entry* next() const { return m_next; }
+        void setPrev(Entry* prev) { m_prev = prev; }
+        void setNext(Entry* next) { m_next = next; }
+
+        RegExpKey key;
+        RefPtr<RegExp> regExp;
+        size_t size;
+        bool isProtected;
+
+    private:
+        Entry* m_prev;
+        Entry* m_next;
+    };
+
+    typedef HashMap<RegExpKey, Entry*> RegExpCacheMap;
+
+    void add(const RegExpKey&, PassRefPtr<RegExp>, size_t);
+    void didUse(Entry*);
+    void evict(Entry*);
 
-    FixedArray<RegExpKey, maxCacheableEntries> patternKeyArray;
     RegExpCacheMap m_cacheMap;
+    DoublyLinkedList<Entry> m_probationList; // Least recently used first.
+    DoublyLinkedList<Entry> m_protectedList; // Least recently used first.
+    size_t m_probationSize;
+    size_t m_protectedSize;
+    size_t m_hits;
+    size_t m_misses;
+    size_t m_evictions;
     JSGlobalData* m_globalData;
-    int m_nextKeyToEvict;
-    bool m_isFull;
 };
 
 } // namespace JSC
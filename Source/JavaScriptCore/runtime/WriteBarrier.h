@@ -32,6 +32,11 @@ namespace JSC {
 class JSCell;
 class JSGlobalData;
 
+#if ENABLE(GGC)
+// Defined in Heap.cpp, records old owners of new cells in the remembered set.
+void writeBarrier(JSGlobalData&, const JSCell*, JSValue);
+void writeBarrier(JSGlobalData&, const JSCell*, JSCell*);
+#else
 inline void writeBarrier(JSGlobalData&, const JSCell*, JSValue)
 {
 }
@@ -39,6 +44,7 @@ inline void writeBarrier(JSGlobalData&, const JSCell*, JSValue)
 inline void writeBarrier(JSGlobalData&, const JSCell*, JSCell*)
 {
 }
+#endif
 
 typedef enum { } Unknown;
 typedef JSValue* HandleSlot;
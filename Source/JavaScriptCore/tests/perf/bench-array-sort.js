@@ -0,0 +1,19 @@
+(function () {
+    var objects = new Array(100000);
+    for (var i = 0; i < 100000; ++i)
+        objects[i] = { key: (i * 7919) % 100003 };
+
+    for (var i = 0; i < 10; ++i) {
+        objects.sort(function (a, b) { return a.key - b.key; });
+        objects.reverse();
+    }
+
+    var numbers = new Array(100000);
+    for (var i = 0; i < 100000; ++i)
+        numbers[i] = (i * 7919) % 100003;
+
+    for (var i = 0; i < 10; ++i) {
+        numbers.slice().sort();
+        numbers.slice().sort(function (a, b) { return a - b; });
+    }
+})();
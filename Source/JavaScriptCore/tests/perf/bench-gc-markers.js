@@ -0,0 +1,29 @@
+// Full collection pause times of a large heap, marking with 1 to 4 threads.
+// setGCMarkerCount() returns the number of markers actually used, which
+// stays 1 without ENABLE(PARALLEL_GC).
+(function () {
+    var heap = [];
+    for (var i = 0; i < 2000; ++i) {
+        var list = null;
+        for (var j = 0; j < 200; ++j)
+            list = { next: list, value: [i, j], name: "n" + j };
+        heap.push(list);
+    }
+
+    for (var markers = 1; markers <= 4; ++markers) {
+        var used = setGCMarkerCount(markers);
+        if (used != markers)
+            break;
+        gc();
+        var total = 0;
+        var worst = 0;
+        for (var i = 0; i < 10; ++i) {
+            var start = new Date;
+            gc();
+            var pause = new Date - start;
+            total += pause;
+            worst = Math.max(worst, pause);
+        }
+        print(markers + " markers: " + (total / 10) + "ms average, " + worst + "ms worst");
+    }
+})();
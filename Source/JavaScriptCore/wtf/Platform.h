@@ -1276,6 +1276,24 @@
 
 #define ENABLE_JSC_ZOMBIES 0
 
+/* Mark the heap from several threads during a collection. Off by default,
+   the markChildren() implementations have not all been audited for
+   concurrent marking. */
+#if !defined(ENABLE_PARALLEL_GC)
+#define ENABLE_PARALLEL_GC 0
+#endif
+
+/* Generational collection: mark bits stay set across collections, and minor
+   collections only trace the objects allocated since the previous one. JIT
+   code does not emit write barriers, so this needs the interpreter. */
+#if !defined(ENABLE_GGC)
+#define ENABLE_GGC 0
+#endif
+
+#if ENABLE(GGC) && (ENABLE(JIT) || ENABLE(JSC_ZOMBIES))
+#error "ENABLE(GGC) is not supported with ENABLE(JIT) or ENABLE(JSC_ZOMBIES)"
+#endif
+
 /* FIXME: Eventually we should enable this for all platforms and get rid of the define. */
 #if PLATFORM(MAC) || PLATFORM(WIN) || PLATFORM(QT)
 #define WTF_USE_PLATFORM_STRATEGIES 1
@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WTF_TimSort_h
+#define WTF_TimSort_h
+
+#include <algorithm>
+#include <wtf/Vector.h>
+
+namespace WTF {
+
+// A stable, adaptive merge sort after Tim Peters' listsort. Runs that are
+// already ascending, or strictly descending (those are reversed in place),
+// are found and merged, so sorted and nearly sorted input costs close to
+// linear time. Short runs are extended to a minimum length with a binary
+// insertion sort.
+//
+// The scratch vector is grown as needed and may be reused across sorts; it
+// never needs more than half the elements. The predicate may be
+// inconsistent (a compare function written in JavaScript, say), in which
+// case the result is some permutation of the input.
+template<typename T, typename Predicate>
+class TimSorter {
+public:
+    TimSorter(T* array, size_t count, Vector<T>& scratch, Predicate& compareLess)
+        : m_array(array)
+        , m_count(count)
+        , m_scratch(scratch)
+        , m_compareLess(compareLess)
+        , m_runCount(0)
+    {
+    }
+
+    void sort()
+    {
+        if (m_count < 2)
+            return;
+
+        size_t minRun = minRunLength(m_count);
+        for (size_t start = 0; start < m_count; ) {
+            size_t length = countRunAndMakeAscending(start);
+            if (length < minRun) {
+                size_t forcedLength = std::min(minRun, m_count - start);
+                binaryInsertionSort(start, start + length, start + forcedLength);
+                length = forcedLength;
+            }
+
+            pushRun(start, length);
+            mergeCollapse();
+            start += length;
+        }
+
+        mergeForceCollapse();
+        ASSERT(m_runCount == 1);
+    }
+
+private:
+    static const size_t minMerge = 32;
+
+    // Enough for 2^64 elements given the invariants kept by mergeCollapse().
+    static const size_t maxRuns = 85;
+
+    struct Run {
+        size_t start;
+        size_t length;
+    };
+
+    static size_t minRunLength(size_t count)
+    {
+        // Pick a run length in [minMerge / 2, minMerge] such that count / length
+        // is a power of two, or a little less, so the final merges are balanced.
+        size_t remainder = 0;
+        while (count >= minMerge) {
+            remainder |= count & 1;
+            count >>= 1;
+        }
+        return count + remainder;
+    }
+
+    size_t countRunAndMakeAscending(size_t start)
+    {
+        size_t end = start + 1;
+        if (end == m_count)
+            return 1;
+
+        // Only strictly descending runs can be reversed without breaking stability.
+        if (m_compareLess(m_array[end], m_array[start])) {
+            for (++end; end < m_count && m_compareLess(m_array[end], m_array[end - 1]); ++end) { }
+            std::reverse(m_array + start, m_array + end);
+        } else {
+            for (++end; end < m_count && !m_compareLess(m_array[end], m_array[end - 1]); ++end) { }
+        }
+        return end - start;
+    }
+
+    // Sorts [start, end) given that [start, sortedEnd) is already sorted.
+    void binaryInsertionSort(size_t start, size_t sortedEnd, size_t end)
+    {
+        for (size_t i = sortedEnd; i < end; ++i) {
+            T pivot = m_array[i];
+            size_t position = upperBound(start, i, pivot);
+            for (size_t j = i; j > position; --j)
+                m_array[j] = m_array[j - 1];
+            m_array[position] = pivot;
+        }
+    }
+
+    // First index in [start, end) whose element is greater than value.
+    size_t upperBound(size_t start, size_t end, const T& value)
+    {
+        while (start < end) {
+            size_t middle = start + (end - start) / 2;
+            if (m_compareLess(value, m_array[middle]))
+                end = middle;
+            else
+                start = middle + 1;
+        }
+        return start;
+    }
+
+    // First index in [start, end) whose element is not less than value.
+    size_t lowerBound(size_t start, size_t end, const T& value)
+    {
+        while (start < end) {
+            size_t middle = start + (end - start) / 2;
+            if (m_compareLess(m_array[middle], value))
+                start = middle + 1;
+            else
+                end = middle;
+        }
+        return start;
+    }
+
+    void pushRun(size_t start, size_t length)
+    {
+        ASSERT(m_runCount < maxRuns);
+        m_runs[m_runCount].start = start;
+        m_runs[m_runCount].length = length;
+        ++m_runCount;
+    }
+
+    // Keeps the run lengths on the stack decreasing faster than the
+    // Fibonacci numbers, which bounds the stack depth and keeps merges
+    // balanced. This checks the top four runs, not three, see
+    // "OpenJDK's java.utils.Collection.sort() is broken" (de Gouw et al).
+    void mergeCollapse()
+    {
+        while (m_runCount > 1) {
+            size_t n = m_runCount - 2;
+            if ((n > 0 && m_runs[n - 1].length <= m_runs[n].length + m_runs[n + 1].length)
+                || (n > 1 && m_runs[n - 2].length <= m_runs[n - 1].length + m_runs[n].length)) {
+                if (m_runs[n - 1].length < m_runs[n + 1].length)
+                    --n;
+            } else if (m_runs[n].length > m_runs[n + 1].length)
+                return;
+            mergeAt(n);
+        }
+    }
+
+    void mergeForceCollapse()
+    {
+        while (m_runCount > 1) {
+            size_t n = m_runCount - 2;
+            if (n > 0 && m_runs[n - 1].length < m_runs[n + 1].length)
+                --n;
+            mergeAt(n);
+        }
+    }
+
+    // Merges runs n and n + 1, which are adjacent in the array.
+    void mergeAt(size_t n)
+    {
+        size_t start = m_runs[n].start;
+        size_t middle = start + m_runs[n].length;
+        size_t end = middle + m_runs[n + 1].length;
+
+        m_runs[n].length += m_runs[n + 1].length;
+        if (n + 2 < m_runCount)
+            m_runs[n + 1] = m_runs[n + 2];
+        --m_runCount;
+
+        // Elements of the left run not greater than the first of the right run
+        // are in place already, as are elements of the right run not less than
+        // the last of the left run.
+        start = upperBound(start, middle, m_array[middle]);
+        if (start == middle)
+            return;
+        end = lowerBound(middle, end, m_array[middle - 1]);
+        if (end == middle)
+            return;
+
+        if (middle - start <= end - middle)
+            mergeLow(start, middle, end);
+        else
+            mergeHigh(start, middle, end);
+    }
+
+    T* scratch(size_t length)
+    {
+        if (m_scratch.size() < length)
+            m_scratch.grow(length);
+        return m_scratch.data();
+    }
+
+    // Merges front to back, holding the (shorter) left run in scratch.
+    void mergeLow(size_t start, size_t middle, size_t end)
+    {
+        size_t leftLength = middle - start;
+        T* left = scratch(leftLength);
+        std::copy(m_array + start, m_array + middle, left);
+
+        size_t i = 0;
+        size_t j = middle;
+        size_t k = start;
+        while (i < leftLength && j < end) {
+            if (m_compareLess(m_array[j], left[i]))
+                m_array[k++] = m_array[j++];
+            else
+                m_array[k++] = left[i++];
+        }
+        // Whatever is left of the right run is in place already.
+        std::copy(left + i, left + leftLength, m_array + k);
+    }
+
+    // Merges back to front, holding the (shorter) right run in scratch.
+    void mergeHigh(size_t start, size_t middle, size_t end)
+    {
+        size_t rightLength = end - middle;
+        T* right = scratch(rightLength);
+        std::copy(m_array + middle, m_array + end, right);
+
+        size_t i = middle;
+        size_t j = rightLength;
+        size_t k = end;
+        while (i > start && j) {
+            if (m_compareLess(right[j - 1], m_array[i - 1]))
+                m_array[--k] = m_array[--i];
+            else
+                m_array[--k] = right[--j];
+        }
+        // Whatever is left of the left run is in place already.
+        std::copy(right, right + j, m_array + k - j);
+    }
+
+    T* m_array;
+    size_t m_count;
+    Vector<T>& m_scratch;
+    Predicate& m_compareLess;
+    Run m_runs[maxRuns];
+    size_t m_runCount;
+};
+
+template<typename T, typename Predicate>
+inline void timSort(T* array, size_t count, Vector<T>& scratch, Predicate& compareLess)
+{
+    TimSorter<T, Predicate>(array, count, scratch, compareLess).sort();
+}
+
+} // namespace WTF
+
+using WTF::timSort;
+
+#endif // WTF_TimSort_h
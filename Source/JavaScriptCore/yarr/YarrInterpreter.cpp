@@ -1892,6 +1892,23 @@ private:
     Vector<ByteDisjunction*> m_allParenthesesInfo;
 };
 
+size_t BytecodePattern::estimatedSize() const
+{
+    size_t size = sizeof(BytecodePattern) + sizeof(ByteDisjunction) + m_body->terms.capacity() * sizeof(ByteTerm);
+
+    for (size_t i = 0; i < m_allParenthesesInfo.size(); ++i)
+        size += sizeof(ByteDisjunction) + m_allParenthesesInfo[i]->terms.capacity() * sizeof(ByteTerm);
+
+    for (size_t i = 0; i < m_userCharacterClasses.size(); ++i) {
+        const CharacterClass* characterClass = m_userCharacterClasses[i];
+        size += sizeof(CharacterClass);
+        size += (characterClass->m_matches.capacity() + characterClass->m_matchesUnicode.capacity()) * sizeof(UChar);
+        size += (characterClass->m_ranges.capacity() + characterClass->m_rangesUnicode.capacity()) * sizeof(CharacterRange);
+    }
+
+    return size + m_beginChars.capacity() * sizeof(BeginChar);
+}
+
 PassOwnPtr<BytecodePattern> byteCompile(YarrPattern& pattern, BumpPointerAllocator* allocator)
 {
     return ByteCompiler(pattern).compile(allocator);
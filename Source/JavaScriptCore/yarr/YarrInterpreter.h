@@ -350,6 +350,9 @@ public:
         deleteAllValues(m_userCharacterClasses);
     }
 
+    // Approximate number of bytes allocated for the compiled pattern.
+    size_t estimatedSize() const;
+
     OwnPtr<ByteDisjunction> m_body;
     bool m_ignoreCase;
     bool m_multiline;
@@ -688,6 +688,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	platform/graphics/android/PaintedSurface.cpp \
 	platform/graphics/android/PathAndroid.cpp \
 	platform/graphics/android/PatternAndroid.cpp \
+	platform/graphics/android/PixelBufferPool.cpp \
 	platform/graphics/android/PlatformGraphicsContext.cpp \
 	platform/graphics/android/PerformanceMonitor.cpp \
 	platform/graphics/android/RasterRenderer.cpp \
@@ -696,7 +697,9 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	platform/graphics/android/ShaderProgram.cpp \
 	platform/graphics/android/SharedTexture.cpp \
 	platform/graphics/android/TextureInfo.cpp \
+	platform/graphics/android/TexturePool.cpp \
 	platform/graphics/android/TexturesGenerator.cpp \
+	platform/graphics/android/TilePrefetchPredictor.cpp \
 	platform/graphics/android/TilesManager.cpp \
 	platform/graphics/android/TilesProfiler.cpp \
 	platform/graphics/android/TiledPage.cpp \
@@ -715,8 +718,12 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	platform/graphics/GraphicsContext3D.cpp \
 	platform/graphics/android/Extensions3DAndroid.cpp \
 	platform/graphics/android/GraphicsContext3DAndroid.cpp \
+	platform/graphics/android/GraphicsContext3DCommandBuffer.cpp \
+	platform/graphics/android/GraphicsContext3DImageCache.cpp \
 	platform/graphics/android/GraphicsContext3DInternal.cpp \
 	platform/graphics/android/GraphicsContext3DProxy.cpp \
+	platform/graphics/android/GraphicsContext3DShaderCache.cpp \
+	platform/graphics/android/GraphicsContext3DSyncService.cpp \
 	platform/graphics/android/WebGLLayer.cpp \
 	platform/image-decoders/png/PNGImageDecoder.cpp
 endif
@@ -0,0 +1,4 @@
+#ifndef WebCore_FWD_GCActivityCallback_h
+#define WebCore_FWD_GCActivityCallback_h
+#include <JavaScriptCore/GCActivityCallback.h>
+#endif
@@ -27,6 +27,7 @@
 #include "GCController.h"
 
 #include "JSDOMWindow.h"
+#include <runtime/GCActivityCallback.h>
 #include <runtime/JSGlobalData.h>
 #include <runtime/JSLock.h>
 #include <heap/Heap.h>
@@ -36,6 +37,21 @@ using namespace JSC;
 
 namespace WebCore {
 
+#if !USE(CF)
+// Same pacing as the CF activity callback
+static const double sweepInterval = 0.1; // seconds
+static const double sweepTimeSlice = 0.01; // seconds
+
+class SweepActivityCallback : public GCActivityCallback {
+public:
+    virtual bool scheduleSweep()
+    {
+        gcController().sweepSoon();
+        return true;
+    }
+};
+#endif
+
 static void* collect(void*)
 {
     JSLock lock(SilenceAssertionsOnly);
@@ -51,6 +67,9 @@ GCController& gcController()
 
 GCController::GCController()
     : m_GCTimer(this, &GCController::gcTimerFired)
+#if !USE(CF)
+    , m_sweepTimer(this, &GCController::sweepTimerFired)
+#endif
 {
 }
 
@@ -72,6 +91,27 @@ void GCController::garbageCollectNow()
         collect(0);
 }
 
+#if !USE(CF)
+void GCController::installActivityCallback(Heap* heap)
+{
+    heap->setActivityCallback(adoptPtr(new SweepActivityCallback));
+}
+
+void GCController::sweepSoon()
+{
+    if (!m_sweepTimer.isActive())
+        m_sweepTimer.startOneShot(sweepInterval);
+}
+
+void GCController::sweepTimerFired(Timer<GCController>*)
+{
+    JSLock lock(SilenceAssertionsOnly);
+    Heap& heap = JSDOMWindow::commonJSGlobalData()->heap;
+    if (heap.isBusy() || !heap.sweepIncrementally(sweepTimeSlice))
+        m_sweepTimer.startOneShot(sweepInterval);
+}
+#endif
+
 void GCController::garbageCollectOnAlternateThreadForDebugging(bool waitUntilDone)
 {
     ThreadIdentifier threadID = createThread(collect, 0, "WebCore: GCController");
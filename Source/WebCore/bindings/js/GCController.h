@@ -28,6 +28,10 @@
 
 #include "Timer.h"
 
+namespace JSC {
+    class Heap;
+}
+
 namespace WebCore {
 
     class GCController {
@@ -40,11 +44,24 @@ namespace WebCore {
 
         void garbageCollectOnAlternateThreadForDebugging(bool waitUntilDone); // Used for stress testing.
 
+#if !USE(CF)
+        // Lets collections of the main thread heap leave their sweep to
+        // sweepSoon(), as the CF activity callback does with a run loop timer.
+        void installActivityCallback(JSC::Heap*);
+        // Sweeps the main thread heap in short slices while it is idle.
+        void sweepSoon();
+#endif
+
     private:
         GCController(); // Use gcController() instead
         void gcTimerFired(Timer<GCController>*);
         
         Timer<GCController> m_GCTimer;
+#if !USE(CF)
+        void sweepTimerFired(Timer<GCController>*);
+
+        Timer<GCController> m_sweepTimer;
+#endif
     };
 
     // Function to obtain the global GC controller.
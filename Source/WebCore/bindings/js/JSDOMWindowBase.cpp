@@ -27,6 +27,7 @@
 #include "Console.h"
 #include "DOMWindow.h"
 #include "Frame.h"
+#include "GCController.h"
 #include "InspectorController.h"
 #include "JSDOMWindowCustom.h"
 #include "JSNode.h"
@@ -180,6 +181,9 @@ JSGlobalData* JSDOMWindowBase::commonJSGlobalData()
         globalData->exclusiveThread = currentThread();
 #endif
         initNormalWorldClientData(globalData);
+#if !USE(CF)
+        gcController().installActivityCallback(&globalData->heap);
+#endif
     }
 
     return globalData;
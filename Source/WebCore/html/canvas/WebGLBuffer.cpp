@@ -35,6 +35,30 @@
 
 namespace WebCore {
 
+// Number of indices summarized by each leaf of a max index tree. The
+// partial blocks at either end of a queried range are scanned directly.
+static const unsigned s_maxIndexBlockSize = 16;
+
+static unsigned indexSizeInBytes(GC3Denum type)
+{
+    return type == GraphicsContext3D::UNSIGNED_SHORT ? sizeof(GC3Dushort) : sizeof(GC3Dubyte);
+}
+
+static int scanMaxIndex(GC3Denum type, const void* data, unsigned begin, unsigned end)
+{
+    int maxIndex = -1;
+    if (type == GraphicsContext3D::UNSIGNED_SHORT) {
+        const GC3Dushort* p = static_cast<const GC3Dushort*>(data);
+        for (unsigned i = begin; i < end; ++i)
+            maxIndex = std::max(maxIndex, static_cast<int>(p[i]));
+    } else {
+        const GC3Dubyte* p = static_cast<const GC3Dubyte*>(data);
+        for (unsigned i = begin; i < end; ++i)
+            maxIndex = std::max(maxIndex, static_cast<int>(p[i]));
+    }
+    return maxIndex;
+}
+
 PassRefPtr<WebGLBuffer> WebGLBuffer::create(WebGLRenderingContext* ctx)
 {
     return adoptRef(new WebGLBuffer(ctx));
@@ -44,10 +68,9 @@ WebGLBuffer::WebGLBuffer(WebGLRenderingContext* ctx)
     : WebGLObject(ctx)
     , m_target(0)
     , m_byteLength(0)
-    , m_nextAvailableCacheEntry(0)
 {
     setObject(context()->graphicsContext3D()->createBuffer());
-    clearCachedMaxIndices();
+    clearMaxIndexTrees();
 }
 
 void WebGLBuffer::deleteObjectImpl(Platform3DObject object)
@@ -71,7 +94,7 @@ bool WebGLBuffer::associateBufferDataImpl(ArrayBuffer* array, GC3Dintptr byteOff
     switch (m_target) {
     case GraphicsContext3D::ELEMENT_ARRAY_BUFFER:
         m_byteLength = byteLength;
-        clearCachedMaxIndices();
+        clearMaxIndexTrees();
         if (byteLength) {
             m_elementArrayBuffer = ArrayBuffer::create(byteLength, 1);
             if (!m_elementArrayBuffer) {
@@ -135,13 +158,16 @@ bool WebGLBuffer::associateBufferSubDataImpl(GC3Dintptr offset, ArrayBuffer* arr
 
     switch (m_target) {
     case GraphicsContext3D::ELEMENT_ARRAY_BUFFER:
-        clearCachedMaxIndices();
         if (byteLength) {
             if (!m_elementArrayBuffer)
                 return false;
             memcpy(static_cast<unsigned char*>(m_elementArrayBuffer->data()) + offset,
                    static_cast<unsigned char*>(array->data()) + arrayByteOffset,
                    byteLength);
+            if (m_maxIndexTrees[0].numLeaves)
+                updateMaxIndexTree(GraphicsContext3D::UNSIGNED_BYTE, &m_maxIndexTrees[0], offset, byteLength);
+            if (m_maxIndexTrees[1].numLeaves)
+                updateMaxIndexTree(GraphicsContext3D::UNSIGNED_SHORT, &m_maxIndexTrees[1], offset, byteLength);
         }
         return true;
     case GraphicsContext3D::ARRAY_BUFFER:
@@ -170,25 +196,86 @@ GC3Dsizeiptr WebGLBuffer::byteLength() const
     return m_byteLength;
 }
 
-int WebGLBuffer::getCachedMaxIndex(GC3Denum type)
+int WebGLBuffer::getMaxIndex(GC3Denum type, GC3Dintptr offset, GC3Dsizei count)
 {
-    for (size_t i = 0; i < WTF_ARRAY_LENGTH(m_maxIndexCache); ++i)
-        if (m_maxIndexCache[i].type == type)
-            return m_maxIndexCache[i].maxIndex;
-    return -1;
+    MaxIndexTree* tree = maxIndexTree(type);
+    if (!tree || count <= 0 || !m_elementArrayBuffer)
+        return -1;
+    if (!tree->numLeaves)
+        buildMaxIndexTree(type, tree);
+
+    const void* data = m_elementArrayBuffer->data();
+    unsigned first = offset / indexSizeInBytes(type);
+    unsigned last = first + count;
+    ASSERT(last <= m_byteLength / indexSizeInBytes(type));
+
+    // Whole blocks within [first, last) are [firstBlock, endBlock)
+    unsigned firstBlock = (first + s_maxIndexBlockSize - 1) / s_maxIndexBlockSize;
+    unsigned endBlock = last / s_maxIndexBlockSize;
+    if (firstBlock >= endBlock)
+        return scanMaxIndex(type, data, first, last);
+
+    int maxIndex = std::max(scanMaxIndex(type, data, first, firstBlock * s_maxIndexBlockSize),
+                            scanMaxIndex(type, data, endBlock * s_maxIndexBlockSize, last));
+    for (unsigned l = tree->numLeaves + firstBlock, r = tree->numLeaves + endBlock; l < r; l /= 2, r /= 2) {
+        if (l & 1)
+            maxIndex = std::max(maxIndex, static_cast<int>(tree->nodes[l++]));
+        if (r & 1)
+            maxIndex = std::max(maxIndex, static_cast<int>(tree->nodes[--r]));
+    }
+    return maxIndex;
 }
 
-void WebGLBuffer::setCachedMaxIndex(GC3Denum type, int value)
+WebGLBuffer::MaxIndexTree* WebGLBuffer::maxIndexTree(GC3Denum type)
 {
-    size_t numEntries = WTF_ARRAY_LENGTH(m_maxIndexCache);
-    for (size_t i = 0; i < numEntries; ++i)
-        if (m_maxIndexCache[i].type == type) {
-            m_maxIndexCache[i].maxIndex = value;
-            return;
-        }
-    m_maxIndexCache[m_nextAvailableCacheEntry].type = type;
-    m_maxIndexCache[m_nextAvailableCacheEntry].maxIndex = value;
-    m_nextAvailableCacheEntry = (m_nextAvailableCacheEntry + 1) % numEntries;
+    switch (type) {
+    case GraphicsContext3D::UNSIGNED_BYTE:
+        return &m_maxIndexTrees[0];
+    case GraphicsContext3D::UNSIGNED_SHORT:
+        return &m_maxIndexTrees[1];
+    default:
+        return 0;
+    }
+}
+
+void WebGLBuffer::buildMaxIndexTree(GC3Denum type, MaxIndexTree* tree)
+{
+    unsigned numIndices = m_byteLength / indexSizeInBytes(type);
+    unsigned numBlocks = (numIndices + s_maxIndexBlockSize - 1) / s_maxIndexBlockSize;
+    unsigned numLeaves = 1;
+    while (numLeaves < numBlocks)
+        numLeaves *= 2;
+
+    // Leaves past the end of the buffer stay zero, which never raises
+    // the maximum of a non-empty range.
+    tree->nodes.fill(0, 2 * numLeaves);
+    tree->numLeaves = numLeaves;
+    updateMaxIndexTree(type, tree, 0, m_byteLength);
+}
+
+void WebGLBuffer::updateMaxIndexTree(GC3Denum type, MaxIndexTree* tree, GC3Dintptr offset, GC3Dsizeiptr byteLength)
+{
+    unsigned size = indexSizeInBytes(type);
+    unsigned numIndices = m_byteLength / size;
+    unsigned first = offset / size;
+    unsigned last = std::min(static_cast<unsigned>((offset + byteLength + size - 1) / size), numIndices);
+    if (first >= last)
+        return;
+
+    const void* data = m_elementArrayBuffer->data();
+    unsigned firstBlock = first / s_maxIndexBlockSize;
+    unsigned lastBlock = (last - 1) / s_maxIndexBlockSize;
+    for (unsigned block = firstBlock; block <= lastBlock; ++block) {
+        unsigned begin = block * s_maxIndexBlockSize;
+        unsigned end = std::min(begin + s_maxIndexBlockSize, numIndices);
+        tree->nodes[tree->numLeaves + block] = scanMaxIndex(type, data, begin, end);
+    }
+
+    // Recompute the parents of the touched leaves one level at a time.
+    for (unsigned i = (tree->numLeaves + firstBlock) / 2, j = (tree->numLeaves + lastBlock) / 2; j; i /= 2, j /= 2) {
+        for (unsigned k = i; k <= j; ++k)
+            tree->nodes[k] = std::max(tree->nodes[2 * k], tree->nodes[2 * k + 1]);
+    }
 }
 
 void WebGLBuffer::setTarget(GC3Denum target)
@@ -200,9 +287,12 @@ void WebGLBuffer::setTarget(GC3Denum target)
         m_target = target;
 }
 
-void WebGLBuffer::clearCachedMaxIndices()
+void WebGLBuffer::clearMaxIndexTrees()
 {
-    memset(m_maxIndexCache, 0, sizeof(m_maxIndexCache));
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(m_maxIndexTrees); ++i) {
+        m_maxIndexTrees[i].numLeaves = 0;
+        m_maxIndexTrees[i].nodes.clear();
+    }
 }
 
 }
@@ -31,6 +31,7 @@
 
 #include <wtf/PassRefPtr.h>
 #include <wtf/RefCounted.h>
+#include <wtf/Vector.h>
 
 namespace WebCore {
 class ArrayBufferView;
@@ -50,11 +51,10 @@ public:
     GC3Dsizeiptr byteLength() const;
     const ArrayBuffer* elementArrayBuffer() const { return m_elementArrayBuffer.get(); }
 
-    // Gets the cached max index for the given type. Returns -1 if
-    // none has been set.
-    int getCachedMaxIndex(GC3Denum type);
-    // Sets the cached max index for the given type.
-    void setCachedMaxIndex(GC3Denum type, int value);
+    // Gets the max index of the given type among the count indices
+    // starting at byte offset, which must lie within the buffer.
+    // Returns -1 if count is zero or type is not a valid index type.
+    int getMaxIndex(GC3Denum type, GC3Dintptr offset, GC3Dsizei count);
 
     GC3Denum getTarget() const { return m_target; }
     void setTarget(GC3Denum);
@@ -75,24 +75,28 @@ private:
     GC3Dsizeiptr m_byteLength;
 
     // Optimization for index validation. For each type of index
-    // (i.e., UNSIGNED_SHORT), cache the maximum index in the
-    // entire buffer.
-    //
-    // This is sufficient to eliminate a lot of work upon each
-    // draw call as long as all bound array buffers are at least
-    // that size.
-    struct MaxIndexCacheEntry {
-        GC3Denum type;
-        int maxIndex;
+    // (i.e., UNSIGNED_SHORT), keep a segment tree over blocks of
+    // indices in the shadow copy, so the maximum index of any range
+    // can be found without scanning the whole range on every draw
+    // call. The trees are built on first use and updated in place
+    // by bufferSubData.
+    struct MaxIndexTree {
+        // Number of leaves, a power of two. Zero if not built.
+        unsigned numLeaves;
+        // Node 1 is the root, the children of node i are 2i and
+        // 2i + 1, and leaf j is node numLeaves + j.
+        Vector<GC3Dushort> nodes;
     };
-    // OpenGL ES 2.0 only has two valid index types (UNSIGNED_BYTE
-    // and UNSIGNED_SHORT), but might as well leave open the
-    // possibility of adding others.
-    MaxIndexCacheEntry m_maxIndexCache[4];
-    unsigned int m_nextAvailableCacheEntry;
-
-    // Clears all of the cached max indices.
-    void clearCachedMaxIndices();
+    // OpenGL ES 2.0 only has two valid index types, UNSIGNED_BYTE
+    // and UNSIGNED_SHORT.
+    MaxIndexTree m_maxIndexTrees[2];
+
+    MaxIndexTree* maxIndexTree(GC3Denum type);
+    void buildMaxIndexTree(GC3Denum type, MaxIndexTree*);
+    // Recomputes the blocks covering the given byte range and their parents.
+    void updateMaxIndexTree(GC3Denum type, MaxIndexTree*, GC3Dintptr offset, GC3Dsizeiptr byteLength);
+    // Clears all of the max index trees.
+    void clearMaxIndexTrees();
 
     // Helper function called by the three associateBufferData().
     bool associateBufferDataImpl(ArrayBuffer* array, GC3Dintptr byteOffset, GC3Dsizeiptr byteLength);
@@ -397,6 +397,7 @@ void WebGLRenderingContext::initializeNewContext()
     m_unpackColorspaceConversion = GraphicsContext3D::BROWSER_DEFAULT_WEBGL;
     m_boundArrayBuffer = 0;
     m_currentProgram = 0;
+    m_renderingStateGeneration = 0;
     m_framebufferBinding = 0;
     m_renderbufferBinding = 0;
     m_stencilMask = 0xFFFFFFFF;
@@ -854,6 +855,8 @@ void WebGLRenderingContext::bufferData(GC3Denum target, GC3Dsizeiptr size, GC3De
             return;
         }
     }
+    // The number of vertices an attrib bound to this buffer can supply changed.
+    ++m_renderingStateGeneration;
 
     m_context->bufferData(target, size, usage);
     cleanupAfterGraphicsCall(false);
@@ -877,6 +880,7 @@ void WebGLRenderingContext::bufferData(GC3Denum target, ArrayBuffer* data, GC3De
             return;
         }
     }
+    ++m_renderingStateGeneration;
 
     // Some platforms incorrectly signal GL_OUT_OF_MEMORY if size == 0
     if (data->byteLength() > 0)
@@ -902,6 +906,7 @@ void WebGLRenderingContext::bufferData(GC3Denum target, ArrayBufferView* data, G
             return;
         }
     }
+    ++m_renderingStateGeneration;
 
     // Some platforms incorrectly signal GL_OUT_OF_MEMORY if size == 0
     if (data->byteLength() > 0)
@@ -1271,6 +1276,8 @@ void WebGLRenderingContext::deleteBuffer(WebGLBuffer* buffer)
 {
     if (!deleteObject(buffer))
         return;
+    // Any vertex array object may have an attrib bound to the deleted buffer.
+    ++m_renderingStateGeneration;
     if (m_boundArrayBuffer == buffer)
         m_boundArrayBuffer = 0;
     RefPtr<WebGLBuffer> elementArrayBuffer = m_boundVertexArrayObject->getElementArrayBuffer();
@@ -1402,6 +1409,7 @@ void WebGLRenderingContext::disableVertexAttribArray(GC3Duint index, ExceptionCo
 
     WebGLVertexArrayObjectOES::VertexAttribState& state = m_boundVertexArrayObject->getVertexAttribState(index);
     state.enabled = false;
+    m_boundVertexArrayObject->invalidateRenderingStateCache();
 
     if (index > 0 || isGLES2Compliant()) {
         m_context->disableVertexAttribArray(index);
@@ -1440,8 +1448,8 @@ bool WebGLRenderingContext::validateElementArraySize(GC3Dsizei count, GC3Denum t
 
 bool WebGLRenderingContext::validateIndexArrayConservative(GC3Denum type, int& numElementsRequired)
 {
-    // Performs conservative validation by caching a maximum index of
-    // the given type per element array buffer. If all of the bound
+    // Performs conservative validation using the maximum index of
+    // the given type in the whole element array buffer. If all of the bound
     // array buffers have enough elements to satisfy that maximum
     // index, skips the expensive per-draw-call iteration in
     // validateIndexArrayPrecise.
@@ -1455,32 +1463,22 @@ bool WebGLRenderingContext::validateIndexArrayConservative(GC3Denum type, int& n
     // The case count==0 is already dealt with in drawElements before validateIndexArrayConservative.
     if (!numElements)
         return false;
-    const ArrayBuffer* buffer = elementArrayBuffer->elementArrayBuffer();
-    ASSERT(buffer);
-
-    int maxIndex = elementArrayBuffer->getCachedMaxIndex(type);
-    if (maxIndex < 0) {
-        // Compute the maximum index in the entire buffer for the given type of index.
-        switch (type) {
-        case GraphicsContext3D::UNSIGNED_BYTE: {
-            const GC3Dubyte* p = static_cast<const GC3Dubyte*>(buffer->data());
-            for (GC3Dsizeiptr i = 0; i < numElements; i++)
-                maxIndex = max(maxIndex, static_cast<int>(p[i]));
-            break;
-        }
-        case GraphicsContext3D::UNSIGNED_SHORT: {
-            numElements /= sizeof(GC3Dushort);
-            const GC3Dushort* p = static_cast<const GC3Dushort*>(buffer->data());
-            for (GC3Dsizeiptr i = 0; i < numElements; i++)
-                maxIndex = max(maxIndex, static_cast<int>(p[i]));
-            break;
-        }
-        default:
-            return false;
-        }
-        elementArrayBuffer->setCachedMaxIndex(type, maxIndex);
+    ASSERT(elementArrayBuffer->elementArrayBuffer());
+
+    switch (type) {
+    case GraphicsContext3D::UNSIGNED_BYTE:
+        break;
+    case GraphicsContext3D::UNSIGNED_SHORT:
+        numElements /= sizeof(GC3Dushort);
+        break;
+    default:
+        return false;
     }
 
+    // The max index over the entire buffer is kept at the root of the
+    // buffer's max index tree, so this is cheap after the first call.
+    int maxIndex = elementArrayBuffer->getMaxIndex(type, 0, numElements);
+
     if (maxIndex >= 0) {
         // The number of required elements is one more than the maximum
         // index that will be accessed.
@@ -1494,7 +1492,6 @@ bool WebGLRenderingContext::validateIndexArrayConservative(GC3Denum type, int& n
 bool WebGLRenderingContext::validateIndexArrayPrecise(GC3Dsizei count, GC3Denum type, GC3Dintptr offset, int& numElementsRequired)
 {
     ASSERT(count >= 0 && offset >= 0);
-    int lastIndex = -1;
     
     RefPtr<WebGLBuffer> elementArrayBuffer = m_boundVertexArrayObject->getElementArrayBuffer();
 
@@ -1509,26 +1506,9 @@ bool WebGLRenderingContext::validateIndexArrayPrecise(GC3Dsizei count, GC3Denum
     if (!elementArrayBuffer->elementArrayBuffer())
         return false;
 
-    unsigned long uoffset = offset;
-    unsigned long n = count;
-
-    if (type == GraphicsContext3D::UNSIGNED_SHORT) {
-        // Make uoffset an element offset.
-        uoffset /= sizeof(GC3Dushort);
-        const GC3Dushort* p = static_cast<const GC3Dushort*>(elementArrayBuffer->elementArrayBuffer()->data()) + uoffset;
-        while (n-- > 0) {
-            if (*p > lastIndex)
-                lastIndex = *p;
-            ++p;
-        }
-    } else if (type == GraphicsContext3D::UNSIGNED_BYTE) {
-        const GC3Dubyte* p = static_cast<const GC3Dubyte*>(elementArrayBuffer->elementArrayBuffer()->data()) + uoffset;
-        while (n-- > 0) {
-            if (*p > lastIndex)
-                lastIndex = *p;
-            ++p;
-        }
-    }
+    // Looks up the max index of the range in the buffer's max index
+    // tree instead of scanning all count indices.
+    int lastIndex = elementArrayBuffer->getMaxIndex(type, offset, count);
 
     // Then set the last index in the index array and make sure it is valid.
     numElementsRequired = lastIndex + 1;
@@ -1540,43 +1520,62 @@ bool WebGLRenderingContext::validateRenderingState(int numElementsRequired)
     if (!m_currentProgram)
         return false;
 
-    // Look in each enabled vertex attrib and check if they've been bound to a buffer.
-    for (unsigned i = 0; i < m_maxVertexAttribs; ++i) {
-        const WebGLVertexArrayObjectOES::VertexAttribState& state = m_boundVertexArrayObject->getVertexAttribState(i);
-        if (state.enabled
-            && (!state.bufferBinding || !state.bufferBinding->object()))
-            return false;
+    // The results only depend on the bound vertex array object, the sizes
+    // of the buffers its attribs are bound to and the current program, so
+    // they are cached on the vertex array object until one of those changes.
+    WebGLVertexArrayObjectOES::RenderingStateCache& cache = m_boundVertexArrayObject->renderingStateCache();
+    if (!cache.valid || cache.generation != m_renderingStateGeneration) {
+        cache.valid = true;
+        cache.generation = m_renderingStateGeneration;
+        cache.enabledAttribsBound = true;
+        cache.maxVertexCount = -1;
+
+        // Look in each enabled vertex attrib and check if they've been bound to a buffer.
+        for (unsigned i = 0; i < m_maxVertexAttribs; ++i) {
+            const WebGLVertexArrayObjectOES::VertexAttribState& state = m_boundVertexArrayObject->getVertexAttribState(i);
+            if (state.enabled
+                && (!state.bufferBinding || !state.bufferBinding->object())) {
+                cache.enabledAttribsBound = false;
+                break;
+            }
+        }
     }
 
+    if (!cache.enabledAttribsBound)
+        return false;
+
     if (numElementsRequired <= 0)
         return true;
 
-    // Look in each consumed vertex attrib (by the current program) and find the smallest buffer size
-    int smallestNumElements = INT_MAX;
-    int numActiveAttribLocations = m_currentProgram->numActiveAttribLocations();
-    for (int i = 0; i < numActiveAttribLocations; ++i) {
-        int loc = m_currentProgram->getActiveAttribLocation(i);
-        if (loc >= 0 && loc < static_cast<int>(m_maxVertexAttribs)) {
-            const WebGLVertexArrayObjectOES::VertexAttribState& state = m_boundVertexArrayObject->getVertexAttribState(loc);
-            if (state.enabled) {
-                // Avoid off-by-one errors in numElements computation.
-                // For the last element, we will only touch the data for the
-                // element and nothing beyond it.
-                int bytesRemaining = static_cast<int>(state.bufferBinding->byteLength() - state.offset);
-                int numElements = 0;
-                ASSERT(state.stride > 0);
-                if (bytesRemaining >= state.bytesPerElement)
-                    numElements = 1 + (bytesRemaining - state.bytesPerElement) / state.stride;
-                if (numElements < smallestNumElements)
-                    smallestNumElements = numElements;
+    if (cache.maxVertexCount < 0) {
+        // Look in each consumed vertex attrib (by the current program) and find the smallest buffer size
+        int smallestNumElements = INT_MAX;
+        int numActiveAttribLocations = m_currentProgram->numActiveAttribLocations();
+        for (int i = 0; i < numActiveAttribLocations; ++i) {
+            int loc = m_currentProgram->getActiveAttribLocation(i);
+            if (loc >= 0 && loc < static_cast<int>(m_maxVertexAttribs)) {
+                const WebGLVertexArrayObjectOES::VertexAttribState& state = m_boundVertexArrayObject->getVertexAttribState(loc);
+                if (state.enabled) {
+                    // Avoid off-by-one errors in numElements computation.
+                    // For the last element, we will only touch the data for the
+                    // element and nothing beyond it.
+                    int bytesRemaining = static_cast<int>(state.bufferBinding->byteLength() - state.offset);
+                    int numElements = 0;
+                    ASSERT(state.stride > 0);
+                    if (bytesRemaining >= state.bytesPerElement)
+                        numElements = 1 + (bytesRemaining - state.bytesPerElement) / state.stride;
+                    if (numElements < smallestNumElements)
+                        smallestNumElements = numElements;
+                }
             }
         }
-    }
 
-    if (smallestNumElements == INT_MAX)
-        smallestNumElements = 0;
+        if (smallestNumElements == INT_MAX)
+            smallestNumElements = 0;
+        cache.maxVertexCount = smallestNumElements;
+    }
 
-    return numElementsRequired <= smallestNumElements;
+    return numElementsRequired <= cache.maxVertexCount;
 }
 
 bool WebGLRenderingContext::validateWebGLObject(WebGLObject* object)
@@ -1744,6 +1743,7 @@ void WebGLRenderingContext::enableVertexAttribArray(GC3Duint index, ExceptionCod
 
     WebGLVertexArrayObjectOES::VertexAttribState& state = m_boundVertexArrayObject->getVertexAttribState(index);
     state.enabled = true;
+    m_boundVertexArrayObject->invalidateRenderingStateCache();
 
     m_context->enableVertexAttribArray(index);
     cleanupAfterGraphicsCall(false);
@@ -2819,6 +2819,9 @@ void WebGLRenderingContext::linkProgram(WebGLProgram* program, ExceptionCode& ec
     program->setLinkStatus(static_cast<bool>(value));
     // Need to cache link status before caching active attribute locations.
     program->cacheActiveAttribLocations();
+    // The active attribs of the current program may have changed.
+    if (program == m_currentProgram)
+        ++m_renderingStateGeneration;
     cleanupAfterGraphicsCall(false);
 }
 
@@ -3859,6 +3862,7 @@ void WebGLRenderingContext::useProgram(WebGLProgram* program, ExceptionCode& ec)
         if (m_currentProgram)
             m_currentProgram->onDetached();
         m_currentProgram = program;
+        ++m_renderingStateGeneration;
         m_context->useProgram(objectOrZero(program));
         if (program)
             program->onAttached();
@@ -3986,6 +3990,7 @@ void WebGLRenderingContext::vertexAttribPointer(GC3Duint index, GC3Dint size, GC
     state.stride = validatedStride;
     state.originalStride = stride;
     state.offset = offset;
+    m_boundVertexArrayObject->invalidateRenderingStateCache();
     m_context->vertexAttribPointer(index, size, type, normalized, stride, offset);
     cleanupAfterGraphicsCall(false);
 }
@@ -4928,6 +4933,7 @@ void WebGLRenderingContext::initVertexAttrib0()
     m_context->bufferData(GraphicsContext3D::ARRAY_BUFFER, 0, GraphicsContext3D::DYNAMIC_DRAW);
     m_context->vertexAttribPointer(0, 4, GraphicsContext3D::FLOAT, false, 0, 0);
     state.bufferBinding = m_vertexAttrib0Buffer;
+    m_boundVertexArrayObject->invalidateRenderingStateCache();
     m_context->bindBuffer(GraphicsContext3D::ARRAY_BUFFER, 0);
     m_context->enableVertexAttribArray(0);
     m_vertexAttrib0BufferSize = 0;
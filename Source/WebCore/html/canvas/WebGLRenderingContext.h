@@ -428,6 +428,10 @@ public:
     bool m_vertexAttrib0UsedBefore;
 
     RefPtr<WebGLProgram> m_currentProgram;
+    // Bumped when anything outside a vertex array object that
+    // validateRenderingState() depends on changes, which invalidates
+    // the RenderingStateCache of every vertex array object.
+    unsigned m_renderingStateGeneration;
     RefPtr<WebGLFramebuffer> m_framebufferBinding;
     RefPtr<WebGLRenderbuffer> m_renderbufferBinding;
     class TextureUnitState {
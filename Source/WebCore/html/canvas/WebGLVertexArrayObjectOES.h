@@ -80,6 +80,31 @@ public:
     
     VertexAttribState& getVertexAttribState(int index) { return m_vertexAttribState[index]; }
 
+    // Cached results of WebGLRenderingContext::validateRenderingState()
+    // for this vertex array. Only valid while generation matches the
+    // context's rendering state generation, which changes with array
+    // buffer sizes and the current program.
+    struct RenderingStateCache {
+        RenderingStateCache()
+            : valid(false)
+            , generation(0)
+            , enabledAttribsBound(false)
+            , maxVertexCount(-1)
+        {
+        }
+
+        bool valid;
+        unsigned generation;
+        bool enabledAttribsBound;
+        // Smallest number of vertices any attrib read by the current
+        // program can supply, or -1 if not computed yet.
+        int maxVertexCount;
+    };
+
+    RenderingStateCache& renderingStateCache() { return m_renderingStateCache; }
+    // Must be called whenever a VertexAttribState of this object changes.
+    void invalidateRenderingStateCache() { m_renderingStateCache.valid = false; }
+
 private:
     WebGLVertexArrayObjectOES(WebGLRenderingContext*, VaoType);
 
@@ -91,6 +116,7 @@ private:
     bool m_hasEverBeenBound;
     RefPtr<WebGLBuffer> m_boundElementArrayBuffer;
     Vector<VertexAttribState> m_vertexAttribState;
+    RenderingStateCache m_renderingStateCache;
 };
 
 } // namespace WebCore
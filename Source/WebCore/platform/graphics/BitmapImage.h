@@ -162,6 +162,7 @@ public:
 
     virtual NativeImagePtr nativeImageForCurrentFrame() { return frameAtIndex(currentFrame()); }
     bool frameHasAlphaAtIndex(size_t); 
+    size_t frameCount();
 
 #if !ASSERT_DISABLED
     bool notSolidColor()
@@ -195,7 +196,6 @@ protected:
 #endif
 
     size_t currentFrame() const { return m_currentFrame; }
-    size_t frameCount();
     NativeImagePtr frameAtIndex(size_t);
     bool frameIsCompleteAtIndex(size_t);
     float frameDurationAtIndex(size_t);
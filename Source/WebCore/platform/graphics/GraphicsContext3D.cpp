@@ -40,6 +40,17 @@
 #include <wtf/OwnArrayPtr.h>
 #include <wtf/PassOwnArrayPtr.h>
 
+#if CPU(ARM_NEON) && COMPILER(GCC)
+#include "GraphicsContext3DNEON.h"
+#include "GraphicsContext3DScaleTables.h"
+#define HAVE_PACKING_SIMD 1
+#define HAVE_PACKING_SIMD_RGB8 1
+#elif (CPU(X86) || CPU(X86_64)) && defined(__SSE2__) && COMPILER(GCC)
+#include "GraphicsContext3DSSE2.h"
+#include "GraphicsContext3DScaleTables.h"
+#define HAVE_PACKING_SIMD 1
+#endif
+
 namespace WebCore {
 
 namespace {
@@ -1220,6 +1231,152 @@ static void doFloatingPointPacking(const void* sourceData,
     }
 }
 
+#if defined(HAVE_PACKING_SIMD)
+namespace {
+
+unsigned packRowRGBA8ToRGBA8Premultiply(const uint8_t* source, uint8_t* destination, unsigned pixelCount)
+{
+    return SIMD::packOneRowOfRGBA8ToRGBA8Scaled(source, destination, pixelCount, SIMD::premultiplyScaleTable, false);
+}
+
+unsigned packRowRGBA8ToRGBA8Unmultiply(const uint8_t* source, uint8_t* destination, unsigned pixelCount)
+{
+    return SIMD::packOneRowOfRGBA8ToRGBA8Scaled(source, destination, pixelCount, SIMD::unmultiplyScaleTable, false);
+}
+
+unsigned packRowBGRA8ToRGBA8(const uint8_t* source, uint8_t* destination, unsigned pixelCount)
+{
+    return SIMD::packOneRowOfBGRA8ToRGBA8(source, destination, pixelCount);
+}
+
+unsigned packRowBGRA8ToRGBA8Premultiply(const uint8_t* source, uint8_t* destination, unsigned pixelCount)
+{
+    return SIMD::packOneRowOfRGBA8ToRGBA8Scaled(source, destination, pixelCount, SIMD::premultiplyScaleTable, true);
+}
+
+unsigned packRowRGBA8ToUnsignedShort565(const uint8_t* source, uint16_t* destination, unsigned pixelCount)
+{
+    return SIMD::packOneRowOfRGBA8ToUnsignedShort565(source, destination, pixelCount);
+}
+
+#if defined(HAVE_PACKING_SIMD_RGB8)
+unsigned packRowRGBA8ToRGB8(const uint8_t* source, uint8_t* destination, unsigned pixelCount)
+{
+    return SIMD::packOneRowOfRGBA8ToRGB8(source, destination, pixelCount);
+}
+
+unsigned packRowRGBA8ToRGB8Premultiply(const uint8_t* source, uint8_t* destination, unsigned pixelCount)
+{
+    return SIMD::packOneRowOfRGBA8ToRGB8Scaled(source, destination, pixelCount, SIMD::premultiplyScaleTable);
+}
+#endif
+
+} // anonymous namespace
+
+// Vectorized counterpart of doUnpackingAndPacking for 8-bit, four channel
+// sources. The row function converts what it can of each row; the scalar
+// unpacking and packing functions finish the rest of the row.
+template<typename DestType,
+         unsigned rowFunc(const uint8_t*, DestType*, unsigned),
+         void unpackingFunc(const uint8_t*, uint8_t*),
+         void packingFunc(const uint8_t*, DestType*)>
+static void doSIMDPacking(const uint8_t* sourceData,
+                          unsigned int width,
+                          unsigned int height,
+                          unsigned int sourceUnpackAlignment,
+                          DestType* destinationData,
+                          unsigned int destinationElementsPerPixel)
+{
+    unsigned int sourceElementsPerPixel, sourceElementsPerRow;
+    computeIncrementParameters<uint8_t>(width, 4, sourceUnpackAlignment, &sourceElementsPerPixel, &sourceElementsPerRow);
+    // Tightly packed data is converted as one long row.
+    unsigned int rows = sourceElementsPerRow ? height : 1;
+    unsigned int pixelsPerRow = sourceElementsPerRow ? width : width * height;
+
+    for (unsigned int y = 0; y < rows; ++y) {
+        unsigned int done = rowFunc(sourceData, destinationData, pixelsPerRow);
+        uint8_t temporaryRGBAData[4];
+        for (unsigned int x = done; x < pixelsPerRow; ++x) {
+            unpackingFunc(sourceData + x * 4, temporaryRGBAData);
+            packingFunc(temporaryRGBAData, destinationData + x * destinationElementsPerPixel);
+        }
+        sourceData += sourceElementsPerRow;
+        destinationData += pixelsPerRow * destinationElementsPerPixel;
+    }
+}
+
+// Returns false if there is no vectorized path for the conversion, in
+// which case the caller falls back to the scalar code.
+static bool packPixelsSIMD(const uint8_t* sourceData,
+                           GraphicsContext3D::SourceDataFormat sourceDataFormat,
+                           unsigned int width,
+                           unsigned int height,
+                           unsigned int sourceUnpackAlignment,
+                           unsigned int destinationFormat,
+                           unsigned int destinationType,
+                           GraphicsContext3D::AlphaOp alphaOp,
+                           void* destinationData)
+{
+    uint8_t* destination = static_cast<uint8_t*>(destinationData);
+    if (sourceDataFormat == GraphicsContext3D::SourceFormatBGRA8) {
+        if (destinationType != GraphicsContext3D::UNSIGNED_BYTE || destinationFormat != GraphicsContext3D::RGBA)
+            return false;
+        switch (alphaOp) {
+        case GraphicsContext3D::AlphaDoNothing:
+            doSIMDPacking<uint8_t, packRowBGRA8ToRGBA8, unpackBGRA8ToRGBA8, packRGBA8ToRGBA8>(sourceData, width, height, sourceUnpackAlignment, destination, 4);
+            return true;
+        case GraphicsContext3D::AlphaDoPremultiply:
+            doSIMDPacking<uint8_t, packRowBGRA8ToRGBA8Premultiply, unpackBGRA8ToRGBA8, packRGBA8ToRGBA8Premultiply>(sourceData, width, height, sourceUnpackAlignment, destination, 4);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    if (sourceDataFormat != GraphicsContext3D::SourceFormatRGBA8)
+        return false;
+
+    switch (destinationType) {
+    case GraphicsContext3D::UNSIGNED_BYTE:
+        switch (destinationFormat) {
+        case GraphicsContext3D::RGBA:
+            switch (alphaOp) {
+            case GraphicsContext3D::AlphaDoPremultiply:
+                doSIMDPacking<uint8_t, packRowRGBA8ToRGBA8Premultiply, unpackRGBA8ToRGBA8, packRGBA8ToRGBA8Premultiply>(sourceData, width, height, sourceUnpackAlignment, destination, 4);
+                return true;
+            case GraphicsContext3D::AlphaDoUnmultiply:
+                doSIMDPacking<uint8_t, packRowRGBA8ToRGBA8Unmultiply, unpackRGBA8ToRGBA8, packRGBA8ToRGBA8Unmultiply>(sourceData, width, height, sourceUnpackAlignment, destination, 4);
+                return true;
+            default:
+                return false;
+            }
+#if defined(HAVE_PACKING_SIMD_RGB8)
+        case GraphicsContext3D::RGB:
+            switch (alphaOp) {
+            case GraphicsContext3D::AlphaDoNothing:
+                doSIMDPacking<uint8_t, packRowRGBA8ToRGB8, unpackRGBA8ToRGBA8, packRGBA8ToRGB8>(sourceData, width, height, sourceUnpackAlignment, destination, 3);
+                return true;
+            case GraphicsContext3D::AlphaDoPremultiply:
+                doSIMDPacking<uint8_t, packRowRGBA8ToRGB8Premultiply, unpackRGBA8ToRGBA8, packRGBA8ToRGB8Premultiply>(sourceData, width, height, sourceUnpackAlignment, destination, 3);
+                return true;
+            default:
+                return false;
+            }
+#endif
+        default:
+            return false;
+        }
+    case GraphicsContext3D::UNSIGNED_SHORT_5_6_5:
+        if (alphaOp != GraphicsContext3D::AlphaDoNothing)
+            return false;
+        doSIMDPacking<uint16_t, packRowRGBA8ToUnsignedShort565, unpackRGBA8ToRGBA8, packRGBA8ToUnsignedShort565>(sourceData, width, height, sourceUnpackAlignment, static_cast<uint16_t*>(destinationData), 1);
+        return true;
+    default:
+        return false;
+    }
+}
+#endif // defined(HAVE_PACKING_SIMD)
+
 bool GraphicsContext3D::packPixels(const uint8_t* sourceData,
                                    GraphicsContext3D::SourceDataFormat sourceDataFormat,
                                    unsigned int width,
@@ -1238,6 +1395,10 @@ bool GraphicsContext3D::packPixels(const uint8_t* sourceData,
             memcpy(destinationData, sourceData, width * height * 4);
             break;
         }
+#if defined(HAVE_PACKING_SIMD)
+        if (packPixelsSIMD(sourceData, sourceDataFormat, width, height, sourceUnpackAlignment, destinationFormat, destinationType, alphaOp, destinationData))
+            break;
+#endif
         switch (destinationFormat) {
         case RGB:
             switch (alphaOp) {
@@ -1340,6 +1501,10 @@ bool GraphicsContext3D::packPixels(const uint8_t* sourceData,
         break;
     }
     case UNSIGNED_SHORT_5_6_5: {
+#if defined(HAVE_PACKING_SIMD)
+        if (packPixelsSIMD(sourceData, sourceDataFormat, width, height, sourceUnpackAlignment, destinationFormat, destinationType, alphaOp, destinationData))
+            break;
+#endif
         uint16_t* destination = static_cast<uint16_t*>(destinationData);
         switch (alphaOp) {
         case AlphaDoNothing:
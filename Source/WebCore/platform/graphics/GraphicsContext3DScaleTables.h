@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GraphicsContext3DScaleTables_h
+#define GraphicsContext3DScaleTables_h
+
+namespace WebCore {
+
+namespace SIMD {
+
+// Per-alpha scale factors for the vectorized packing routines, the exact
+// single precision values of the scalar packing functions' factors:
+// alpha / 255.0f to premultiply, and 1.0f / (alpha ? alpha / 255.0f : 1.0f)
+// to unmultiply. Constant, so that packing can run on any thread.
+
+static const float premultiplyScaleTable[256] = {
+    0.0f, 0.00392156886f, 0.00784313772f, 0.0117647061f, 0.0156862754f, 0.0196078438f,
+    0.0235294122f, 0.0274509806f, 0.0313725509f, 0.0352941193f, 0.0392156877f, 0.0431372561f,
+    0.0470588244f, 0.0509803928f, 0.0549019612f, 0.0588235296f, 0.0627451017f, 0.0666666701f,
+    0.0705882385f, 0.0745098069f, 0.0784313753f, 0.0823529437f, 0.0862745121f, 0.0901960805f,
+    0.0941176489f, 0.0980392173f, 0.101960786f, 0.105882354f, 0.109803922f, 0.113725491f,
+    0.117647059f, 0.121568628f, 0.125490203f, 0.129411772f, 0.13333334f, 0.137254909f,
+    0.141176477f, 0.145098045f, 0.149019614f, 0.152941182f, 0.156862751f, 0.160784319f,
+    0.164705887f, 0.168627456f, 0.172549024f, 0.176470593f, 0.180392161f, 0.184313729f,
+    0.188235298f, 0.192156866f, 0.196078435f, 0.200000003f, 0.203921571f, 0.20784314f,
+    0.211764708f, 0.215686277f, 0.219607845f, 0.223529413f, 0.227450982f, 0.23137255f,
+    0.235294119f, 0.239215687f, 0.243137255f, 0.247058824f, 0.250980407f, 0.254901975f,
+    0.258823544f, 0.262745112f, 0.266666681f, 0.270588249f, 0.274509817f, 0.278431386f,
+    0.282352954f, 0.286274523f, 0.290196091f, 0.294117659f, 0.298039228f, 0.301960796f,
+    0.305882365f, 0.309803933f, 0.313725501f, 0.31764707f, 0.321568638f, 0.325490206f,
+    0.329411775f, 0.333333343f, 0.337254912f, 0.34117648f, 0.345098048f, 0.349019617f,
+    0.352941185f, 0.356862754f, 0.360784322f, 0.36470589f, 0.368627459f, 0.372549027f,
+    0.376470596f, 0.380392164f, 0.384313732f, 0.388235301f, 0.392156869f, 0.396078438f,
+    0.400000006f, 0.403921574f, 0.407843143f, 0.411764711f, 0.41568628f, 0.419607848f,
+    0.423529416f, 0.427450985f, 0.431372553f, 0.435294122f, 0.43921569f, 0.443137258f,
+    0.447058827f, 0.450980395f, 0.454901963f, 0.458823532f, 0.4627451f, 0.466666669f,
+    0.470588237f, 0.474509805f, 0.478431374f, 0.482352942f, 0.486274511f, 0.490196079f,
+    0.494117647f, 0.498039216f, 0.501960814f, 0.505882382f, 0.509803951f, 0.513725519f,
+    0.517647088f, 0.521568656f, 0.525490224f, 0.529411793f, 0.533333361f, 0.53725493f,
+    0.541176498f, 0.545098066f, 0.549019635f, 0.552941203f, 0.556862772f, 0.56078434f,
+    0.564705908f, 0.568627477f, 0.572549045f, 0.576470613f, 0.580392182f, 0.58431375f,
+    0.588235319f, 0.592156887f, 0.596078455f, 0.600000024f, 0.603921592f, 0.607843161f,
+    0.611764729f, 0.615686297f, 0.619607866f, 0.623529434f, 0.627451003f, 0.631372571f,
+    0.635294139f, 0.639215708f, 0.643137276f, 0.647058845f, 0.650980413f, 0.654901981f,
+    0.65882355f, 0.662745118f, 0.666666687f, 0.670588255f, 0.674509823f, 0.678431392f,
+    0.68235296f, 0.686274529f, 0.690196097f, 0.694117665f, 0.698039234f, 0.701960802f,
+    0.70588237f, 0.709803939f, 0.713725507f, 0.717647076f, 0.721568644f, 0.725490212f,
+    0.729411781f, 0.733333349f, 0.737254918f, 0.741176486f, 0.745098054f, 0.749019623f,
+    0.752941191f, 0.75686276f, 0.760784328f, 0.764705896f, 0.768627465f, 0.772549033f,
+    0.776470602f, 0.78039217f, 0.784313738f, 0.788235307f, 0.792156875f, 0.796078444f,
+    0.800000012f, 0.80392158f, 0.807843149f, 0.811764717f, 0.815686285f, 0.819607854f,
+    0.823529422f, 0.827450991f, 0.831372559f, 0.835294127f, 0.839215696f, 0.843137264f,
+    0.847058833f, 0.850980401f, 0.854901969f, 0.858823538f, 0.862745106f, 0.866666675f,
+    0.870588243f, 0.874509811f, 0.87843138f, 0.882352948f, 0.886274517f, 0.890196085f,
+    0.894117653f, 0.898039222f, 0.90196079f, 0.905882359f, 0.909803927f, 0.913725495f,
+    0.917647064f, 0.921568632f, 0.925490201f, 0.929411769f, 0.933333337f, 0.937254906f,
+    0.941176474f, 0.945098042f, 0.949019611f, 0.952941179f, 0.956862748f, 0.960784316f,
+    0.964705884f, 0.968627453f, 0.972549021f, 0.97647059f, 0.980392158f, 0.984313726f,
+    0.988235295f, 0.992156863f, 0.996078432f, 1.0f
+};
+
+static const float unmultiplyScaleTable[256] = {
+    1.0f, 254.999985f, 127.499992f, 85.0f, 63.7499962f, 51.0f,
+    42.5f, 36.4285698f, 31.8749981f, 28.3333321f, 25.5f, 23.181818f,
+    21.25f, 19.6153851f, 18.2142849f, 17.0f, 15.937499f, 14.999999f,
+    14.166666f, 13.421052f, 12.75f, 12.1428566f, 11.590909f, 11.086956f,
+    10.625f, 10.1999998f, 9.80769253f, 9.44444466f, 9.10714245f, 8.79310322f,
+    8.5f, 8.22580624f, 7.96874952f, 7.72727251f, 7.49999952f, 7.28571415f,
+    7.08333302f, 6.89189148f, 6.71052599f, 6.53846121f, 6.375f, 6.21951199f,
+    6.0714283f, 5.93023252f, 5.7954545f, 5.66666651f, 5.54347801f, 5.42553186f,
+    5.3125f, 5.20408154f, 5.0999999f, 5.0f, 4.90384626f, 4.81132078f,
+    4.72222233f, 4.63636351f, 4.55357122f, 4.47368431f, 4.39655161f, 4.32203388f,
+    4.25f, 4.18032789f, 4.11290312f, 4.04761887f, 3.98437476f, 3.92307663f,
+    3.86363626f, 3.80596995f, 3.74999976f, 3.69565201f, 3.64285707f, 3.59154916f,
+    3.54166651f, 3.49315047f, 3.44594574f, 3.39999986f, 3.35526299f, 3.31168818f,
+    3.2692306f, 3.22784805f, 3.1875f, 3.14814806f, 3.10975599f, 3.07228899f,
+    3.03571415f, 3.0f, 2.96511626f, 2.93103433f, 2.89772725f, 2.86516857f,
+    2.83333325f, 2.80219769f, 2.77173901f, 2.74193549f, 2.71276593f, 2.68421054f,
+    2.65625f, 2.62886596f, 2.60204077f, 2.5757575f, 2.54999995f, 2.52475238f,
+    2.5f, 2.47572803f, 2.45192313f, 2.42857146f, 2.40566039f, 2.38317752f,
+    2.36111116f, 2.33944941f, 2.31818175f, 2.29729724f, 2.27678561f, 2.2566371f,
+    2.23684216f, 2.21739125f, 2.1982758f, 2.17948723f, 2.16101694f, 2.14285707f,
+    2.125f, 2.10743809f, 2.09016395f, 2.07317066f, 2.05645156f, 2.03999996f,
+    2.02380943f, 2.00787401f, 1.99218738f, 1.97674406f, 1.96153831f, 1.94656479f,
+    1.93181813f, 1.91729307f, 1.90298498f, 1.88888884f, 1.87499988f, 1.86131382f,
+    1.847826f, 1.83453226f, 1.82142854f, 1.80851054f, 1.79577458f, 1.78321671f,
+    1.77083325f, 1.75862062f, 1.74657524f, 1.73469377f, 1.72297287f, 1.71140933f,
+    1.69999993f, 1.68874168f, 1.6776315f, 1.66666663f, 1.65584409f, 1.64516127f,
+    1.6346153f, 1.6242038f, 1.61392403f, 1.60377347f, 1.59375f, 1.58385086f,
+    1.57407403f, 1.56441712f, 1.554878f, 1.5454545f, 1.5361445f, 1.52694607f,
+    1.51785707f, 1.50887573f, 1.5f, 1.49122798f, 1.48255813f, 1.47398841f,
+    1.46551716f, 1.45714283f, 1.44886363f, 1.44067788f, 1.43258429f, 1.42458093f,
+    1.41666663f, 1.4088397f, 1.40109885f, 1.39344263f, 1.3858695f, 1.37837839f,
+    1.37096775f, 1.36363637f, 1.35638297f, 1.34920633f, 1.34210527f, 1.33507848f,
+    1.328125f, 1.32124352f, 1.31443298f, 1.30769229f, 1.30102038f, 1.29441619f,
+    1.28787875f, 1.281407f, 1.27499998f, 1.26865673f, 1.26237619f, 1.25615764f,
+    1.25f, 1.24390244f, 1.23786402f, 1.231884f, 1.22596157f, 1.22009563f,
+    1.21428573f, 1.20853078f, 1.2028302f, 1.19718313f, 1.19158876f, 1.18604648f,
+    1.18055558f, 1.17511523f, 1.1697247f, 1.16438353f, 1.15909088f, 1.15384614f,
+    1.14864862f, 1.14349771f, 1.13839281f, 1.13333333f, 1.12831855f, 1.123348f,
+    1.11842108f, 1.11353707f, 1.10869563f, 1.10389614f, 1.0991379f, 1.09442055f,
+    1.08974361f, 1.08510637f, 1.08050847f, 1.07594931f, 1.07142854f, 1.06694555f,
+    1.0625f, 1.05809128f, 1.05371904f, 1.04938269f, 1.04508197f, 1.04081631f,
+    1.03658533f, 1.03238869f, 1.02822578f, 1.02409637f, 1.01999998f, 1.01593626f,
+    1.01190472f, 1.00790513f, 1.00393701f, 1.0f
+};
+
+} // namespace SIMD
+
+} // namespace WebCore
+
+#endif // GraphicsContext3DScaleTables_h
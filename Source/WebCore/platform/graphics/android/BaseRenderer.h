@@ -39,6 +39,7 @@ namespace WebCore {
 class TextureInfo;
 class TilePainter;
 class BaseTile;
+class BaseTileTexture;
 
 struct TileRenderInfo {
     // coordinates of the tile
@@ -63,6 +64,10 @@ struct TileRenderInfo {
     // info about the texture that we are to render into
     TextureInfo* textureInfo;
 
+    // texture holding the previous content of the tile, to be copied into the
+    // texture we render into before the (partial) invalRect is applied
+    BaseTileTexture* sourceTexture;
+
     // specifies whether or not to measure the rendering performance
     bool measurePerf;
 };
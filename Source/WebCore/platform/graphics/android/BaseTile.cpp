@@ -69,6 +69,7 @@ BaseTile::BaseTile(bool isLayerTile)
     , m_repaintPending(false)
     , m_lastDirtyPicture(0)
     , m_isTexturePainted(false)
+    , m_lastPaintedTexture(0)
     , m_isLayerTile(isLayerTile)
     , m_drawCount(0)
     , m_state(Unpainted)
@@ -166,6 +167,8 @@ bool BaseTile::removeTexture(BaseTileTexture* texture)
         m_state = Unpainted;
         m_backTexture = 0;
     }
+    if (m_lastPaintedTexture == texture)
+        m_lastPaintedTexture = 0;
 
     // mark dirty regardless of which texture was taken - the back texture may
     // have been ready to swap
@@ -355,6 +358,9 @@ void BaseTile::paintBitmap()
     const int x = m_x;
     const int y = m_y;
     TilePainter* painter = m_painter;
+    BaseTileTexture* lastPaintedTexture = m_lastPaintedTexture;
+    if (lastPaintedTexture != texture && lastPaintedTexture != m_frontTexture)
+        lastPaintedTexture = 0;
 
     if (!dirty || !texture) {
         m_atomicSync.unlock();
@@ -407,8 +413,21 @@ void BaseTile::paintBitmap()
 
     bool surfaceTextureMode = textureInfo->getSharedTextureMode() == SurfaceTextureMode;
 
-    if (surfaceTextureMode)
+    // In SurfaceTextureMode the dirty rects only travel through the transfer
+    // queue, and get blitted on top of the content of the last painted
+    // texture. If that texture is the front one, the UI thread first copies it
+    // into the back texture along with the first rect.
+    renderInfo.sourceTexture = 0;
+    if (surfaceTextureMode) {
+#if DEPRECATED_SURFACE_TEXTURE_MODE
         fullRepaint = true;
+#else
+        if (!lastPaintedTexture)
+            fullRepaint = true;
+        else if (lastPaintedTexture != texture)
+            renderInfo.sourceTexture = lastPaintedTexture;
+#endif
+    }
 
     while (!fullRepaint && !cliperator.done()) {
         SkRect realTileRect;
@@ -417,14 +436,7 @@ void BaseTile::paintBitmap()
         bool intersect = intersectWithRect(x, y, tileWidth, tileHeight,
                                            scale, dirtyRect, realTileRect);
 
-        // With SurfaceTexture, just repaint the entire tile if we intersect
-        // TODO: Implement the partial invalidate in Surface Texture Mode
-        if (intersect && surfaceTextureMode) {
-            fullRepaint = true;
-            break;
-        }
-
-        if (intersect && !surfaceTextureMode) {
+        if (intersect) {
             // initialize finalRealRect to the rounded values of realTileRect
             SkIRect finalRealRect;
             realTileRect.roundOut(&finalRealRect);
@@ -448,6 +460,9 @@ void BaseTile::paintBitmap()
             renderInfo.measurePerf = false;
 
             pictureCount = m_renderer->renderTiledContent(renderInfo);
+
+            // the following rects go on top of the first one
+            renderInfo.sourceTexture = 0;
         }
 
         cliperator.next();
@@ -459,6 +474,7 @@ void BaseTile::paintBitmap()
         rect.set(0, 0, tileWidth, tileHeight);
 
         renderInfo.invalRect = &rect;
+        renderInfo.sourceTexture = 0;
         renderInfo.measurePerf = TilesManager::instance()->getShowVisualIndicator();
 
         pictureCount = m_renderer->renderTiledContent(renderInfo);
@@ -476,6 +492,10 @@ void BaseTile::paintBitmap()
         // set the fullrepaint flags
         m_fullRepaint[m_currentDirtyAreaIndex] = false;
 
+        // if the transfer failed (or the tile got invalidated under us), the
+        // content of the texture can't be relied on for the next partial paint
+        m_lastPaintedTexture = (m_state != Unpainted) ? texture : 0;
+
         // The various checks to see if we are still dirty...
 
         m_dirty = false;
@@ -526,6 +546,7 @@ void BaseTile::discardTextures() {
         m_dirtyArea[i].setEmpty();
         m_fullRepaint[i] = true;
     }
+    m_lastPaintedTexture = 0;
     m_dirty = true;
     m_state = Unpainted;
 }
@@ -536,6 +557,8 @@ void BaseTile::discardBackTexture() {
         m_backTexture->release(this);
         m_backTexture = 0;
     }
+    // the dirty area the discarded content was painted for is gone as well
+    m_lastPaintedTexture = 0;
     m_state = Unpainted;
     m_dirty = true;
 }
@@ -544,8 +567,11 @@ bool BaseTile::swapTexturesIfNeeded() {
     android::AutoMutex lock(m_atomicSync);
     if (m_state == ReadyToSwap) {
         // discard old texture and swap the new one in its place
-        if (m_frontTexture)
+        if (m_frontTexture) {
+            if (m_lastPaintedTexture == m_frontTexture)
+                m_lastPaintedTexture = 0;
             m_frontTexture->release(this);
+        }
 
         m_frontTexture = m_backTexture;
         m_backTexture = 0;
@@ -180,6 +180,11 @@ private:
     // flag used to know if we have a texture that was painted at least once
     bool m_isTexturePainted;
 
+    // texture that received the latest successful paint, i.e. the one holding
+    // the content the dirty area is relative to. In SurfaceTextureMode, a
+    // partial paint is only possible while this is the front or back texture.
+    BaseTileTexture* m_lastPaintedTexture;
+
     // This mutex serves two purposes. (1) It ensures that certain operations
     // happen atomically and (2) it makes sure those operations are synchronized
     // across all threads and cores.
@@ -60,6 +60,7 @@ BaseTileTexture::BaseTileTexture(uint32_t w, uint32_t h)
 {
     m_size.set(w, h);
     m_ownTextureId = 0;
+    m_isAvailable = false;
 
     // Make sure they are created on the UI thread.
     TilesManager::instance()->transferQueue()->initSharedSurfaceTextures(w, h);
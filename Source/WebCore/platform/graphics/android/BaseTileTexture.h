@@ -110,6 +110,10 @@ public:
 
     void setOwnTextureTileInfoFromQueue(const TextureTileInfo* info);
 
+    // whether TilesManager can still hand out the texture in the current
+    // frame, maintained by its TexturePool under the textures lock
+    bool m_isAvailable;
+
 protected:
     HashMap<SharedTexture*, TextureTileInfo*> m_texturesInfo;
 
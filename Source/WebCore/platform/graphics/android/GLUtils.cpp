@@ -316,6 +316,7 @@ void GLUtils::deleteTexture(GLuint* texture)
 GLuint GLUtils::createSampleColorTexture(int r, int g, int b) {
     GLuint texture;
     glGenTextures(1, &texture);
+    TilesManager::instance()->shader()->forgetTexture(texture);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     GLubyte pixels[4 *3] = {
         r, g, b,
@@ -336,6 +337,7 @@ GLuint GLUtils::createSampleTexture()
 {
     GLuint texture;
     glGenTextures(1, &texture);
+    TilesManager::instance()->shader()->forgetTexture(texture);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     GLubyte pixels[4 *3] = {
         255, 0, 0,
@@ -356,6 +358,7 @@ GLuint GLUtils::createBaseTileGLTexture(int width, int height)
 {
     GLuint texture;
     glGenTextures(1, &texture);
+    TilesManager::instance()->shader()->forgetTexture(texture);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     GLubyte* pixels = 0;
 #ifdef DEBUG
@@ -509,6 +512,7 @@ void GLUtils::createTextureWithBitmap(GLuint texture, const SkBitmap& bitmap, GL
              " internalformat 0x%x, type 0x%x, bitmap.getPixels() %p",
              bitmap.width(), bitmap.height(), internalformat, type, bitmap.getPixels());
     }
+    TilesManager::instance()->shader()->forgetTexture(texture);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
 
@@ -540,6 +544,7 @@ void GLUtils::updateTextureWithBitmap(GLuint texture, int x, int y, const SkBitm
              " x %d, y %d, internalformat 0x%x, type 0x%x, bitmap.getPixels() %p",
              bitmap.width(), bitmap.height(), x, y, internalformat, type, bitmap.getPixels());
     }
+    TilesManager::instance()->shader()->forgetTexture(texture);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
 }
@@ -558,6 +563,7 @@ void GLUtils::createTextureFromEGLImage(GLuint texture, EGLImageKHR image, GLint
     glBindTexture(GL_TEXTURE_2D, texture);
     GLUtils::checkGlError("glBindTexture");
     glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, (GLeglImageOES)image);
+    TilesManager::instance()->shader()->forgetTexture(texture);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
 }
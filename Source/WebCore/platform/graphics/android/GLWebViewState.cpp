@@ -244,6 +244,7 @@ void GLWebViewState::setViewport(SkRect& viewport, float scale)
 
     m_goingDown = m_viewport.fTop - viewport.fTop <= 0;
     m_goingLeft = m_viewport.fLeft - viewport.fLeft >= 0;
+    m_prefetchPredictor.setViewport(viewport, scale, WTF::currentTime());
     m_viewport = viewport;
 
     XLOG("New VIEWPORT %.2f - %.2f %.2f - %.2f (w: %2.f h: %.2f scale: %.2f currentScale: %.2f futureScale: %.2f)",
@@ -448,18 +449,19 @@ bool GLWebViewState::drawGL(IntRect& rect, SkRect& viewport, IntRect* invalRect,
                                                        viewport.fBottom,
                                                        scale);
     TilesManager::instance()->incDrawGLCount();
+    TilesManager::instance()->shader()->startFrame();
 
 #ifdef DEBUG
     TilesManager::instance()->getTilesTracker()->clear();
 #endif
 
-    float viewWidth = (viewport.fRight - viewport.fLeft) * TILE_PREFETCH_RATIO;
-    float viewHeight = (viewport.fBottom - viewport.fTop) * TILE_PREFETCH_RATIO;
     bool useMinimalMemory = TilesManager::instance()->useMinimalMemory();
-    bool useHorzPrefetch = useMinimalMemory ? 0 : viewWidth < baseContentWidth();
-    bool useVertPrefetch = useMinimalMemory ? 0 : viewHeight < baseContentHeight();
-    m_expandedTileBoundsX = (useHorzPrefetch) ? TILE_PREFETCH_DISTANCE : 0;
-    m_expandedTileBoundsY = (useVertPrefetch) ? TILE_PREFETCH_DISTANCE : 0;
+    m_expandedTileBoundsX = TilePrefetchPredictor::prefetchDistance(viewport.fRight - viewport.fLeft,
+                                                                    baseContentWidth(), useMinimalMemory);
+    m_expandedTileBoundsY = TilePrefetchPredictor::prefetchDistance(viewport.fBottom - viewport.fTop,
+                                                                    baseContentHeight(), useMinimalMemory);
+    m_prefetchPredictor.updatePrefetchTiles(m_expandedTileBoundsX, m_expandedTileBoundsY,
+                                            WTF::currentTime());
 
     XLOG("drawGL, rect(%d, %d, %d, %d), viewport(%.2f, %.2f, %.2f, %.2f)",
          rect.x(), rect.y(), rect.width(), rect.height(),
@@ -489,6 +491,9 @@ bool GLWebViewState::drawGL(IntRect& rect, SkRect& viewport, IntRect* invalRect,
     // gather the textures we can use
     TilesManager::instance()->gatherLayerTextures();
 
+    // the uploads above changed GL bindings behind the shader's back
+    TilesManager::instance()->shader()->invalidateGLState();
+
     double currentTime = setupDrawing(rect, viewport, webViewRect, titleBarHeight, clip, scale);
 
 
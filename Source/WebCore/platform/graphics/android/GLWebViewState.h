@@ -35,6 +35,7 @@
 #include "SkCanvas.h"
 #include "SkRect.h"
 #include "SkRegion.h"
+#include "TilePrefetchPredictor.h"
 #include "TiledPage.h"
 #include "TreeManager.h"
 #include "ZoomManager.h"
@@ -46,14 +47,6 @@
 // #define MEASURES_PERF
 #define MAX_MEASURES_PERF 2000
 
-// Prefetch and render 1 tiles ahead of the scroll
-// TODO: We should either dynamically change the outer bound by detecting the
-// HW limit or save further in the GPU memory consumption.
-#define TILE_PREFETCH_DISTANCE 1
-
-// ratio of content to view required for prefetching to enable
-#define TILE_PREFETCH_RATIO 1.2
-
 namespace WebCore {
 
 class BaseLayerAndroid;
@@ -234,6 +227,14 @@ public:
 
     int expandedTileBoundsX() { return m_expandedTileBoundsX; }
     int expandedTileBoundsY() { return m_expandedTileBoundsY; }
+    // number of tiles to prefetch on each side of the viewport, skewed
+    // towards the scrolling direction
+    const SkIRect& prefetchTiles() const { return m_prefetchPredictor.prefetchTiles(); }
+    // predicted time in ms before the tile enters the viewport, capped
+    int tileVisibilityDelay(int x, int y)
+    {
+        return m_prefetchPredictor.tileVisibilityDelay(m_viewportTileBounds, x, y);
+    }
     void setHighEndGfx(bool highEnd) { m_highEndGfx = highEnd; }
 
     float scale() { return m_scale; }
@@ -284,6 +285,7 @@ private:
 
     int m_expandedTileBoundsX;
     int m_expandedTileBoundsY;
+    TilePrefetchPredictor m_prefetchPredictor;
     bool m_highEndGfx;
 
     float m_scale;
@@ -32,6 +32,7 @@
 #include "BitmapImage.h"
 #include "text/CString.h"
 #include "GraphicsContext3D.h"
+#include "GraphicsContext3DImageCache.h"
 #include "GraphicsContext3DInternal.h"
 #include "Image.h"
 #include "ImageData.h"
@@ -74,7 +75,8 @@ PlatformLayer* GraphicsContext3D::platformLayer() const
 }
 
 void GraphicsContext3D::makeContextCurrent() {
-    m_internal->makeContextCurrent();
+    // The EGL context is only ever current on the GL thread, which replays
+    // the commands recorded here.
 }
 
 bool GraphicsContext3D::isGLES2Compliant() const
@@ -94,19 +96,16 @@ Extensions3D* GraphicsContext3D::getExtensions()
 
 void GraphicsContext3D::paintRenderingResultsToCanvas(CanvasRenderingContext* context)
 {
-    makeContextCurrent();
     m_internal->paintRenderingResultsToCanvas(context);
 }
 
 PassRefPtr<ImageData> GraphicsContext3D::paintRenderingResultsToImageData()
 {
-    makeContextCurrent();
     return m_internal->paintRenderingResultsToImageData();
 }
 
 bool GraphicsContext3D::paintCompositedResultsToCanvas(CanvasRenderingContext* context)
 {
-    makeContextCurrent();
     return m_internal->paintCompositedResultsToCanvas(context);
 }
 
@@ -122,6 +121,10 @@ bool GraphicsContext3D::getImageData(Image* image,
     if (!image)
         return false;
 
+    GraphicsContext3DImageCache* cache = GraphicsContext3DImageCache::instance();
+    if (cache->lookup(image, format, type, premultiplyAlpha, ignoreGammaAndColorProfile, outputVector))
+        return true;
+
     AlphaOp neededAlphaOp = AlphaDoNothing;
     bool hasAlpha = (image->data() && image->isBitmapImage()) ?
         static_cast<BitmapImage*>(image)->frameHasAlphaAtIndex(0) : true;
@@ -213,114 +216,97 @@ bool GraphicsContext3D::getImageData(Image* image,
     if (tmpPixels)
         fastFree(tmpPixels);
 
+    if (res)
+        cache->store(image, format, type, premultiplyAlpha, ignoreGammaAndColorProfile, outputVector);
+
     return res;
 }
 
 unsigned GraphicsContext3D::createBuffer()
 {
     LOGWEBGL("glCreateBuffer()");
-    makeContextCurrent();
-    GLuint b = 0;
-    glGenBuffers(1, &b);
-    return b;
+    return m_internal->createName(GraphicsContext3DInternal::BufferName);
 }
 
 unsigned GraphicsContext3D::createFramebuffer()
 {
     LOGWEBGL("glCreateFramebuffer()");
-    makeContextCurrent();
-    GLuint fb = 0;
-    glGenFramebuffers(1, &fb);
-    return fb;
+    return m_internal->createName(GraphicsContext3DInternal::FramebufferName);
 }
 
 unsigned GraphicsContext3D::createProgram()
 {
     LOGWEBGL("glCreateProgram()");
-    makeContextCurrent();
-    return glCreateProgram();
+    GLuint program = 0;
+    m_internal->commands()->append(GLCommandCreateProgram, &program);
+    m_internal->commands()->finish();
+    return program;
 }
 
 unsigned GraphicsContext3D::createRenderbuffer()
 {
     LOGWEBGL("glCreateRenderbuffer()");
-    makeContextCurrent();
-    GLuint rb = 0;
-    glGenRenderbuffers(1, &rb);
-    return rb;
+    return m_internal->createName(GraphicsContext3DInternal::RenderbufferName);
 }
 
 unsigned GraphicsContext3D::createShader(GC3Denum type)
 {
     LOGWEBGL("glCreateShader()");
-    makeContextCurrent();
-    return glCreateShader((type == FRAGMENT_SHADER) ? GL_FRAGMENT_SHADER : GL_VERTEX_SHADER);
+    return m_internal->createShader((type == FRAGMENT_SHADER) ? GL_FRAGMENT_SHADER : GL_VERTEX_SHADER);
 }
 
 unsigned GraphicsContext3D::createTexture()
 {
     LOGWEBGL("glCreateTexture()");
-    makeContextCurrent();
-    GLuint t = 0;
-    glGenTextures(1, &t);
-    return t;
+    return m_internal->createName(GraphicsContext3DInternal::TextureName);
 }
 
 void GraphicsContext3D::deleteBuffer(unsigned buffer)
 {
     LOGWEBGL("glDeleteBuffers()");
-    makeContextCurrent();
-    glDeleteBuffers(1, &buffer);
+    m_internal->commands()->append(GLCommandDeleteBuffer, buffer);
 }
 
 void GraphicsContext3D::deleteFramebuffer(unsigned framebuffer)
 {
     LOGWEBGL("glDeleteFramebuffers()");
-    makeContextCurrent();
-    glDeleteFramebuffers(1, &framebuffer);
+    m_internal->commands()->append(GLCommandDeleteFramebuffer, framebuffer);
 }
 
 void GraphicsContext3D::deleteProgram(unsigned program)
 {
     LOGWEBGL("glDeleteProgram()");
-    makeContextCurrent();
-    glDeleteProgram(program);
+    m_internal->commands()->append(GLCommandDeleteProgram, program);
 }
 
 void GraphicsContext3D::deleteRenderbuffer(unsigned renderbuffer)
 {
     LOGWEBGL("glDeleteRenderbuffers()");
-    makeContextCurrent();
-    glDeleteRenderbuffers(1, &renderbuffer);
+    m_internal->commands()->append(GLCommandDeleteRenderbuffer, renderbuffer);
 }
 
 void GraphicsContext3D::deleteShader(unsigned shader)
 {
-    LOGWEBGL("glDeleteShader()");
-    makeContextCurrent();
-    glDeleteShader(shader);
+    m_internal->deleteShader(shader);
 }
 
 void GraphicsContext3D::deleteTexture(unsigned texture)
 {
     LOGWEBGL("glDeleteTextures()");
-    makeContextCurrent();
-    glDeleteTextures(1, &texture);
+    m_internal->commands()->append(GLCommandDeleteTexture, texture);
 }
 
 
 void GraphicsContext3D::activeTexture(GC3Denum texture)
 {
     LOGWEBGL("glActiveTexture(%ld)", texture);
-    makeContextCurrent();
-    glActiveTexture(texture);
+    m_internal->commands()->append(GLCommandActiveTexture, texture);
 }
 
 void GraphicsContext3D::attachShader(Platform3DObject program, Platform3DObject shader)
 {
     LOGWEBGL("glAttachShader(%d, %d)", program, shader);
-    makeContextCurrent();
-    glAttachShader(program, shader);
+    m_internal->commands()->append(GLCommandAttachShader, program, shader);
 }
 
 void GraphicsContext3D::bindAttribLocation(Platform3DObject program, GC3Duint index,
@@ -330,15 +316,14 @@ void GraphicsContext3D::bindAttribLocation(Platform3DObject program, GC3Duint in
     LOGWEBGL("glBindAttribLocation(%d, %d, %s)", program, index, cs.data());
     if (!program)
         return;
-    makeContextCurrent();
-    glBindAttribLocation(program, index, cs.data());
+    m_internal->commands()->append(GLCommandBindAttribLocation, program, index);
+    m_internal->commands()->appendString(cs);
 }
 
 void GraphicsContext3D::bindBuffer(GC3Denum target, Platform3DObject buffer)
 {
     LOGWEBGL("glBindBuffer(%d, %d)", target, buffer);
-    makeContextCurrent();
-    glBindBuffer(target, buffer);
+    m_internal->commands()->append(GLCommandBindBuffer, target, buffer);
 }
 
 void GraphicsContext3D::bindFramebuffer(GC3Denum target, Platform3DObject framebuffer)
@@ -350,111 +335,107 @@ void GraphicsContext3D::bindFramebuffer(GC3Denum target, Platform3DObject frameb
 void GraphicsContext3D::bindRenderbuffer(GC3Denum target, Platform3DObject renderbuffer)
 {
     LOGWEBGL("glBindRenderBuffer(%d, %d)", target, renderbuffer);
-    makeContextCurrent();
-    glBindRenderbuffer(target, renderbuffer);
+    m_internal->commands()->append(GLCommandBindRenderbuffer, target, renderbuffer);
 }
 
 void GraphicsContext3D::bindTexture(GC3Denum target, Platform3DObject texture)
 {
     LOGWEBGL("glBindTexture(%d, %d)", target, texture);
-    makeContextCurrent();
-    glBindTexture(target, texture);
+    m_internal->commands()->append(GLCommandBindTexture, target, texture);
 }
 
 void GraphicsContext3D::blendColor(GC3Dclampf red, GC3Dclampf green,
                                    GC3Dclampf blue, GC3Dclampf alpha)
 {
     LOGWEBGL("glBlendColor(%lf, %lf, %lf, %lf)", red, green, blue, alpha);
-    makeContextCurrent();
-    glBlendColor(CLAMP(red), CLAMP(green), CLAMP(blue), CLAMP(alpha));
+    m_internal->commands()->append(GLCommandBlendColor,
+                                   CLAMP(red), CLAMP(green), CLAMP(blue), CLAMP(alpha));
 }
 
 void GraphicsContext3D::blendEquation(GC3Denum mode)
 {
     LOGWEBGL("glBlendEquation(%d)", mode);
-    makeContextCurrent();
-    glBlendEquation(mode);
+    m_internal->commands()->append(GLCommandBlendEquation, mode);
 }
 
 void GraphicsContext3D::blendEquationSeparate(GC3Denum modeRGB, GC3Denum modeAlpha)
 {
     LOGWEBGL("glBlendEquationSeparate(%d, %d)", modeRGB, modeAlpha);
-    makeContextCurrent();
-    glBlendEquationSeparate(modeRGB, modeAlpha);
+    m_internal->commands()->append(GLCommandBlendEquationSeparate, modeRGB, modeAlpha);
 }
 
 void GraphicsContext3D::blendFunc(GC3Denum sfactor, GC3Denum dfactor)
 {
     LOGWEBGL("glBlendFunc(%d, %d)", sfactor, dfactor);
-    makeContextCurrent();
-    glBlendFunc(sfactor, dfactor);
+    m_internal->commands()->append(GLCommandBlendFunc, sfactor, dfactor);
 }
 
 void GraphicsContext3D::blendFuncSeparate(GC3Denum srcRGB, GC3Denum dstRGB,
                                           GC3Denum srcAlpha, GC3Denum dstAlpha)
 {
     LOGWEBGL("glBlendFuncSeparate(%lu, %lu, %lu, %lu)", srcRGB, dstRGB, srcAlpha, dstAlpha);
-    makeContextCurrent();
-    glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+    m_internal->commands()->append(GLCommandBlendFuncSeparate, srcRGB, dstRGB, srcAlpha, dstAlpha);
 }
 
 void GraphicsContext3D::bufferData(GC3Denum target, GC3Dsizeiptr size, GC3Denum usage)
 {
     LOGWEBGL("glBufferData(%lu, %d, %lu)", target, size, usage);
-    makeContextCurrent();
-    glBufferData(target, size, 0, usage);
+    m_internal->commands()->append(GLCommandBufferDataEmpty, target, size, usage);
 }
 
 void GraphicsContext3D::bufferData(GC3Denum target, GC3Dsizeiptr size,
                                    const void* data, GC3Denum usage)
 {
     LOGWEBGL("glBufferData(%lu, %d, %p, %lu)", target, size, data, usage);
-    makeContextCurrent();
-    glBufferData(target, size, data, usage);
+    if (!data) {
+        m_internal->commands()->append(GLCommandBufferDataEmpty, target, size, usage);
+        return;
+    }
+    m_internal->commands()->append(GLCommandBufferData, target, usage);
+    m_internal->commands()->appendData(data, size);
 }
 
 void GraphicsContext3D::bufferSubData(GC3Denum target, GC3Dintptr offset,
                                       GC3Dsizeiptr size, const void* data)
 {
     LOGWEBGL("glBufferSubData(%lu, %ld, %d, %p)", target, offset, size, data);
-    makeContextCurrent();
-    glBufferSubData(target, offset, size, data);
+    m_internal->commands()->append(GLCommandBufferSubData, target, offset);
+    m_internal->commands()->appendData(data, size);
 }
 
 GC3Denum GraphicsContext3D::checkFramebufferStatus(GC3Denum target)
 {
     LOGWEBGL("glCheckFramebufferStatus(%lu)", target);
-    makeContextCurrent();
-    return glCheckFramebufferStatus(target);
+    GLenum status = 0;
+    m_internal->commands()->append(GLCommandCheckFramebufferStatus, target, &status);
+    m_internal->commands()->finish();
+    return status;
 }
 
 void GraphicsContext3D::clear(GC3Dbitfield mask)
 {
     LOGWEBGL("glClear(%lu)", mask);
-    makeContextCurrent();
-    glClear(mask);
+    m_internal->commands()->append(GLCommandClear, mask);
 }
 
 void GraphicsContext3D::clearColor(GC3Dclampf red, GC3Dclampf green,
                                    GC3Dclampf blue, GC3Dclampf alpha)
 {
     LOGWEBGL("glClearColor(%.2lf, %.2lf, %.2lf, %.2lf)", red, green, blue, alpha);
-    makeContextCurrent();
-    glClearColor(CLAMP(red), CLAMP(green), CLAMP(blue), CLAMP(alpha));
+    m_internal->commands()->append(GLCommandClearColor,
+                                   CLAMP(red), CLAMP(green), CLAMP(blue), CLAMP(alpha));
 }
 
 void GraphicsContext3D::clearDepth(GC3Dclampf depth)
 {
     LOGWEBGL("glClearDepthf(%.2lf)", depth);
-    makeContextCurrent();
-    glClearDepthf(CLAMP(depth));
+    m_internal->commands()->append(GLCommandClearDepth, CLAMP(depth));
 }
 
 void GraphicsContext3D::clearStencil(GC3Dint s)
 {
     LOGWEBGL("glClearStencil(%ld)", s);
-    makeContextCurrent();
-    glClearStencil(s);
+    m_internal->commands()->append(GLCommandClearStencil, s);
 }
 
 void GraphicsContext3D::colorMask(GC3Dboolean red, GC3Dboolean green,
@@ -462,14 +443,12 @@ void GraphicsContext3D::colorMask(GC3Dboolean red, GC3Dboolean green,
 {
     LOGWEBGL("glColorMask(%s, %s, %s, %s)", red ? "true" : "false", green ? "true" : "false",
              blue ? "true" : "false", alpha ? "true" : "false");
-    makeContextCurrent();
-    glColorMask(red, green, blue, alpha);
+    m_internal->commands()->append(GLCommandColorMask, red, green, blue, alpha);
 }
 
 void GraphicsContext3D::compileShader(Platform3DObject shader)
 {
     LOGWEBGL("compileShader(%lu)", shader);
-    makeContextCurrent();
     m_internal->compileShader(shader);
 }
 
@@ -479,8 +458,8 @@ void GraphicsContext3D::copyTexImage2D(GC3Denum target, GC3Dint level, GC3Denum
 {
     LOGWEBGL("glCopyTexImage2D(%lu, %ld, %lu, %ld, %ld, %lu, %lu, %ld",
              target, level, internalformat, x, y, width, height, border);
-    makeContextCurrent();
-    glCopyTexImage2D(target, level, internalformat, x, y, width, height, border);
+    m_internal->commands()->append(GLCommandCopyTexImage2D, target, level, internalformat, x, y,
+                                   width, height, border);
 }
 
 void GraphicsContext3D::copyTexSubImage2D(GC3Denum target, GC3Dint level, GC3Dint xoffset,
@@ -489,100 +468,89 @@ void GraphicsContext3D::copyTexSubImage2D(GC3Denum target, GC3Dint level, GC3Din
 {
     LOGWEBGL("glCopyTexSubImage2D(%lu, %ld, %ld, %ld, %ld, %ld, %lu, %lu)",
              target, level, xoffset, yoffset, x, y, width, height);
-    makeContextCurrent();
-    glCopyTexSubImage2D(target, level, xoffset, yoffset, x, y, width, height);
+    m_internal->commands()->append(GLCommandCopyTexSubImage2D, target, level, xoffset, yoffset,
+                                   x, y, width, height);
 }
 
 void GraphicsContext3D::cullFace(GC3Denum mode)
 {
     LOGWEBGL("glCullFace(%lu)", mode);
-    makeContextCurrent();
-    glCullFace(mode);
+    m_internal->commands()->append(GLCommandCullFace, mode);
 }
 
 void GraphicsContext3D::depthFunc(GC3Denum func)
 {
     LOGWEBGL("glDepthFunc(%lu)", func);
-    makeContextCurrent();
-    glDepthFunc(func);
+    m_internal->commands()->append(GLCommandDepthFunc, func);
 }
 
 void GraphicsContext3D::depthMask(GC3Dboolean flag)
 {
     LOGWEBGL("glDepthMask(%s)", flag ? "true" : "false");
-    makeContextCurrent();
-    glDepthMask(flag);
+    m_internal->commands()->append(GLCommandDepthMask, flag);
 }
 
 void GraphicsContext3D::depthRange(GC3Dclampf zNear, GC3Dclampf zFar)
 {
     LOGWEBGL("glDepthRangef(%.2lf, %.2lf)", zNear, zFar);
-    makeContextCurrent();
-    glDepthRangef(CLAMP(zNear), CLAMP(zFar));
+    m_internal->commands()->append(GLCommandDepthRange, CLAMP(zNear), CLAMP(zFar));
 }
 
 void GraphicsContext3D::detachShader(Platform3DObject program, Platform3DObject shader)
 {
     LOGWEBGL("glDetachShader(%lu, %lu)", program, shader);
-    makeContextCurrent();
-    glDetachShader(program, shader);
+    m_internal->commands()->append(GLCommandDetachShader, program, shader);
 }
 
 void GraphicsContext3D::disable(GC3Denum cap)
 {
     LOGWEBGL("glDisable(%lu)", cap);
-    makeContextCurrent();
-    glDisable(cap);
+    m_internal->commands()->append(GLCommandDisable, cap);
 }
 
 void GraphicsContext3D::disableVertexAttribArray(GC3Duint index)
 {
     LOGWEBGL("glDisableVertexAttribArray(%lu)", index);
-    makeContextCurrent();
-    glDisableVertexAttribArray(index);
+    m_internal->commands()->append(GLCommandDisableVertexAttribArray, index);
 }
 
 void GraphicsContext3D::drawArrays(GC3Denum mode, GC3Dint first, GC3Dsizei count)
 {
     LOGWEBGL("glDrawArrays(%lu, %ld, %ld)", mode, first, count);
-    makeContextCurrent();
-    glDrawArrays(mode, first, count);
+    m_internal->commands()->append(GLCommandDrawArrays, mode, first, count);
 }
 
 void GraphicsContext3D::drawElements(GC3Denum mode, GC3Dsizei count,
                                      GC3Denum type, GC3Dintptr offset)
 {
     LOGWEBGL("glDrawElements(%lu, %lu, %lu, %ld)", mode, count, type, offset);
-    makeContextCurrent();
-    glDrawElements(mode, count, type, reinterpret_cast<void*>(static_cast<intptr_t>(offset)));
+    m_internal->commands()->append(GLCommandDrawElements, mode, count, type, offset);
 }
 
 void GraphicsContext3D::enable(GC3Denum cap)
 {
     LOGWEBGL("glEnable(0x%04x)", cap);
-    makeContextCurrent();
-    glEnable(cap);
+    m_internal->commands()->append(GLCommandEnable, cap);
 }
 
 void GraphicsContext3D::enableVertexAttribArray(GC3Duint index)
 {
     LOGWEBGL("glEnableVertexAttribArray(%lu)", index);
-    makeContextCurrent();
-    glEnableVertexAttribArray(index);
+    m_internal->commands()->append(GLCommandEnableVertexAttribArray, index);
 }
 
 void GraphicsContext3D::finish()
 {
     LOGWEBGL("glFinish()");
-    makeContextCurrent();
-    glFinish();
+    m_internal->commands()->append(GLCommandFinish);
+    m_internal->commands()->finish();
 }
 
 void GraphicsContext3D::flush()
 {
     LOGWEBGL("glFlush()");
-    makeContextCurrent();
-    glFlush();
+    m_internal->commands()->append(GLCommandFlush);
+    m_internal->commands()->flush();
 }
 
 void GraphicsContext3D::framebufferRenderbuffer(GC3Denum target, GC3Denum attachment,
@@ -591,8 +559,8 @@ void GraphicsContext3D::framebufferRenderbuffer(GC3Denum target, GC3Denum attach
 {
     LOGWEBGL("glFramebufferRenderbuffer(%lu, %lu, %lu, %lu)", target, attachment,
              renderbuffertarget, renderbuffer);
-    makeContextCurrent();
-    glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+    m_internal->commands()->append(GLCommandFramebufferRenderbuffer, target, attachment,
+                                   renderbuffertarget, renderbuffer);
 }
 
 void GraphicsContext3D::framebufferTexture2D(GC3Denum target, GC3Denum attachment,
@@ -601,22 +569,20 @@ void GraphicsContext3D::framebufferTexture2D(GC3Denum target, GC3Denum attachmen
 {
     LOGWEBGL("glFramebufferTexture2D(%lu, %lu, %lu, %lu, %ld)",
              target, attachment, textarget, texture, level);
-    makeContextCurrent();
-    glFramebufferTexture2D(target, attachment, textarget, texture, level);
+    m_internal->commands()->append(GLCommandFramebufferTexture2D, target, attachment, textarget,
+                                   texture, level);
 }
 
 void GraphicsContext3D::frontFace(GC3Denum mode)
 {
     LOGWEBGL("glFrontFace(%lu)", mode);
-    makeContextCurrent();
-    glFrontFace(mode);
+    m_internal->commands()->append(GLCommandFrontFace, mode);
 }
 
 void GraphicsContext3D::generateMipmap(GC3Denum target)
 {
     LOGWEBGL("glGenerateMipmap(%lu)", target);
-    makeContextCurrent();
-    glGenerateMipmap(target);
+    m_internal->commands()->append(GLCommandGenerateMipmap, target);
 }
 
 bool GraphicsContext3D::getActiveAttrib(Platform3DObject program, GC3Duint index, ActiveInfo& info)
@@ -626,14 +592,17 @@ bool GraphicsContext3D::getActiveAttrib(Platform3DObject program, GC3Duint index
         synthesizeGLError(INVALID_VALUE);
         return false;
     }
-    makeContextCurrent();
     GLint maxAttributeSize = 0;
-    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxAttributeSize);
+    m_internal->commands()->append(GLCommandGetProgramiv, program,
+                                   GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxAttributeSize);
+    m_internal->commands()->finish();
     GLchar name[maxAttributeSize];
     GLsizei nameLength = 0;
     GLint size = 0;
     GLenum type = 0;
-    glGetActiveAttrib(program, index, maxAttributeSize, &nameLength, &size, &type, name);
+    m_internal->commands()->append(GLCommandGetActiveAttrib, program, index, maxAttributeSize,
+                                   &nameLength, &size, &type, name);
+    m_internal->commands()->finish();
     if (!nameLength)
         return false;
     info.name = String(name, nameLength);
@@ -649,14 +618,17 @@ bool GraphicsContext3D::getActiveUniform(Platform3DObject program, GC3Duint inde
         synthesizeGLError(INVALID_VALUE);
         return false;
     }
-    makeContextCurrent();
     GLint maxUniformSize = 0;
-    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxUniformSize);
+    m_internal->commands()->append(GLCommandGetProgramiv, program,
+                                   GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxUniformSize);
+    m_internal->commands()->finish();
     GLchar name[maxUniformSize];
     GLsizei nameLength = 0;
     GLint size = 0;
     GLenum type = 0;
-    glGetActiveUniform(program, index, maxUniformSize, &nameLength, &size, &type, name);
+    m_internal->commands()->append(GLCommandGetActiveUniform, program, index, maxUniformSize,
+                                   &nameLength, &size, &type, name);
+    m_internal->commands()->finish();
     if (!nameLength)
         return false;
     info.name = String(name, nameLength);
@@ -673,8 +645,8 @@ void GraphicsContext3D::getAttachedShaders(Platform3DObject program, GC3Dsizei m
         synthesizeGLError(INVALID_VALUE);
         return;
     }
-    makeContextCurrent();
-    glGetAttachedShaders(program, maxCount, count, shaders);
+    m_internal->commands()->append(GLCommandGetAttachedShaders, program, maxCount, count, shaders);
+    m_internal->commands()->finish();
 }
 
 GC3Dint GraphicsContext3D::getAttribLocation(Platform3DObject program, const String& name)
@@ -684,23 +656,24 @@ GC3Dint GraphicsContext3D::getAttribLocation(Platform3DObject program, const Str
     if (!program) {
         return -1;
     }
-    makeContextCurrent();
-
-    return glGetAttribLocation(program, cs.data());
+    GLint location = -1;
+    m_internal->commands()->append(GLCommandGetAttribLocation, program, cs.data(), &location);
+    m_internal->commands()->finish();
+    return location;
 }
 
 void GraphicsContext3D::getBooleanv(GC3Denum pname, GC3Dboolean* value)
 {
     LOGWEBGL("glGetBooleanv(%lu, %p)", pname, value);
-    makeContextCurrent();
-    glGetBooleanv(pname, value);
+    m_internal->commands()->append(GLCommandGetBooleanv, pname, value);
+    m_internal->commands()->finish();
 }
 
 void GraphicsContext3D::getBufferParameteriv(GC3Denum target, GC3Denum pname, GC3Dint* value)
 {
     LOGWEBGL("glGetBufferParameteriv(%lu, %lu, %p)", target, pname, value);
-    makeContextCurrent();
-    glGetBufferParameteriv(target, pname, value);
+    m_internal->commands()->append(GLCommandGetBufferParameteriv, target, pname, value);
+    m_internal->commands()->finish();
 }
 
 GraphicsContext3D::Attributes GraphicsContext3D::getContextAttributes()
@@ -718,8 +691,8 @@ GC3Denum GraphicsContext3D::getError()
 void GraphicsContext3D::getFloatv(GC3Denum pname, GC3Dfloat* value)
 {
     LOGWEBGL("glGetFloatv(%lu, %p)", pname, value);
-    makeContextCurrent();
-    glGetFloatv(pname, value);
+    m_internal->commands()->append(GLCommandGetFloatv, pname, value);
+    m_internal->commands()->finish();
 }
 
 void GraphicsContext3D::getFramebufferAttachmentParameteriv(GC3Denum target, GC3Denum attachment,
@@ -727,38 +700,40 @@ void GraphicsContext3D::getFramebufferAttachmentParameteriv(GC3Denum target, GC3
 {
     LOGWEBGL("glGetFramebufferAttachmentParameteriv(%lu, %lu, %lu, %p)",
              target, attachment, pname, value);
-    makeContextCurrent();
     if (attachment == DEPTH_STENCIL_ATTACHMENT)
         attachment = DEPTH_ATTACHMENT;
-    glGetFramebufferAttachmentParameteriv(target, attachment, pname, value);
+    m_internal->commands()->append(GLCommandGetFramebufferAttachmentParameteriv,
+                                   target, attachment, pname, value);
+    m_internal->commands()->finish();
 }
 
 void GraphicsContext3D::getIntegerv(GC3Denum pname, GC3Dint* value)
 {
     LOGWEBGL("glGetIntegerv(%lu, %p)", pname, value);
-    makeContextCurrent();
-    glGetIntegerv(pname, value);
+    m_internal->commands()->append(GLCommandGetIntegerv, pname, value);
+    m_internal->commands()->finish();
 }
 
 void GraphicsContext3D::getProgramiv(Platform3DObject program, GC3Denum pname, GC3Dint* value)
 {
     LOGWEBGL("glGetProgramiv(%lu, %lu, %p)", program, pname, value);
-    makeContextCurrent();
-    glGetProgramiv(program, pname, value);
+    m_internal->commands()->append(GLCommandGetProgramiv, program, pname, value);
+    m_internal->commands()->finish();
 }
 
 String GraphicsContext3D::getProgramInfoLog(Platform3DObject program)
 {
     LOGWEBGL("glGetProgramInfoLog(%lu)", program);
-    makeContextCurrent();
-    GLint length;
-    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+    GLint length = 0;
+    m_internal->commands()->append(GLCommandGetProgramiv, program, GL_INFO_LOG_LENGTH, &length);
+    m_internal->commands()->finish();
     if (!length)
         return "";
 
-    GLsizei size;
+    GLsizei size = 0;
     GLchar* info = (GLchar*)fastMalloc(length);
-    glGetProgramInfoLog(program, length, &size, info);
+    m_internal->commands()->append(GLCommandGetProgramInfoLog, program, length, &size, info);
+    m_internal->commands()->finish();
     String s(info);
     fastFree(info);
 
@@ -768,101 +743,103 @@ String GraphicsContext3D::getProgramInfoLog(Platform3DObject program)
 void GraphicsContext3D::getRenderbufferParameteriv(GC3Denum target, GC3Denum pname, GC3Dint* value)
 {
     LOGWEBGL("glGetRenderbufferParameteriv(%lu, %lu, %p)", target, pname, value);
-    makeContextCurrent();
-    glGetRenderbufferParameteriv(target, pname, value);
+    m_internal->commands()->append(GLCommandGetRenderbufferParameteriv, target, pname, value);
+    m_internal->commands()->finish();
 }
 
 void GraphicsContext3D::getShaderiv(Platform3DObject shader, GC3Denum pname, GC3Dint* value)
 {
     LOGWEBGL("glGetShaderiv(%lu, %lu, %p)", shader, pname, value);
-    makeContextCurrent();
-    glGetShaderiv(shader, pname, value);
+    m_internal->commands()->append(GLCommandGetShaderiv, shader, pname, value);
+    m_internal->commands()->finish();
 }
 
 String GraphicsContext3D::getShaderInfoLog(Platform3DObject shader)
 {
     LOGWEBGL("getShaderInfoLog(%lu)", shader);
-    makeContextCurrent();
     return m_internal->getShaderInfoLog(shader);
 }
 
 String GraphicsContext3D::getShaderSource(Platform3DObject shader)
 {
     LOGWEBGL("getShaderSource(%lu)", shader);
-    makeContextCurrent();
     return m_internal->getShaderSource(shader);
 }
 
 String GraphicsContext3D::getString(GC3Denum name)
 {
     LOGWEBGL("glGetString(%lu)", name);
-    makeContextCurrent();
-    return String(reinterpret_cast<const char*>(glGetString(name)));
+    const GLubyte* string = 0;
+    m_internal->commands()->append(GLCommandGetString, name, &string);
+    m_internal->commands()->finish();
+    return String(reinterpret_cast<const char*>(string));
 }
 
 void GraphicsContext3D::getTexParameterfv(GC3Denum target, GC3Denum pname, GC3Dfloat* value)
 {
     LOGWEBGL("glGetTexParameterfv(%lu, %lu, %p)", target, pname, value);
-    makeContextCurrent();
-    glGetTexParameterfv(target, pname, value);
+    m_internal->commands()->append(GLCommandGetTexParameterfv, target, pname, value);
+    m_internal->commands()->finish();
 }
 
 void GraphicsContext3D::getTexParameteriv(GC3Denum target, GC3Denum pname, GC3Dint* value)
 {
     LOGWEBGL("glGetTexParameteriv(%lu, %lu, %p)", target, pname, value);
-    makeContextCurrent();
-    glGetTexParameteriv(target, pname, value);
+    m_internal->commands()->append(GLCommandGetTexParameteriv, target, pname, value);
+    m_internal->commands()->finish();
 }
 
 void GraphicsContext3D::getUniformfv(Platform3DObject program, GC3Dint location, GC3Dfloat* value)
 {
     LOGWEBGL("glGetUniformfv(%lu, %ld, %p)", program, location, value);
-    makeContextCurrent();
-    glGetUniformfv(program, location, value);
+    m_internal->commands()->append(GLCommandGetUniformfv, program, location, value);
+    m_internal->commands()->finish();
 }
 
 void GraphicsContext3D::getUniformiv(Platform3DObject program, GC3Dint location, GC3Dint* value)
 {
     LOGWEBGL("glGetUniformiv(%lu, %ld, %p)", program, location, value);
-    makeContextCurrent();
-    glGetUniformiv(program, location, value);
+    m_internal->commands()->append(GLCommandGetUniformiv, program, location, value);
+    m_internal->commands()->finish();
 }
 
 GC3Dint GraphicsContext3D::getUniformLocation(Platform3DObject program, const String& name)
 {
     CString cs = name.utf8();
     LOGWEBGL("glGetUniformLocation(%lu, %s)", program, cs.data());
-    makeContextCurrent();
-    return glGetUniformLocation(program, cs.data());
+    GLint location = -1;
+    m_internal->commands()->append(GLCommandGetUniformLocation, program, cs.data(), &location);
+    m_internal->commands()->finish();
+    return location;
 }
 
 void GraphicsContext3D::getVertexAttribfv(GC3Duint index, GC3Denum pname, GC3Dfloat* value)
 {
     LOGWEBGL("glGetVertexAttribfv(%lu, %lu, %p)", index, pname, value);
-    makeContextCurrent();
-    glGetVertexAttribfv(index, pname, value);
+    m_internal->commands()->append(GLCommandGetVertexAttribfv, index, pname, value);
+    m_internal->commands()->finish();
 }
 
 void GraphicsContext3D::getVertexAttribiv(GC3Duint index, GC3Denum pname, GC3Dint* value)
 {
     LOGWEBGL("glGetVertexAttribiv(%lu, %lu, %p)", index, pname, value);
-    makeContextCurrent();
-    glGetVertexAttribiv(index, pname, value);
+    m_internal->commands()->append(GLCommandGetVertexAttribiv, index, pname, value);
+    m_internal->commands()->finish();
 }
 
 GC3Dsizeiptr GraphicsContext3D::getVertexAttribOffset(GC3Duint index, GC3Denum pname)
 {
     LOGWEBGL("glGetVertexAttribOffset(%lu, %lu)", index, pname);
     GLvoid* pointer = 0;
-    glGetVertexAttribPointerv(index, pname, &pointer);
+    m_internal->commands()->append(GLCommandGetVertexAttribPointerv, index, pname, &pointer);
+    m_internal->commands()->finish();
     return static_cast<GC3Dsizeiptr>(reinterpret_cast<intptr_t>(pointer));
 }
 
 void GraphicsContext3D::hint(GC3Denum target, GC3Denum mode)
 {
     LOGWEBGL("glHint(%lu, %lu)", target, mode);
-    makeContextCurrent();
-    glHint(target, mode);
+    m_internal->commands()->append(GLCommandHint, target, mode);
 }
 
 GC3Dboolean GraphicsContext3D::isBuffer(Platform3DObject buffer)
@@ -870,15 +847,19 @@ GC3Dboolean GraphicsContext3D::isBuffer(Platform3DObject buffer)
     LOGWEBGL("glIsBuffer(%lu)", buffer);
     if (!buffer)
         return GL_FALSE;
-    makeContextCurrent();
-    return glIsBuffer(buffer);
+    GLboolean result = GL_FALSE;
+    m_internal->commands()->append(GLCommandIsBuffer, buffer, &result);
+    m_internal->commands()->finish();
+    return result;
 }
 
 GC3Dboolean GraphicsContext3D::isEnabled(GC3Denum cap)
 {
     LOGWEBGL("glIsEnabled(%lu)", cap);
-    makeContextCurrent();
-    return glIsEnabled(cap);
+    GLboolean result = GL_FALSE;
+    m_internal->commands()->append(GLCommandIsEnabled, cap, &result);
+    m_internal->commands()->finish();
+    return result;
 }
 
 GC3Dboolean GraphicsContext3D::isFramebuffer(Platform3DObject framebuffer)
@@ -886,8 +867,10 @@ GC3Dboolean GraphicsContext3D::isFramebuffer(Platform3DObject framebuffer)
     LOGWEBGL("glIsFramebuffer(%lu)", framebuffer);
     if (!framebuffer)
         return GL_FALSE;
-    makeContextCurrent();
-    return glIsFramebuffer(framebuffer);
+    GLboolean result = GL_FALSE;
+    m_internal->commands()->append(GLCommandIsFramebuffer, framebuffer, &result);
+    m_internal->commands()->finish();
+    return result;
 }
 
 GC3Dboolean GraphicsContext3D::isProgram(Platform3DObject program)
@@ -895,8 +878,10 @@ GC3Dboolean GraphicsContext3D::isProgram(Platform3DObject program)
     LOGWEBGL("glIsProgram(%lu)", program);
     if (!program)
         return GL_FALSE;
-    makeContextCurrent();
-    return glIsProgram(program);
+    GLboolean result = GL_FALSE;
+    m_internal->commands()->append(GLCommandIsProgram, program, &result);
+    m_internal->commands()->finish();
+    return result;
 }
 
 GC3Dboolean GraphicsContext3D::isRenderbuffer(Platform3DObject renderbuffer)
@@ -904,8 +889,10 @@ GC3Dboolean GraphicsContext3D::isRenderbuffer(Platform3DObject renderbuffer)
     LOGWEBGL("glIsRenderbuffer(%lu)", renderbuffer);
     if (!renderbuffer)
         return GL_FALSE;
-    makeContextCurrent();
-    return glIsRenderbuffer(renderbuffer);
+    GLboolean result = GL_FALSE;
+    m_internal->commands()->append(GLCommandIsRenderbuffer, renderbuffer, &result);
+    m_internal->commands()->finish();
+    return result;
 }
 
 GC3Dboolean GraphicsContext3D::isShader(Platform3DObject shader)
@@ -913,8 +900,10 @@ GC3Dboolean GraphicsContext3D::isShader(Platform3DObject shader)
     LOGWEBGL("glIsShader(%lu)", shader);
     if (!shader)
         return GL_FALSE;
-    makeContextCurrent();
-    return glIsShader(shader);
+    GLboolean result = GL_FALSE;
+    m_internal->commands()->append(GLCommandIsShader, shader, &result);
+    m_internal->commands()->finish();
+    return result;
 }
 
 GC3Dboolean GraphicsContext3D::isTexture(Platform3DObject texture)
@@ -922,36 +911,36 @@ GC3Dboolean GraphicsContext3D::isTexture(Platform3DObject texture)
     LOGWEBGL("glIsTexture(%lu)", texture);
     if (!texture)
         return GL_FALSE;
-    makeContextCurrent();
-    return glIsTexture(texture);
+    GLboolean result = GL_FALSE;
+    m_internal->commands()->append(GLCommandIsTexture, texture, &result);
+    m_internal->commands()->finish();
+    return result;
 }
 
 void GraphicsContext3D::lineWidth(GC3Dfloat width)
 {
     LOGWEBGL("glLineWidth(%.2lf)", width);
-    makeContextCurrent();
-    glLineWidth((GLfloat)width);
+    m_internal->commands()->append(GLCommandLineWidth, (GLfloat)width);
 }
 
 void GraphicsContext3D::linkProgram(Platform3DObject program)
 {
     LOGWEBGL("glLinkProgram(%lu)", program);
-    makeContextCurrent();
-    glLinkProgram(program);
+    m_internal->commands()->append(GLCommandLinkProgram, program);
 }
 
 void GraphicsContext3D::pixelStorei(GC3Denum pname, GC3Dint param)
 {
     LOGWEBGL("glPixelStorei(%lu, %ld)", pname, param);
-    makeContextCurrent();
-    glPixelStorei(pname, param);
+    if (pname == UNPACK_ALIGNMENT)
+        m_internal->setUnpackAlignment(param);
+    m_internal->commands()->append(GLCommandPixelStorei, pname, param);
 }
 
 void GraphicsContext3D::polygonOffset(GC3Dfloat factor, GC3Dfloat units)
 {
     LOGWEBGL("glPolygonOffset(%.2lf, %.2lf)", factor, units);
-    makeContextCurrent();
-    glPolygonOffset((GLfloat)factor, (GLfloat)units);
+    m_internal->commands()->append(GLCommandPolygonOffset, (GLfloat)factor, (GLfloat)units);
 }
 
 void GraphicsContext3D::readPixels(GC3Dint x, GC3Dint y, GC3Dsizei width, GC3Dsizei height,
@@ -959,15 +948,14 @@ void GraphicsContext3D::readPixels(GC3Dint x, GC3Dint y, GC3Dsizei width, GC3Dsi
 {
     LOGWEBGL("glReadPixels(%ld, %ld, %lu, %lu, %lu, %lu, %p)",
              x, y, width, height, format, type, data);
-    makeContextCurrent();
-    glReadPixels(x, y, width, height, format, type, data);
+    m_internal->commands()->append(GLCommandReadPixels, x, y, width, height, format, type, data);
+    m_internal->commands()->finish();
 }
 
 void GraphicsContext3D::releaseShaderCompiler()
 {
     LOGWEBGL("glReleaseShaderCompiler()");
-    makeContextCurrent();
-    glReleaseShaderCompiler();
+    m_internal->commands()->append(GLCommandReleaseShaderCompiler);
 }
 
 void GraphicsContext3D::renderbufferStorage(GC3Denum target, GC3Denum internalformat,
@@ -975,72 +963,63 @@ void GraphicsContext3D::renderbufferStorage(GC3Denum target, GC3Denum internalfo
 {
     LOGWEBGL("glRenderbufferStorage(%lu, %lu, %lu, %lu)",
              target, internalformat, width, height);
-    makeContextCurrent();
-    glRenderbufferStorage(target, internalformat, width, height);
+    m_internal->commands()->append(GLCommandRenderbufferStorage, target, internalformat,
+                                   width, height);
 }
 
 void GraphicsContext3D::sampleCoverage(GC3Dclampf value, GC3Dboolean invert)
 {
     LOGWEBGL("glSampleCoverage(%.2lf, %s)", value, invert ? "true" : "false");
-    makeContextCurrent();
-    glSampleCoverage(CLAMP(value), invert);
+    m_internal->commands()->append(GLCommandSampleCoverage, CLAMP(value), invert);
 }
 
 void GraphicsContext3D::scissor(GC3Dint x, GC3Dint y, GC3Dsizei width, GC3Dsizei height)
 {
     LOGWEBGL("glScissor(%ld, %ld, %lu, %lu)", x, y, width, height);
-    makeContextCurrent();
-    glScissor(x, y, width, height);
+    m_internal->commands()->append(GLCommandScissor, x, y, width, height);
 }
 
 void GraphicsContext3D::shaderSource(Platform3DObject shader, const String& source)
 {
     LOGWEBGL("shaderSource(%lu, %s)", shader, source.utf8().data());
-    makeContextCurrent();
     m_internal->shaderSource(shader, source);
 }
 
 void GraphicsContext3D::stencilFunc(GC3Denum func, GC3Dint ref, GC3Duint mask)
 {
     LOGWEBGL("glStencilFunc(%lu, %ld, %lu)", func, ref, mask);
-    makeContextCurrent();
-    glStencilFunc(func, ref, mask);
+    m_internal->commands()->append(GLCommandStencilFunc, func, ref, mask);
 }
 
 void GraphicsContext3D::stencilFuncSeparate(GC3Denum face, GC3Denum func, GC3Dint ref, GC3Duint mask)
 {
     LOGWEBGL("glStencilFuncSeparate(%lu, %lu, %ld, %lu)", face, func, ref, mask);
-    makeContextCurrent();
-    glStencilFuncSeparate(face, func, ref, mask);
+    m_internal->commands()->append(GLCommandStencilFuncSeparate, face, func, ref, mask);
 }
 
 void GraphicsContext3D::stencilMask(GC3Duint mask)
 {
     LOGWEBGL("glStencilMask(%lu)", mask);
-    makeContextCurrent();
-    glStencilMask(mask);
+    m_internal->commands()->append(GLCommandStencilMask, mask);
 }
 
 void GraphicsContext3D::stencilMaskSeparate(GC3Denum face, GC3Duint mask)
 {
     LOGWEBGL("glStencilMaskSeparate(%lu, %lu)", face, mask);
-    makeContextCurrent();
-    glStencilMaskSeparate(face, mask);
+    m_internal->commands()->append(GLCommandStencilMaskSeparate, face, mask);
 }
 
 void GraphicsContext3D::stencilOp(GC3Denum fail, GC3Denum zfail, GC3Denum zpass)
 {
     LOGWEBGL("glStencilOp(%lu, %lu, %lu)", fail, zfail, zpass);
-    makeContextCurrent();
-    glStencilOp(fail, zfail, zpass);
+    m_internal->commands()->append(GLCommandStencilOp, fail, zfail, zpass);
 }
 
 void GraphicsContext3D::stencilOpSeparate(GC3Denum face, GC3Denum fail,
                                           GC3Denum zfail, GC3Denum zpass)
 {
     LOGWEBGL("glStencilOpSeparate(%lu, %lu, %lu, %lu)", face, fail, zfail, zpass);
-    makeContextCurrent();
-    glStencilOpSeparate(face, fail, zfail, zpass);
+    m_internal->commands()->append(GLCommandStencilOpSeparate, face, fail, zfail, zpass);
 }
 
 bool GraphicsContext3D::texImage2D(GC3Denum target, GC3Dint level, GC3Denum internalformat,
@@ -1053,23 +1032,26 @@ bool GraphicsContext3D::texImage2D(GC3Denum target, GC3Dint level, GC3Denum inte
         synthesizeGLError(INVALID_VALUE);
         return false;
     }
-    makeContextCurrent();
-    glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+    unsigned int size = 0;
+    if (pixels && computeImageSizeInBytes(format, type, width, height,
+                                          m_internal->unpackAlignment(), &size, 0) != NO_ERROR)
+        size = 0;
+    m_internal->commands()->append(GLCommandTexImage2D, target, level, internalformat,
+                                   width, height, border, format, type);
+    m_internal->commands()->appendData(size ? pixels : 0, size);
     return true;
 }
 
 void GraphicsContext3D::texParameterf(GC3Denum target, GC3Denum pname, GC3Dfloat param)
 {
     LOGWEBGL("glTexParameterf(%u, %u, %f)", target, pname, param);
-    makeContextCurrent();
-    glTexParameterf(target, pname, param);
+    m_internal->commands()->append(GLCommandTexParameterf, target, pname, param);
 }
 
 void GraphicsContext3D::texParameteri(GC3Denum target, GC3Denum pname, GC3Dint param)
 {
     LOGWEBGL("glTexParameteri(%u, %u, %d)", target, pname, param);
-    makeContextCurrent();
-    glTexParameteri(target, pname, param);
+    m_internal->commands()->append(GLCommandTexParameteri, target, pname, param);
 }
 
 void GraphicsContext3D::texSubImage2D(GC3Denum target, GC3Dint level, GC3Dint xoffset,
@@ -1082,121 +1064,118 @@ void GraphicsContext3D::texSubImage2D(GC3Denum target, GC3Dint level, GC3Dint xo
         synthesizeGLError(INVALID_VALUE);
         return;
     }
-    makeContextCurrent();
-    glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+    unsigned int size = 0;
+    if (computeImageSizeInBytes(format, type, width, height,
+                                m_internal->unpackAlignment(), &size, 0) != NO_ERROR)
+        size = 0;
+    m_internal->commands()->append(GLCommandTexSubImage2D, target, level, xoffset, yoffset,
+                                   width, height, format, type);
+    m_internal->commands()->appendData(size ? pixels : 0, size);
 }
 
 void GraphicsContext3D::uniform1f(GC3Dint location, GC3Dfloat x)
 {
     LOGWEBGL("glUniform1f(%ld, %f)", location, x);
-    makeContextCurrent();
-    glUniform1f(location, x);
+    m_internal->commands()->append(GLCommandUniform1f, location, x);
 }
 
 void GraphicsContext3D::uniform1fv(GC3Dint location, GC3Dfloat* v, GC3Dsizei size)
 {
     LOGWEBGL("glUniform1fv(%ld, %p, %d)", location, v, size);
-    makeContextCurrent();
-    glUniform1fv(location, size, v);
+    m_internal->commands()->append(GLCommandUniform1fv, location, size);
+    m_internal->commands()->appendData(v, size * 1 * sizeof(GC3Dfloat));
 }
 
 void GraphicsContext3D::uniform1i(GC3Dint location, GC3Dint x)
 {
     LOGWEBGL("glUniform1i(%ld, %d)", location, x);
-    makeContextCurrent();
-    glUniform1i(location, x);
+    m_internal->commands()->append(GLCommandUniform1i, location, x);
 }
 
 void GraphicsContext3D::uniform1iv(GC3Dint location, GC3Dint* v, GC3Dsizei size)
 {
     LOGWEBGL("glUniform1iv(%ld, %p, %d)", location, v, size);
-    makeContextCurrent();
-    glUniform1iv(location, size, v);
+    m_internal->commands()->append(GLCommandUniform1iv, location, size);
+    m_internal->commands()->appendData(v, size * 1 * sizeof(GC3Dint));
 }
 
 void GraphicsContext3D::uniform2f(GC3Dint location, GC3Dfloat x, float y)
 {
     LOGWEBGL("glUniform2f(%ld, %f, %f)", location, x, y);
-    makeContextCurrent();
-    glUniform2f(location, x, y);
+    m_internal->commands()->append(GLCommandUniform2f, location, x, y);
 }
 
 void GraphicsContext3D::uniform2fv(GC3Dint location, GC3Dfloat* v, GC3Dsizei size)
 {
     LOGWEBGL("glUniform2fv(%ld, %p, %d)", location, v, size);
-    makeContextCurrent();
-    glUniform2fv(location, size, v);
+    m_internal->commands()->append(GLCommandUniform2fv, location, size);
+    m_internal->commands()->appendData(v, size * 2 * sizeof(GC3Dfloat));
 }
 
 void GraphicsContext3D::uniform2i(GC3Dint location, GC3Dint x, GC3Dint y)
 {
     LOGWEBGL("glUniform2i(%ld, %d, %d)", location, x, y);
-    makeContextCurrent();
-    glUniform2i(location, x, y);
+    m_internal->commands()->append(GLCommandUniform2i, location, x, y);
 }
 
 void GraphicsContext3D::uniform2iv(GC3Dint location, GC3Dint* v, GC3Dsizei size)
 {
     LOGWEBGL("glUniform2iv(%ld, %p, %d)", location, v, size);
-    makeContextCurrent();
-    glUniform2iv(location, size, v);
+    m_internal->commands()->append(GLCommandUniform2iv, location, size);
+    m_internal->commands()->appendData(v, size * 2 * sizeof(GC3Dint));
 }
 
 void GraphicsContext3D::uniform3f(GC3Dint location, GC3Dfloat x, GC3Dfloat y, GC3Dfloat z)
 {
     LOGWEBGL("glUniform3f(%ld, %f, %f, %f)", location, x, y, z);
-    makeContextCurrent();
-    glUniform3f(location, x, y, z);
+    m_internal->commands()->append(GLCommandUniform3f, location, x, y, z);
 }
 
 void GraphicsContext3D::uniform3fv(GC3Dint location, GC3Dfloat* v, GC3Dsizei size)
 {
     LOGWEBGL("glUniform3fv(%ld, %p, %d)", location, v, size);
-    makeContextCurrent();
-    glUniform3fv(location, size, v);
+    m_internal->commands()->append(GLCommandUniform3fv, location, size);
+    m_internal->commands()->appendData(v, size * 3 * sizeof(GC3Dfloat));
 }
 
 void GraphicsContext3D::uniform3i(GC3Dint location, GC3Dint x, GC3Dint y, GC3Dint z)
 {
     LOGWEBGL("glUniform3i(%ld, %d, %d, %d)", location, x, y, z);
-    makeContextCurrent();
-    glUniform3i(location, x, y, z);
+    m_internal->commands()->append(GLCommandUniform3i, location, x, y, z);
 }
 
 void GraphicsContext3D::uniform3iv(GC3Dint location, GC3Dint* v, GC3Dsizei size)
 {
     LOGWEBGL("glUniform3iv(%ld, %p, %d)", location, v, size);
-    makeContextCurrent();
-    glUniform3iv(location, size, v);
+    m_internal->commands()->append(GLCommandUniform3iv, location, size);
+    m_internal->commands()->appendData(v, size * 3 * sizeof(GC3Dint));
 }
 
 void GraphicsContext3D::uniform4f(GC3Dint location, GC3Dfloat x, GC3Dfloat y,
                                   GC3Dfloat z, GC3Dfloat w)
 {
     LOGWEBGL("glUniform4f(%ld, %f, %f, %f, %f)", location, x, y, z, w);
-    makeContextCurrent();
-    glUniform4f(location, x, y, z, w);
+    m_internal->commands()->append(GLCommandUniform4f, location, x, y, z, w);
 }
 
 void GraphicsContext3D::uniform4fv(GC3Dint location, GC3Dfloat* v, GC3Dsizei size)
 {
     LOGWEBGL("glUniform4fv(%ld, %p, %d)", location, v, size);
-    makeContextCurrent();
-    glUniform4fv(location, size, v);
+    m_internal->commands()->append(GLCommandUniform4fv, location, size);
+    m_internal->commands()->appendData(v, size * 4 * sizeof(GC3Dfloat));
 }
 
 void GraphicsContext3D::uniform4i(GC3Dint location, GC3Dint x, GC3Dint y, GC3Dint z, GC3Dint w)
 {
     LOGWEBGL("glUniform4i(%ld, %d, %d, %d, %d)", location, x, y, z, w);
-    makeContextCurrent();
-    glUniform4i(location, x, y, z, w);
+    m_internal->commands()->append(GLCommandUniform4i, location, x, y, z, w);
 }
 
 void GraphicsContext3D::uniform4iv(GC3Dint location, GC3Dint* v, GC3Dsizei size)
 {
     LOGWEBGL("glUniform4iv(%ld, %p, %d)", location, v, size);
-    makeContextCurrent();
-    glUniform4iv(location, size, v);
+    m_internal->commands()->append(GLCommandUniform4iv, location, size);
+    m_internal->commands()->appendData(v, size * 4 * sizeof(GC3Dint));
 }
 
 void GraphicsContext3D::uniformMatrix2fv(GC3Dint location, GC3Dboolean transpose,
@@ -1204,8 +1183,8 @@ void GraphicsContext3D::uniformMatrix2fv(GC3Dint location, GC3Dboolean transpose
 {
     LOGWEBGL("glUniformMatrix2fv(%ld, %s, %p, %d)",
              location, transpose ? "true" : "false", value, size);
-    makeContextCurrent();
-    glUniformMatrix2fv(location, size, transpose, value);
+    m_internal->commands()->append(GLCommandUniformMatrix2fv, location, size, transpose);
+    m_internal->commands()->appendData(value, size * 4 * sizeof(GC3Dfloat));
 }
 
 void GraphicsContext3D::uniformMatrix3fv(GC3Dint location, GC3Dboolean transpose,
@@ -1213,8 +1192,8 @@ void GraphicsContext3D::uniformMatrix3fv(GC3Dint location, GC3Dboolean transpose
 {
     LOGWEBGL("glUniformMatrix3fv(%ld, %s, %p, %d)",
              location, transpose ? "true" : "false", value, size);
-    makeContextCurrent();
-    glUniformMatrix3fv(location, size, transpose, value);
+    m_internal->commands()->append(GLCommandUniformMatrix3fv, location, size, transpose);
+    m_internal->commands()->appendData(value, size * 9 * sizeof(GC3Dfloat));
 }
 
 void GraphicsContext3D::uniformMatrix4fv(GC3Dint location, GC3Dboolean transpose,
@@ -1222,79 +1201,73 @@ void GraphicsContext3D::uniformMatrix4fv(GC3Dint location, GC3Dboolean transpose
 {
     LOGWEBGL("glUniformMatrix4fv(%ld, %s, %p, %d)",
              location, transpose ? "true" : "false", value, size);
-    makeContextCurrent();
-    glUniformMatrix4fv(location, size, transpose, value);
+    m_internal->commands()->append(GLCommandUniformMatrix4fv, location, size, transpose);
+    m_internal->commands()->appendData(value, size * 16 * sizeof(GC3Dfloat));
 }
 
 void GraphicsContext3D::useProgram(Platform3DObject program)
 {
     LOGWEBGL("glUseProgram(%lu)", program);
-    makeContextCurrent();
-    glUseProgram(program);
+    m_internal->commands()->append(GLCommandUseProgram, program);
 }
 
 void GraphicsContext3D::validateProgram(Platform3DObject program)
 {
     LOGWEBGL("glValidateProgram(%lu)", program);
-    makeContextCurrent();
-    glValidateProgram(program);
+    m_internal->commands()->append(GLCommandValidateProgram, program);
 }
 
 void GraphicsContext3D::vertexAttrib1f(GC3Duint index, GC3Dfloat x)
 {
     LOGWEBGL("glVertexAttrib1f(%lu, %f)", index, x);
-    makeContextCurrent();
-    glVertexAttrib1f(index, x);
+    m_internal->commands()->append(GLCommandVertexAttrib1f, index, x);
 }
 
 void GraphicsContext3D::vertexAttrib1fv(GC3Duint index, GC3Dfloat* values)
 {
     LOGWEBGL("glVertexAttrib1fv(%lu, %p)", index, values);
-    makeContextCurrent();
-    glVertexAttrib1fv(index, values);
+    m_internal->commands()->append(GLCommandVertexAttrib1fv, index);
+    m_internal->commands()->appendData(values, 1 * sizeof(GC3Dfloat));
 }
 
 void GraphicsContext3D::vertexAttrib2f(GC3Duint index, GC3Dfloat x, GC3Dfloat y)
 {
     LOGWEBGL("glVertexAttrib2f(%lu, %f, %f)", index, x, y);
-    makeContextCurrent();
-    glVertexAttrib2f(index, x, y);
+    m_internal->commands()->append(GLCommandVertexAttrib2f, index, x, y);
 }
 
 void GraphicsContext3D::vertexAttrib2fv(GC3Duint index, GC3Dfloat* values)
 {
     LOGWEBGL("glVertexAttrib2fv(%lu, %p)", index, values);
-    makeContextCurrent();
-    glVertexAttrib2fv(index, values);
+    m_internal->commands()->append(GLCommandVertexAttrib2fv, index);
+    m_internal->commands()->appendData(values, 2 * sizeof(GC3Dfloat));
 }
 
 void GraphicsContext3D::vertexAttrib3f(GC3Duint index, GC3Dfloat x, GC3Dfloat y, GC3Dfloat z)
 {
     LOGWEBGL("glVertexAttrib3f(%lu, %f, %f, %f)", index, x, y, z);
-    makeContextCurrent();
-    glVertexAttrib3f(index, x, y, z);
+    m_internal->commands()->append(GLCommandVertexAttrib3f, index, x, y, z);
 }
 
 void GraphicsContext3D::vertexAttrib3fv(GC3Duint index, GC3Dfloat* values)
 {
     LOGWEBGL("glVertexAttrib3fv(%lu, %p)", index, values);
-    makeContextCurrent();
-    glVertexAttrib3fv(index, values);
+    m_internal->commands()->append(GLCommandVertexAttrib3fv, index);
+    m_internal->commands()->appendData(values, 3 * sizeof(GC3Dfloat));
 }
 
 void GraphicsContext3D::vertexAttrib4f(GC3Duint index, GC3Dfloat x, GC3Dfloat y,
                                        GC3Dfloat z, GC3Dfloat w)
 {
     LOGWEBGL("glVertexAttrib4f(%lu, %f, %f, %f, %f)", index, x, y, z, w);
-    makeContextCurrent();
-    glVertexAttrib4f(index, x, y, z, w);
+    m_internal->commands()->append(GLCommandVertexAttrib4f, index, x, y, z, w);
 }
 
 void GraphicsContext3D::vertexAttrib4fv(GC3Duint index, GC3Dfloat* values)
 {
     LOGWEBGL("glVertexAttrib4fv(%lu, %p)", index, values);
-    makeContextCurrent();
-    glVertexAttrib4fv(index, values);
+    m_internal->commands()->append(GLCommandVertexAttrib4fv, index);
+    m_internal->commands()->appendData(values, 4 * sizeof(GC3Dfloat));
 }
 
 void GraphicsContext3D::vertexAttribPointer(GC3Duint index, GC3Dint size, GC3Denum type,
@@ -1303,15 +1276,13 @@ void GraphicsContext3D::vertexAttribPointer(GC3Duint index, GC3Dint size, GC3Den
 {
     LOGWEBGL("glVertexAttribPointer(%lu, %d, %d, %s, %lu, %lu)", index, size, type,
              normalized ? "true" : "false", stride, offset);
-    makeContextCurrent();
-    glVertexAttribPointer(index, size, type, normalized, stride,
-                          reinterpret_cast<GLvoid*>(static_cast<intptr_t>(offset)));
+    m_internal->commands()->append(GLCommandVertexAttribPointer, index, size, type,
+                                   normalized, stride, offset);
 }
 
 void GraphicsContext3D::viewport(GC3Dint x, GC3Dint y, GC3Dsizei width, GC3Dsizei height)
 {
     LOGWEBGL("viewport(%ld, %ld, %lu, %lu)", x, y, width, height);
-    makeContextCurrent();
     m_internal->viewport(x, y, width, height);
 }
 
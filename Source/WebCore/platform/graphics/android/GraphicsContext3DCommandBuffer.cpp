@@ -0,0 +1,753 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "config.h"
+
+#include "GraphicsContext3DCommandBuffer.h"
+
+#if ENABLE(WEBGL)
+
+#include "GraphicsContext3DInternal.h"
+
+namespace WebCore {
+
+// Chunks are handed to the GL thread once they hold this many arguments,
+// so that long frames get replayed while they are still being recorded.
+const size_t GraphicsContext3DCommandBuffer::s_flushThreshold = 16 * 1024;
+
+// Chunks that grew large because of texture or buffer uploads are freed
+// instead of being kept around for reuse.
+const size_t GraphicsContext3DCommandBuffer::s_maxRecycledChunkCapacity = 64 * 1024;
+
+GraphicsContext3DCommandBuffer::GraphicsContext3DCommandBuffer(GraphicsContext3DInternal* context)
+    : m_context(context)
+    , m_flushedChunks(0)
+    , m_replayedChunks(0)
+    , m_running(false)
+    , m_glThread(0)
+{
+}
+
+GraphicsContext3DCommandBuffer::~GraphicsContext3DCommandBuffer()
+{
+    stop();
+    while (!m_pendingChunks.isEmpty())
+        delete m_pendingChunks.takeFirst();
+    deleteAllValues(m_freeChunks);
+}
+
+bool GraphicsContext3DCommandBuffer::start()
+{
+    LOGWEBGL("+GraphicsContext3DCommandBuffer::start()");
+    MutexLocker lock(m_mutex);
+    m_glThread = createThread(glThreadStart, this, "GraphicsContext3DGL");
+    if (!m_glThread)
+        return false;
+    // Wait for thread to start
+    while (!m_running)
+        m_condition.wait(m_mutex);
+    LOGWEBGL("-GraphicsContext3DCommandBuffer::start()");
+    return true;
+}
+
+void GraphicsContext3DCommandBuffer::stop()
+{
+    if (!m_glThread)
+        return;
+
+    LOGWEBGL("+GraphicsContext3DCommandBuffer::stop()");
+    flush();
+    {
+        MutexLocker lock(m_mutex);
+        m_running = false;
+        m_condition.broadcast();
+    }
+    // The GL thread drains all pending chunks before it terminates
+    waitForThreadCompletion(m_glThread, 0);
+    m_glThread = 0;
+    LOGWEBGL("-GraphicsContext3DCommandBuffer::stop()");
+}
+
+void GraphicsContext3DCommandBuffer::appendData(const void* data, size_t size)
+{
+    Argument length;
+    length.u = data ? size : 0;
+    m_recording.append(length);
+    if (!length.u)
+        return;
+
+    size_t offset = m_recording.size();
+    m_recording.grow(offset + dataSlots(&length) - 1);
+    memcpy(m_recording.data() + offset, data, size);
+}
+
+void GraphicsContext3DCommandBuffer::flush()
+{
+    if (m_recording.isEmpty())
+        return;
+
+    MutexLocker lock(m_mutex);
+    Chunk* chunk = m_freeChunks.isEmpty() ? new Chunk() : m_freeChunks.takeLast();
+    chunk->swap(m_recording);
+    m_pendingChunks.append(chunk);
+    m_flushedChunks++;
+    m_condition.broadcast();
+}
+
+void GraphicsContext3DCommandBuffer::finish()
+{
+    flush();
+
+    MutexLocker lock(m_mutex);
+    while (m_replayedChunks != m_flushedChunks && m_running)
+        m_condition.wait(m_mutex);
+}
+
+void* GraphicsContext3DCommandBuffer::glThreadStart(void* self)
+{
+    static_cast<GraphicsContext3DCommandBuffer*>(self)->runGLThread();
+    return 0;
+}
+
+void GraphicsContext3DCommandBuffer::runGLThread()
+{
+    LOGWEBGL("GLThread: starting");
+    MutexLocker lock(m_mutex);
+    m_running = true;
+    // Signal to creator that we are up and running
+    m_condition.broadcast();
+
+    while (true) {
+        while (m_running && m_pendingChunks.isEmpty())
+            m_condition.wait(m_mutex);
+        if (m_pendingChunks.isEmpty())
+            break;
+
+        Chunk* chunk = m_pendingChunks.takeFirst();
+        m_mutex.unlock();
+        replay(*chunk);
+        m_mutex.lock();
+
+        if (chunk->capacity() > s_maxRecycledChunkCapacity) {
+            delete chunk;
+        } else {
+            chunk->shrink(0);
+            m_freeChunks.append(chunk);
+        }
+        m_replayedChunks++;
+        m_condition.broadcast();
+    }
+    LOGWEBGL("GLThread: terminating");
+}
+
+void GraphicsContext3DCommandBuffer::replay(const Chunk& chunk)
+{
+    const Argument* a = chunk.data();
+    const Argument* end = a + chunk.size();
+
+    while (a < end) {
+        GLCommand command = static_cast<GLCommand>(a->u);
+        a++;
+
+        switch (command) {
+        case GLCommandInvoke:
+            a[0].task(const_cast<void*>(a[1].p));
+            a += 2;
+            break;
+        case GLCommandActiveTexture:
+            glActiveTexture(a[0].u);
+            a += 1;
+            break;
+        case GLCommandAttachShader:
+            glAttachShader(a[0].u, a[1].u);
+            a += 2;
+            break;
+        case GLCommandBindAttribLocation:
+            glBindAttribLocation(a[0].u, a[1].u, static_cast<const char*>(dataAt(a + 2)));
+            a += 2 + dataSlots(a + 2);
+            break;
+        case GLCommandBindBuffer:
+            glBindBuffer(a[0].u, a[1].u);
+            a += 2;
+            break;
+        case GLCommandBindFramebuffer:
+            m_context->bindFramebufferOnGLThread(a[0].u, a[1].u);
+            a += 2;
+            break;
+        case GLCommandBindRenderbuffer:
+            glBindRenderbuffer(a[0].u, a[1].u);
+            a += 2;
+            break;
+        case GLCommandBindTexture:
+            glBindTexture(a[0].u, a[1].u);
+            a += 2;
+            break;
+        case GLCommandBlendColor:
+            glBlendColor(a[0].f, a[1].f, a[2].f, a[3].f);
+            a += 4;
+            break;
+        case GLCommandBlendEquation:
+            glBlendEquation(a[0].u);
+            a += 1;
+            break;
+        case GLCommandBlendEquationSeparate:
+            glBlendEquationSeparate(a[0].u, a[1].u);
+            a += 2;
+            break;
+        case GLCommandBlendFunc:
+            glBlendFunc(a[0].u, a[1].u);
+            a += 2;
+            break;
+        case GLCommandBlendFuncSeparate:
+            glBlendFuncSeparate(a[0].u, a[1].u, a[2].u, a[3].u);
+            a += 4;
+            break;
+        case GLCommandBufferData:
+            glBufferData(a[0].u, a[2].u, dataAt(a + 2), a[1].u);
+            a += 2 + dataSlots(a + 2);
+            break;
+        case GLCommandBufferDataEmpty:
+            glBufferData(a[0].u, a[1].ip, 0, a[2].u);
+            a += 3;
+            break;
+        case GLCommandBufferSubData:
+            glBufferSubData(a[0].u, a[1].ip, a[2].u, dataAt(a + 2));
+            a += 2 + dataSlots(a + 2);
+            break;
+        case GLCommandCheckFramebufferStatus:
+            *static_cast<GLenum*>(const_cast<void*>(a[1].p)) = glCheckFramebufferStatus(a[0].u);
+            a += 2;
+            break;
+        case GLCommandClear:
+            glClear(a[0].u);
+            a += 1;
+            break;
+        case GLCommandClearColor:
+            glClearColor(a[0].f, a[1].f, a[2].f, a[3].f);
+            a += 4;
+            break;
+        case GLCommandClearDepth:
+            glClearDepthf(a[0].f);
+            a += 1;
+            break;
+        case GLCommandClearStencil:
+            glClearStencil(a[0].i);
+            a += 1;
+            break;
+        case GLCommandColorMask:
+            glColorMask(a[0].u, a[1].u, a[2].u, a[3].u);
+            a += 4;
+            break;
+        case GLCommandCompileShader:
+            glCompileShader(a[0].u);
+            a += 1;
+            break;
+        case GLCommandCopyTexImage2D:
+            glCopyTexImage2D(a[0].u, a[1].i, a[2].u, a[3].i, a[4].i, a[5].i, a[6].i, a[7].i);
+            a += 8;
+            break;
+        case GLCommandCopyTexSubImage2D:
+            glCopyTexSubImage2D(a[0].u, a[1].i, a[2].i, a[3].i, a[4].i, a[5].i, a[6].i, a[7].i);
+            a += 8;
+            break;
+        case GLCommandCreateProgram:
+            *static_cast<GLuint*>(const_cast<void*>(a[0].p)) = glCreateProgram();
+            a += 1;
+            break;
+        case GLCommandCreateShader:
+            *static_cast<GLuint*>(const_cast<void*>(a[1].p)) = glCreateShader(a[0].u);
+            a += 2;
+            break;
+        case GLCommandCullFace:
+            glCullFace(a[0].u);
+            a += 1;
+            break;
+        case GLCommandDeleteBuffer:
+            glDeleteBuffers(1, &a[0].u);
+            a += 1;
+            break;
+        case GLCommandDeleteFramebuffer:
+            glDeleteFramebuffers(1, &a[0].u);
+            a += 1;
+            break;
+        case GLCommandDeleteProgram:
+            glDeleteProgram(a[0].u);
+            a += 1;
+            break;
+        case GLCommandDeleteRenderbuffer:
+            glDeleteRenderbuffers(1, &a[0].u);
+            a += 1;
+            break;
+        case GLCommandDeleteShader:
+            glDeleteShader(a[0].u);
+            a += 1;
+            break;
+        case GLCommandDeleteTexture:
+            glDeleteTextures(1, &a[0].u);
+            a += 1;
+            break;
+        case GLCommandDepthFunc:
+            glDepthFunc(a[0].u);
+            a += 1;
+            break;
+        case GLCommandDepthMask:
+            glDepthMask(a[0].u);
+            a += 1;
+            break;
+        case GLCommandDepthRange:
+            glDepthRangef(a[0].f, a[1].f);
+            a += 2;
+            break;
+        case GLCommandDetachShader:
+            glDetachShader(a[0].u, a[1].u);
+            a += 2;
+            break;
+        case GLCommandDisable:
+            glDisable(a[0].u);
+            a += 1;
+            break;
+        case GLCommandDisableVertexAttribArray:
+            glDisableVertexAttribArray(a[0].u);
+            a += 1;
+            break;
+        case GLCommandDrawArrays:
+            glDrawArrays(a[0].u, a[1].i, a[2].i);
+            a += 3;
+            break;
+        case GLCommandDrawElements:
+            glDrawElements(a[0].u, a[1].i, a[2].u, reinterpret_cast<void*>(a[3].ip));
+            a += 4;
+            break;
+        case GLCommandEnable:
+            glEnable(a[0].u);
+            a += 1;
+            break;
+        case GLCommandEnableVertexAttribArray:
+            glEnableVertexAttribArray(a[0].u);
+            a += 1;
+            break;
+        case GLCommandFinish:
+            glFinish();
+            break;
+        case GLCommandFlush:
+            glFlush();
+            break;
+        case GLCommandFramebufferRenderbuffer:
+            glFramebufferRenderbuffer(a[0].u, a[1].u, a[2].u, a[3].u);
+            a += 4;
+            break;
+        case GLCommandFramebufferTexture2D:
+            glFramebufferTexture2D(a[0].u, a[1].u, a[2].u, a[3].u, a[4].i);
+            a += 5;
+            break;
+        case GLCommandFrontFace:
+            glFrontFace(a[0].u);
+            a += 1;
+            break;
+        case GLCommandGenBuffers:
+            glGenBuffers(a[0].i, static_cast<GLuint*>(const_cast<void*>(a[1].p)));
+            a += 2;
+            break;
+        case GLCommandGenFramebuffers:
+            glGenFramebuffers(a[0].i, static_cast<GLuint*>(const_cast<void*>(a[1].p)));
+            a += 2;
+            break;
+        case GLCommandGenRenderbuffers:
+            glGenRenderbuffers(a[0].i, static_cast<GLuint*>(const_cast<void*>(a[1].p)));
+            a += 2;
+            break;
+        case GLCommandGenTextures:
+            glGenTextures(a[0].i, static_cast<GLuint*>(const_cast<void*>(a[1].p)));
+            a += 2;
+            break;
+        case GLCommandGenerateMipmap:
+            glGenerateMipmap(a[0].u);
+            a += 1;
+            break;
+        case GLCommandGetActiveAttrib:
+            glGetActiveAttrib(a[0].u, a[1].u, a[2].i,
+                              static_cast<GLsizei*>(const_cast<void*>(a[3].p)),
+                              static_cast<GLint*>(const_cast<void*>(a[4].p)),
+                              static_cast<GLenum*>(const_cast<void*>(a[5].p)),
+                              static_cast<GLchar*>(const_cast<void*>(a[6].p)));
+            a += 7;
+            break;
+        case GLCommandGetActiveUniform:
+            glGetActiveUniform(a[0].u, a[1].u, a[2].i,
+                               static_cast<GLsizei*>(const_cast<void*>(a[3].p)),
+                               static_cast<GLint*>(const_cast<void*>(a[4].p)),
+                               static_cast<GLenum*>(const_cast<void*>(a[5].p)),
+                               static_cast<GLchar*>(const_cast<void*>(a[6].p)));
+            a += 7;
+            break;
+        case GLCommandGetAttachedShaders:
+            glGetAttachedShaders(a[0].u, a[1].i,
+                                 static_cast<GLsizei*>(const_cast<void*>(a[2].p)),
+                                 static_cast<GLuint*>(const_cast<void*>(a[3].p)));
+            a += 4;
+            break;
+        case GLCommandGetAttribLocation:
+            *static_cast<GLint*>(const_cast<void*>(a[2].p)) =
+                glGetAttribLocation(a[0].u, static_cast<const char*>(a[1].p));
+            a += 3;
+            break;
+        case GLCommandGetBooleanv:
+            glGetBooleanv(a[0].u, static_cast<GLboolean*>(const_cast<void*>(a[1].p)));
+            a += 2;
+            break;
+        case GLCommandGetBufferParameteriv:
+            glGetBufferParameteriv(a[0].u, a[1].u, static_cast<GLint*>(const_cast<void*>(a[2].p)));
+            a += 3;
+            break;
+        case GLCommandGetError:
+            *static_cast<GLenum*>(const_cast<void*>(a[0].p)) = glGetError();
+            a += 1;
+            break;
+        case GLCommandGetFloatv:
+            glGetFloatv(a[0].u, static_cast<GLfloat*>(const_cast<void*>(a[1].p)));
+            a += 2;
+            break;
+        case GLCommandGetFramebufferAttachmentParameteriv:
+            glGetFramebufferAttachmentParameteriv(a[0].u, a[1].u, a[2].u,
+                                                  static_cast<GLint*>(const_cast<void*>(a[3].p)));
+            a += 4;
+            break;
+        case GLCommandGetIntegerv:
+            glGetIntegerv(a[0].u, static_cast<GLint*>(const_cast<void*>(a[1].p)));
+            a += 2;
+            break;
+        case GLCommandGetProgramiv:
+            glGetProgramiv(a[0].u, a[1].u, static_cast<GLint*>(const_cast<void*>(a[2].p)));
+            a += 3;
+            break;
+        case GLCommandGetProgramInfoLog:
+            glGetProgramInfoLog(a[0].u, a[1].i, static_cast<GLsizei*>(const_cast<void*>(a[2].p)),
+                                static_cast<GLchar*>(const_cast<void*>(a[3].p)));
+            a += 4;
+            break;
+        case GLCommandGetRenderbufferParameteriv:
+            glGetRenderbufferParameteriv(a[0].u, a[1].u,
+                                         static_cast<GLint*>(const_cast<void*>(a[2].p)));
+            a += 3;
+            break;
+        case GLCommandGetShaderiv:
+            glGetShaderiv(a[0].u, a[1].u, static_cast<GLint*>(const_cast<void*>(a[2].p)));
+            a += 3;
+            break;
+        case GLCommandGetShaderInfoLog:
+            glGetShaderInfoLog(a[0].u, a[1].i, static_cast<GLsizei*>(const_cast<void*>(a[2].p)),
+                               static_cast<GLchar*>(const_cast<void*>(a[3].p)));
+            a += 4;
+            break;
+        case GLCommandGetString:
+            *static_cast<const GLubyte**>(const_cast<void*>(a[1].p)) = glGetString(a[0].u);
+            a += 2;
+            break;
+        case GLCommandGetTexParameterfv:
+            glGetTexParameterfv(a[0].u, a[1].u, static_cast<GLfloat*>(const_cast<void*>(a[2].p)));
+            a += 3;
+            break;
+        case GLCommandGetTexParameteriv:
+            glGetTexParameteriv(a[0].u, a[1].u, static_cast<GLint*>(const_cast<void*>(a[2].p)));
+            a += 3;
+            break;
+        case GLCommandGetUniformfv:
+            glGetUniformfv(a[0].u, a[1].i, static_cast<GLfloat*>(const_cast<void*>(a[2].p)));
+            a += 3;
+            break;
+        case GLCommandGetUniformiv:
+            glGetUniformiv(a[0].u, a[1].i, static_cast<GLint*>(const_cast<void*>(a[2].p)));
+            a += 3;
+            break;
+        case GLCommandGetUniformLocation:
+            *static_cast<GLint*>(const_cast<void*>(a[2].p)) =
+                glGetUniformLocation(a[0].u, static_cast<const char*>(a[1].p));
+            a += 3;
+            break;
+        case GLCommandGetVertexAttribfv:
+            glGetVertexAttribfv(a[0].u, a[1].u, static_cast<GLfloat*>(const_cast<void*>(a[2].p)));
+            a += 3;
+            break;
+        case GLCommandGetVertexAttribiv:
+            glGetVertexAttribiv(a[0].u, a[1].u, static_cast<GLint*>(const_cast<void*>(a[2].p)));
+            a += 3;
+            break;
+        case GLCommandGetVertexAttribPointerv:
+            glGetVertexAttribPointerv(a[0].u, a[1].u, static_cast<GLvoid**>(const_cast<void*>(a[2].p)));
+            a += 3;
+            break;
+        case GLCommandHint:
+            glHint(a[0].u, a[1].u);
+            a += 2;
+            break;
+        case GLCommandIsBuffer:
+            *static_cast<GLboolean*>(const_cast<void*>(a[1].p)) = glIsBuffer(a[0].u);
+            a += 2;
+            break;
+        case GLCommandIsEnabled:
+            *static_cast<GLboolean*>(const_cast<void*>(a[1].p)) = glIsEnabled(a[0].u);
+            a += 2;
+            break;
+        case GLCommandIsFramebuffer:
+            *static_cast<GLboolean*>(const_cast<void*>(a[1].p)) = glIsFramebuffer(a[0].u);
+            a += 2;
+            break;
+        case GLCommandIsProgram:
+            *static_cast<GLboolean*>(const_cast<void*>(a[1].p)) = glIsProgram(a[0].u);
+            a += 2;
+            break;
+        case GLCommandIsRenderbuffer:
+            *static_cast<GLboolean*>(const_cast<void*>(a[1].p)) = glIsRenderbuffer(a[0].u);
+            a += 2;
+            break;
+        case GLCommandIsShader:
+            *static_cast<GLboolean*>(const_cast<void*>(a[1].p)) = glIsShader(a[0].u);
+            a += 2;
+            break;
+        case GLCommandIsTexture:
+            *static_cast<GLboolean*>(const_cast<void*>(a[1].p)) = glIsTexture(a[0].u);
+            a += 2;
+            break;
+        case GLCommandLineWidth:
+            glLineWidth(a[0].f);
+            a += 1;
+            break;
+        case GLCommandLinkProgram:
+            glLinkProgram(a[0].u);
+            a += 1;
+            break;
+        case GLCommandPixelStorei:
+            glPixelStorei(a[0].u, a[1].i);
+            a += 2;
+            break;
+        case GLCommandPolygonOffset:
+            glPolygonOffset(a[0].f, a[1].f);
+            a += 2;
+            break;
+        case GLCommandReadPixels:
+            glReadPixels(a[0].i, a[1].i, a[2].i, a[3].i, a[4].u, a[5].u, const_cast<void*>(a[6].p));
+            a += 7;
+            break;
+        case GLCommandReleaseShaderCompiler:
+            glReleaseShaderCompiler();
+            break;
+        case GLCommandRenderbufferStorage:
+            glRenderbufferStorage(a[0].u, a[1].u, a[2].i, a[3].i);
+            a += 4;
+            break;
+        case GLCommandSampleCoverage:
+            glSampleCoverage(a[0].f, a[1].u);
+            a += 2;
+            break;
+        case GLCommandScissor:
+            glScissor(a[0].i, a[1].i, a[2].i, a[3].i);
+            a += 4;
+            break;
+        case GLCommandShaderSource: {
+            const char* source = a[1].u ? static_cast<const char*>(dataAt(a + 1)) : "";
+            GLint length = a[1].u;
+            glShaderSource(a[0].u, 1, &source, &length);
+            a += 1 + dataSlots(a + 1);
+            break;
+        }
+        case GLCommandStencilFunc:
+            glStencilFunc(a[0].u, a[1].i, a[2].u);
+            a += 3;
+            break;
+        case GLCommandStencilFuncSeparate:
+            glStencilFuncSeparate(a[0].u, a[1].u, a[2].i, a[3].u);
+            a += 4;
+            break;
+        case GLCommandStencilMask:
+            glStencilMask(a[0].u);
+            a += 1;
+            break;
+        case GLCommandStencilMaskSeparate:
+            glStencilMaskSeparate(a[0].u, a[1].u);
+            a += 2;
+            break;
+        case GLCommandStencilOp:
+            glStencilOp(a[0].u, a[1].u, a[2].u);
+            a += 3;
+            break;
+        case GLCommandStencilOpSeparate:
+            glStencilOpSeparate(a[0].u, a[1].u, a[2].u, a[3].u);
+            a += 4;
+            break;
+        case GLCommandTexImage2D:
+            glTexImage2D(a[0].u, a[1].i, a[2].u, a[3].i, a[4].i, a[5].i, a[6].u, a[7].u,
+                         dataAt(a + 8));
+            a += 8 + dataSlots(a + 8);
+            break;
+        case GLCommandTexParameterf:
+            glTexParameterf(a[0].u, a[1].u, a[2].f);
+            a += 3;
+            break;
+        case GLCommandTexParameteri:
+            glTexParameteri(a[0].u, a[1].u, a[2].i);
+            a += 3;
+            break;
+        case GLCommandTexSubImage2D:
+            glTexSubImage2D(a[0].u, a[1].i, a[2].i, a[3].i, a[4].i, a[5].i, a[6].u, a[7].u,
+                            dataAt(a + 8));
+            a += 8 + dataSlots(a + 8);
+            break;
+        case GLCommandUniform1f:
+            glUniform1f(a[0].i, a[1].f);
+            a += 2;
+            break;
+        case GLCommandUniform1fv:
+            glUniform1fv(a[0].i, a[1].i, static_cast<const GLfloat*>(dataAt(a + 2)));
+            a += 2 + dataSlots(a + 2);
+            break;
+        case GLCommandUniform1i:
+            glUniform1i(a[0].i, a[1].i);
+            a += 2;
+            break;
+        case GLCommandUniform1iv:
+            glUniform1iv(a[0].i, a[1].i, static_cast<const GLint*>(dataAt(a + 2)));
+            a += 2 + dataSlots(a + 2);
+            break;
+        case GLCommandUniform2f:
+            glUniform2f(a[0].i, a[1].f, a[2].f);
+            a += 3;
+            break;
+        case GLCommandUniform2fv:
+            glUniform2fv(a[0].i, a[1].i, static_cast<const GLfloat*>(dataAt(a + 2)));
+            a += 2 + dataSlots(a + 2);
+            break;
+        case GLCommandUniform2i:
+            glUniform2i(a[0].i, a[1].i, a[2].i);
+            a += 3;
+            break;
+        case GLCommandUniform2iv:
+            glUniform2iv(a[0].i, a[1].i, static_cast<const GLint*>(dataAt(a + 2)));
+            a += 2 + dataSlots(a + 2);
+            break;
+        case GLCommandUniform3f:
+            glUniform3f(a[0].i, a[1].f, a[2].f, a[3].f);
+            a += 4;
+            break;
+        case GLCommandUniform3fv:
+            glUniform3fv(a[0].i, a[1].i, static_cast<const GLfloat*>(dataAt(a + 2)));
+            a += 2 + dataSlots(a + 2);
+            break;
+        case GLCommandUniform3i:
+            glUniform3i(a[0].i, a[1].i, a[2].i, a[3].i);
+            a += 4;
+            break;
+        case GLCommandUniform3iv:
+            glUniform3iv(a[0].i, a[1].i, static_cast<const GLint*>(dataAt(a + 2)));
+            a += 2 + dataSlots(a + 2);
+            break;
+        case GLCommandUniform4f:
+            glUniform4f(a[0].i, a[1].f, a[2].f, a[3].f, a[4].f);
+            a += 5;
+            break;
+        case GLCommandUniform4fv:
+            glUniform4fv(a[0].i, a[1].i, static_cast<const GLfloat*>(dataAt(a + 2)));
+            a += 2 + dataSlots(a + 2);
+            break;
+        case GLCommandUniform4i:
+            glUniform4i(a[0].i, a[1].i, a[2].i, a[3].i, a[4].i);
+            a += 5;
+            break;
+        case GLCommandUniform4iv:
+            glUniform4iv(a[0].i, a[1].i, static_cast<const GLint*>(dataAt(a + 2)));
+            a += 2 + dataSlots(a + 2);
+            break;
+        case GLCommandUniformMatrix2fv:
+            glUniformMatrix2fv(a[0].i, a[1].i, a[2].u, static_cast<const GLfloat*>(dataAt(a + 3)));
+            a += 3 + dataSlots(a + 3);
+            break;
+        case GLCommandUniformMatrix3fv:
+            glUniformMatrix3fv(a[0].i, a[1].i, a[2].u, static_cast<const GLfloat*>(dataAt(a + 3)));
+            a += 3 + dataSlots(a + 3);
+            break;
+        case GLCommandUniformMatrix4fv:
+            glUniformMatrix4fv(a[0].i, a[1].i, a[2].u, static_cast<const GLfloat*>(dataAt(a + 3)));
+            a += 3 + dataSlots(a + 3);
+            break;
+        case GLCommandUseProgram:
+            glUseProgram(a[0].u);
+            a += 1;
+            break;
+        case GLCommandValidateProgram:
+            glValidateProgram(a[0].u);
+            a += 1;
+            break;
+        case GLCommandVertexAttrib1f:
+            glVertexAttrib1f(a[0].u, a[1].f);
+            a += 2;
+            break;
+        case GLCommandVertexAttrib1fv:
+            glVertexAttrib1fv(a[0].u, static_cast<const GLfloat*>(dataAt(a + 1)));
+            a += 1 + dataSlots(a + 1);
+            break;
+        case GLCommandVertexAttrib2f:
+            glVertexAttrib2f(a[0].u, a[1].f, a[2].f);
+            a += 3;
+            break;
+        case GLCommandVertexAttrib2fv:
+            glVertexAttrib2fv(a[0].u, static_cast<const GLfloat*>(dataAt(a + 1)));
+            a += 1 + dataSlots(a + 1);
+            break;
+        case GLCommandVertexAttrib3f:
+            glVertexAttrib3f(a[0].u, a[1].f, a[2].f, a[3].f);
+            a += 4;
+            break;
+        case GLCommandVertexAttrib3fv:
+            glVertexAttrib3fv(a[0].u, static_cast<const GLfloat*>(dataAt(a + 1)));
+            a += 1 + dataSlots(a + 1);
+            break;
+        case GLCommandVertexAttrib4f:
+            glVertexAttrib4f(a[0].u, a[1].f, a[2].f, a[3].f, a[4].f);
+            a += 5;
+            break;
+        case GLCommandVertexAttrib4fv:
+            glVertexAttrib4fv(a[0].u, static_cast<const GLfloat*>(dataAt(a + 1)));
+            a += 1 + dataSlots(a + 1);
+            break;
+        case GLCommandVertexAttribPointer:
+            glVertexAttribPointer(a[0].u, a[1].i, a[2].u, a[3].u, a[4].i,
+                                  reinterpret_cast<GLvoid*>(a[5].ip));
+            a += 6;
+            break;
+        case GLCommandViewport:
+            glViewport(a[0].i, a[1].i, a[2].i, a[3].i);
+            a += 4;
+            break;
+        default:
+            LOGWEBGL("GLThread: unknown command %d", command);
+            ASSERT_NOT_REACHED();
+            return;
+        }
+    }
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(WEBGL)
@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GraphicsContext3DCommandBuffer_h
+#define GraphicsContext3DCommandBuffer_h
+
+#if ENABLE(WEBGL)
+
+#include "Threading.h"
+
+#include <wtf/Deque.h>
+#include <wtf/Vector.h>
+#include <wtf/text/CString.h>
+
+#include <GLES2/gl2.h>
+
+namespace WebCore {
+
+class GraphicsContext3DInternal;
+
+// Every GL call made by GraphicsContext3D is recorded as one of these,
+// followed by its arguments. Commands that return a value carry pointers
+// to the caller's storage and must be followed by a finish().
+enum GLCommand {
+    GLCommandInvoke,
+    GLCommandActiveTexture,
+    GLCommandAttachShader,
+    GLCommandBindAttribLocation,
+    GLCommandBindBuffer,
+    GLCommandBindFramebuffer,
+    GLCommandBindRenderbuffer,
+    GLCommandBindTexture,
+    GLCommandBlendColor,
+    GLCommandBlendEquation,
+    GLCommandBlendEquationSeparate,
+    GLCommandBlendFunc,
+    GLCommandBlendFuncSeparate,
+    GLCommandBufferData,
+    GLCommandBufferDataEmpty,
+    GLCommandBufferSubData,
+    GLCommandCheckFramebufferStatus,
+    GLCommandClear,
+    GLCommandClearColor,
+    GLCommandClearDepth,
+    GLCommandClearStencil,
+    GLCommandColorMask,
+    GLCommandCompileShader,
+    GLCommandCopyTexImage2D,
+    GLCommandCopyTexSubImage2D,
+    GLCommandCreateProgram,
+    GLCommandCreateShader,
+    GLCommandCullFace,
+    GLCommandDeleteBuffer,
+    GLCommandDeleteFramebuffer,
+    GLCommandDeleteProgram,
+    GLCommandDeleteRenderbuffer,
+    GLCommandDeleteShader,
+    GLCommandDeleteTexture,
+    GLCommandDepthFunc,
+    GLCommandDepthMask,
+    GLCommandDepthRange,
+    GLCommandDetachShader,
+    GLCommandDisable,
+    GLCommandDisableVertexAttribArray,
+    GLCommandDrawArrays,
+    GLCommandDrawElements,
+    GLCommandEnable,
+    GLCommandEnableVertexAttribArray,
+    GLCommandFinish,
+    GLCommandFlush,
+    GLCommandFramebufferRenderbuffer,
+    GLCommandFramebufferTexture2D,
+    GLCommandFrontFace,
+    GLCommandGenBuffers,
+    GLCommandGenFramebuffers,
+    GLCommandGenRenderbuffers,
+    GLCommandGenTextures,
+    GLCommandGenerateMipmap,
+    GLCommandGetActiveAttrib,
+    GLCommandGetActiveUniform,
+    GLCommandGetAttachedShaders,
+    GLCommandGetAttribLocation,
+    GLCommandGetBooleanv,
+    GLCommandGetBufferParameteriv,
+    GLCommandGetError,
+    GLCommandGetFloatv,
+    GLCommandGetFramebufferAttachmentParameteriv,
+    GLCommandGetIntegerv,
+    GLCommandGetProgramiv,
+    GLCommandGetProgramInfoLog,
+    GLCommandGetRenderbufferParameteriv,
+    GLCommandGetShaderiv,
+    GLCommandGetShaderInfoLog,
+    GLCommandGetString,
+    GLCommandGetTexParameterfv,
+    GLCommandGetTexParameteriv,
+    GLCommandGetUniformfv,
+    GLCommandGetUniformiv,
+    GLCommandGetUniformLocation,
+    GLCommandGetVertexAttribfv,
+    GLCommandGetVertexAttribiv,
+    GLCommandGetVertexAttribPointerv,
+    GLCommandHint,
+    GLCommandIsBuffer,
+    GLCommandIsEnabled,
+    GLCommandIsFramebuffer,
+    GLCommandIsProgram,
+    GLCommandIsRenderbuffer,
+    GLCommandIsShader,
+    GLCommandIsTexture,
+    GLCommandLineWidth,
+    GLCommandLinkProgram,
+    GLCommandPixelStorei,
+    GLCommandPolygonOffset,
+    GLCommandReadPixels,
+    GLCommandReleaseShaderCompiler,
+    GLCommandRenderbufferStorage,
+    GLCommandSampleCoverage,
+    GLCommandScissor,
+    GLCommandShaderSource,
+    GLCommandStencilFunc,
+    GLCommandStencilFuncSeparate,
+    GLCommandStencilMask,
+    GLCommandStencilMaskSeparate,
+    GLCommandStencilOp,
+    GLCommandStencilOpSeparate,
+    GLCommandTexImage2D,
+    GLCommandTexParameterf,
+    GLCommandTexParameteri,
+    GLCommandTexSubImage2D,
+    GLCommandUniform1f,
+    GLCommandUniform1fv,
+    GLCommandUniform1i,
+    GLCommandUniform1iv,
+    GLCommandUniform2f,
+    GLCommandUniform2fv,
+    GLCommandUniform2i,
+    GLCommandUniform2iv,
+    GLCommandUniform3f,
+    GLCommandUniform3fv,
+    GLCommandUniform3i,
+    GLCommandUniform3iv,
+    GLCommandUniform4f,
+    GLCommandUniform4fv,
+    GLCommandUniform4i,
+    GLCommandUniform4iv,
+    GLCommandUniformMatrix2fv,
+    GLCommandUniformMatrix3fv,
+    GLCommandUniformMatrix4fv,
+    GLCommandUseProgram,
+    GLCommandValidateProgram,
+    GLCommandVertexAttrib1f,
+    GLCommandVertexAttrib1fv,
+    GLCommandVertexAttrib2f,
+    GLCommandVertexAttrib2fv,
+    GLCommandVertexAttrib3f,
+    GLCommandVertexAttrib3fv,
+    GLCommandVertexAttrib4f,
+    GLCommandVertexAttrib4fv,
+    GLCommandVertexAttribPointer,
+    GLCommandViewport
+};
+
+// Serializes the GL calls of one WebGL context on the WebCore thread and
+// replays them on a dedicated GL thread, which is the only thread that ever
+// makes the context's EGLContext current.
+//
+// Recording is only allowed from the WebCore thread. Commands are batched
+// into chunks that are handed over to the GL thread when flush() is called or
+// when the current chunk grows past a threshold. finish() additionally blocks
+// until the GL thread has replayed everything, which is what getters need.
+class GraphicsContext3DCommandBuffer {
+public:
+    typedef void (*Task)(void* context);
+
+    GraphicsContext3DCommandBuffer(GraphicsContext3DInternal* context);
+    ~GraphicsContext3DCommandBuffer();
+
+    bool start();
+    void stop();
+
+    void append(GLCommand command) { pushCommand(command); }
+    template<typename A0>
+    void append(GLCommand command, A0 a0)
+    {
+        pushCommand(command);
+        push(a0);
+    }
+    template<typename A0, typename A1>
+    void append(GLCommand command, A0 a0, A1 a1)
+    {
+        pushCommand(command);
+        push(a0); push(a1);
+    }
+    template<typename A0, typename A1, typename A2>
+    void append(GLCommand command, A0 a0, A1 a1, A2 a2)
+    {
+        pushCommand(command);
+        push(a0); push(a1); push(a2);
+    }
+    template<typename A0, typename A1, typename A2, typename A3>
+    void append(GLCommand command, A0 a0, A1 a1, A2 a2, A3 a3)
+    {
+        pushCommand(command);
+        push(a0); push(a1); push(a2); push(a3);
+    }
+    template<typename A0, typename A1, typename A2, typename A3, typename A4>
+    void append(GLCommand command, A0 a0, A1 a1, A2 a2, A3 a3, A4 a4)
+    {
+        pushCommand(command);
+        push(a0); push(a1); push(a2); push(a3); push(a4);
+    }
+    template<typename A0, typename A1, typename A2, typename A3, typename A4, typename A5>
+    void append(GLCommand command, A0 a0, A1 a1, A2 a2, A3 a3, A4 a4, A5 a5)
+    {
+        pushCommand(command);
+        push(a0); push(a1); push(a2); push(a3); push(a4); push(a5);
+    }
+    template<typename A0, typename A1, typename A2, typename A3, typename A4, typename A5,
+             typename A6>
+    void append(GLCommand command, A0 a0, A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6)
+    {
+        pushCommand(command);
+        push(a0); push(a1); push(a2); push(a3); push(a4); push(a5); push(a6);
+    }
+    template<typename A0, typename A1, typename A2, typename A3, typename A4, typename A5,
+             typename A6, typename A7>
+    void append(GLCommand command, A0 a0, A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7)
+    {
+        pushCommand(command);
+        push(a0); push(a1); push(a2); push(a3); push(a4); push(a5); push(a6); push(a7);
+    }
+
+    // Copies size bytes into the stream, as the last argument of the
+    // command that was just appended.
+    void appendData(const void* data, size_t size);
+    void appendString(const CString& string) { appendData(string.data(), string.length() + 1); }
+
+    // Runs task(context) on the GL thread, in order with the recorded commands.
+    void post(Task task, void* context) { append(GLCommandInvoke, task, context); }
+    void postAndWait(Task task, void* context)
+    {
+        post(task, context);
+        finish();
+    }
+
+    void flush();
+    void finish();
+
+private:
+    union Argument {
+        GLint i;
+        GLuint u;
+        GLfloat f;
+        intptr_t ip;
+        const void* p;
+        Task task;
+    };
+    typedef Vector<Argument> Chunk;
+
+    void pushCommand(GLCommand command)
+    {
+        if (m_recording.size() >= s_flushThreshold)
+            flush();
+        Argument a;
+        a.u = command;
+        m_recording.append(a);
+    }
+    void push(GLint value) { Argument a; a.i = value; m_recording.append(a); }
+    void push(GLuint value) { Argument a; a.u = value; m_recording.append(a); }
+    void push(GLboolean value) { Argument a; a.u = value; m_recording.append(a); }
+    void push(GLfloat value) { Argument a; a.f = value; m_recording.append(a); }
+    void push(long value) { Argument a; a.ip = value; m_recording.append(a); }
+    void push(const void* value) { Argument a; a.p = value; m_recording.append(a); }
+    void push(Task value) { Argument a; a.task = value; m_recording.append(a); }
+
+    static const void* dataAt(const Argument* a) { return a->u ? a + 1 : 0; }
+    static size_t dataSlots(const Argument* a)
+    {
+        return 1 + (a->u + sizeof(Argument) - 1) / sizeof(Argument);
+    }
+
+    static void* glThreadStart(void* self);
+    void runGLThread();
+    void replay(const Chunk& chunk);
+
+    static const size_t s_flushThreshold;
+    static const size_t s_maxRecycledChunkCapacity;
+
+    GraphicsContext3DInternal* m_context;
+
+    // Owned by the WebCore thread
+    Chunk m_recording;
+    unsigned m_flushedChunks;
+
+    // Shared with the GL thread, protected by m_mutex
+    Deque<Chunk*> m_pendingChunks;
+    Vector<Chunk*> m_freeChunks;
+    unsigned m_replayedChunks;
+    bool m_running;
+    ThreadIdentifier m_glThread;
+    WTF::Mutex m_mutex;
+    WTF::ThreadCondition m_condition;
+};
+
+} // namespace WebCore
+
+#endif // ENABLE(WEBGL)
+#endif // GraphicsContext3DCommandBuffer_h
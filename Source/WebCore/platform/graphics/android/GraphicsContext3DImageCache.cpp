@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include "GraphicsContext3DImageCache.h"
+
+#if ENABLE(WEBGL)
+
+#include "BitmapImage.h"
+#include "GraphicsContext3DInternal.h"
+
+#include <pthread.h>
+
+namespace WebCore {
+
+// Large enough for a few sprite sheets, small compared to the textures
+// themselves, which live in GL memory anyway. A 1024x1024 RGBA sheet is
+// 4 MB of pixels plus its encoded data, and must fit in a single entry.
+static const size_t s_defaultByteBudget = 16 * 1024 * 1024;
+static const size_t s_maxEntrySize = s_defaultByteBudget / 2;
+
+static GraphicsContext3DImageCache* gImageCache = 0;
+static pthread_once_t gImageCacheOnce = PTHREAD_ONCE_INIT;
+
+void GraphicsContext3DImageCache::createInstance()
+{
+    gImageCache = new GraphicsContext3DImageCache();
+}
+
+GraphicsContext3DImageCache* GraphicsContext3DImageCache::instance()
+{
+    pthread_once(&gImageCacheOnce, createInstance);
+    return gImageCache;
+}
+
+GraphicsContext3DImageCache::GraphicsContext3DImageCache()
+    : m_entries(s_defaultByteBudget, s_maxEntrySize)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+bool GraphicsContext3DImageCache::isCacheable(Image* image)
+{
+    return image->data() && image->isBitmapImage() && static_cast<BitmapImage*>(image)->frameCount() == 1;
+}
+
+GraphicsContext3DImageCache::Key GraphicsContext3DImageCache::makeKey(SharedBuffer* data,
+                                                                      GC3Denum format, GC3Denum type,
+                                                                      bool premultiplyAlpha,
+                                                                      bool ignoreGammaAndColorProfile)
+{
+    unsigned flags = (premultiplyAlpha ? 1 : 0) | (ignoreGammaAndColorProfile ? 2 : 0);
+    return Key(data, std::make_pair(format, (type << 2) | flags));
+}
+
+bool GraphicsContext3DImageCache::lookup(Image* image, GC3Denum format, GC3Denum type,
+                                         bool premultiplyAlpha, bool ignoreGammaAndColorProfile,
+                                         Vector<uint8_t>& outputVector)
+{
+    if (!isCacheable(image))
+        return false;
+
+    SharedBuffer* data = image->data();
+    Key key = makeKey(data, format, type, premultiplyAlpha, ignoreGammaAndColorProfile);
+    Entry* entry = m_entries.get(key);
+    if (!entry) {
+        m_misses++;
+        return false;
+    }
+
+    if (entry->dataSize != data->size()) {
+        // More data has arrived since the image was packed
+        m_entries.remove(key);
+        m_misses++;
+        return false;
+    }
+
+    outputVector = entry->pixels;
+    m_hits++;
+    LOGWEBGL("GraphicsContext3DImageCache: hit, %u hits, %u misses", m_hits, m_misses);
+    return true;
+}
+
+void GraphicsContext3DImageCache::store(Image* image, GC3Denum format, GC3Denum type,
+                                        bool premultiplyAlpha, bool ignoreGammaAndColorProfile,
+                                        const Vector<uint8_t>& pixels)
+{
+    if (!isCacheable(image))
+        return;
+
+    SharedBuffer* data = image->data();
+    Entry entry;
+    entry.data = data;
+    entry.dataSize = data->size();
+    entry.pixels = pixels;
+    m_entries.set(makeKey(data, format, type, premultiplyAlpha, ignoreGammaAndColorProfile),
+                  entry, data->size() + pixels.size());
+    LOGWEBGL("GraphicsContext3DImageCache: stored %u bytes, %u entries, %u bytes total",
+             pixels.size(), m_entries.size(), m_entries.bytes());
+}
+
+void GraphicsContext3DImageCache::clear()
+{
+    LOGWEBGL("GraphicsContext3DImageCache::clear(), %u entries, %u bytes", m_entries.size(), m_entries.bytes());
+    m_entries.clear();
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(WEBGL)
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GraphicsContext3DImageCache_h
+#define GraphicsContext3DImageCache_h
+
+#if ENABLE(WEBGL)
+
+#include "GraphicsContext3DLRUCache.h"
+#include "GraphicsTypes3D.h"
+#include "SharedBuffer.h"
+
+#include <wtf/RefPtr.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class Image;
+
+// Process-wide cache of image data that has already been decoded and
+// packed for texImage2D(), so that uploading the same image again, from
+// another context or after a context loss, is a copy instead of a full
+// decode. Entries are keyed by the encoded image data and the upload
+// parameters, and are evicted least recently used first once the byte
+// budget, which covers the encoded data they keep alive, is exceeded.
+// Only single frame bitmap images are cached, since the frame that is
+// uploaded changes as animated images play. Only used from the WebCore
+// thread.
+class GraphicsContext3DImageCache {
+public:
+    static GraphicsContext3DImageCache* instance();
+
+    bool lookup(Image* image, GC3Denum format, GC3Denum type, bool premultiplyAlpha,
+                bool ignoreGammaAndColorProfile, Vector<uint8_t>& outputVector);
+    void store(Image* image, GC3Denum format, GC3Denum type, bool premultiplyAlpha,
+               bool ignoreGammaAndColorProfile, const Vector<uint8_t>& data);
+
+    // Drops all entries, called when the system is low on memory.
+    void clear();
+
+    // Number of lookups that found, or did not find, packed pixels
+    unsigned hits() const { return m_hits; }
+    unsigned misses() const { return m_misses; }
+
+private:
+    GraphicsContext3DImageCache();
+    static void createInstance();
+
+    typedef std::pair<SharedBuffer*, std::pair<unsigned, unsigned> > Key;
+    struct Entry {
+        // Keeps the encoded data, and with it the key, from being reused
+        RefPtr<SharedBuffer> data;
+        unsigned dataSize;
+        Vector<uint8_t> pixels;
+    };
+
+    static bool isCacheable(Image* image);
+    static Key makeKey(SharedBuffer* data, GC3Denum format, GC3Denum type,
+                       bool premultiplyAlpha, bool ignoreGammaAndColorProfile);
+
+    GraphicsContext3DLRUCache<Key, Entry> m_entries;
+    unsigned m_hits;
+    unsigned m_misses;
+};
+
+} // namespace WebCore
+
+#endif // ENABLE(WEBGL)
+#endif // GraphicsContext3DImageCache_h
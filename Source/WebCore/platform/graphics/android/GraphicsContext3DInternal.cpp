@@ -30,10 +30,14 @@
 #include "GraphicsContext3DInternal.h"
 
 #include "Frame.h"
+#include "GraphicsContext3DImageCache.h"
+#include "GraphicsContext3DShaderCache.h"
+#include "GraphicsContext3DSyncService.h"
 #include "HostWindow.h"
 #include "HTMLCanvasElement.h"
 #include "ImageBuffer.h"
 #include "ImageData.h"
+#include "PlatformBridge.h"
 #include "PlatformGraphicsContext.h"
 #include "RenderLayer.h"
 #include "RenderLayerBacking.h"
@@ -49,6 +53,8 @@
 #include <surfaceflinger/SurfaceComposerClient.h>
 #include <surfaceflinger/IGraphicBufferAlloc.h>
 #include <JNIUtility.h>
+#include <pthread.h>
+#include <wtf/CurrentTime.h>
 
 #if ENABLE(WEBGL)
 namespace WebCore {
@@ -98,6 +104,29 @@ private:
 #define CANVAS_MAX_WIDTH    1280
 #define CANVAS_MAX_HEIGHT   1280
 
+// A dequeue that blocks for longer than this counts as a stall. Enough stalls
+// within one evaluation window make the swap chain grow by one buffer.
+static const double s_dequeueStallThreshold = 0.004;
+static const unsigned s_stallsBeforeGrowing = 3;
+static const unsigned s_swapChainEvaluationInterval = 60;
+
+static int gMaxSwapChainDepth = MAX_NUM_BUFFERS;
+static pthread_mutex_t gSwapChainStatisticsLock = PTHREAD_MUTEX_INITIALIZER;
+static GraphicsContext3DInternal::SwapChainStatistics gSwapChainStatistics;
+
+GraphicsContext3DInternal::SwapChainStatistics GraphicsContext3DInternal::swapChainStatistics()
+{
+    pthread_mutex_lock(&gSwapChainStatisticsLock);
+    SwapChainStatistics statistics = gSwapChainStatistics;
+    pthread_mutex_unlock(&gSwapChainStatisticsLock);
+    return statistics;
+}
+
+void GraphicsContext3DInternal::setMaxSwapChainDepth(int depth)
+{
+    gMaxSwapChainDepth = std::max(MIN_NUM_BUFFERS, std::min(depth, MAX_NUM_BUFFERS));
+}
+
 EGLint GraphicsContext3DInternal::checkEGLError(const char* s)
 {
     EGLint error = eglGetError();
@@ -141,14 +170,23 @@ GraphicsContext3DInternal::GraphicsContext3DInternal(HTMLCanvasElement* canvas,
     , m_config(0)
     , m_surface(EGL_NO_SURFACE)
     , m_context(EGL_NO_CONTEXT)
-    , m_syncThread(0)
-    , m_threadState(THREAD_STATE_STOPPED)
+    , m_contextCreated(false)
+    , m_unpackAlignment(4)
+    , m_boundFBO(0)
+    , m_currentFBO(0)
+    , m_frontFBO(0)
+    , m_mappedFBO(0)
+    , m_swapChainDepth(MIN_NUM_BUFFERS)
+    , m_maxSwapChainDepth(MAX_NUM_BUFFERS)
+    , m_stalledDequeues(0)
+    , m_dequeuesSinceEvaluation(0)
     , m_syncTimer(this, &GraphicsContext3DInternal::syncTimerFired)
     , m_syncRequested(false)
     , m_extensions(0)
     , m_contextId(0)
 {
     LOGWEBGL("GraphicsContext3DInternal() = %p, m_compositingLayer = %p", this, m_compositingLayer);
+    memset(&m_swapChainStats, 0, sizeof(m_swapChainStats));
     m_compositingLayer->ref();
     m_proxy->setGraphicsContext(this);
 
@@ -171,17 +209,49 @@ GraphicsContext3DInternal::GraphicsContext3DInternal(HTMLCanvasElement* canvas,
     if (!initEGL())
         return;
 
-    if (!createContext(true)) {
+    m_commandBuffer.set(new GraphicsContext3DCommandBuffer(this));
+    if (!m_commandBuffer->start())
+        return;
+
+    m_commandBuffer->postAndWait(createContextTask, this);
+    if (!m_contextCreated) {
         LOGWEBGL("Create context failed. Perform JS garbage collection and try again.");
         // Probably too many contexts. Force a JS garbage collection, and then try again.
         // This typically only happens in Khronos Conformance tests.
+        GraphicsContext3DImageCache::instance()->clear();
+        GraphicsContext3DShaderCache::instance()->clear();
         m_canvas->document()->frame()->script()->lowMemoryNotification();
-        if (!createContext(true)) {
+        m_commandBuffer->postAndWait(createContextTask, this);
+        if (!m_contextCreated) {
             LOGWEBGL("Create context still failed: aborting.");
             return;
         }
     }
+    m_commandBuffer->postAndWait(initializeContextTask, this);
+
+    m_savedViewport.x = 0;
+    m_savedViewport.y = 0;
+    m_savedViewport.width = m_width;
+    m_savedViewport.height = m_height;
+
+    static int contextCounter = 1;
+    m_contextId = contextCounter++;
+}
+
+void GraphicsContext3DInternal::createContextTask(void* self)
+{
+    GraphicsContext3DInternal* context = static_cast<GraphicsContext3DInternal*>(self);
+    context->m_contextCreated = context->createContext(true);
+}
 
+void GraphicsContext3DInternal::initializeContextTask(void* self)
+{
+    static_cast<GraphicsContext3DInternal*>(self)->initializeContext();
+}
+
+// Runs on the GL thread while the constructor waits for it.
+void GraphicsContext3DInternal::initializeContext()
+{
     const char *ext = (const char *)glGetString(GL_EXTENSIONS);
     LOGWEBGL("GL_EXTENSIONS = %s", ext);
     // Want to keep control of which extensions are used
@@ -209,36 +279,40 @@ GraphicsContext3DInternal::GraphicsContext3DInternal(HTMLCanvasElement* canvas,
     resources.MaxDrawBuffers = 1;
     m_compiler.setResources(resources);
 
-    m_savedViewport.x = 0;
-    m_savedViewport.y = 0;
-    m_savedViewport.width = m_width;
-    m_savedViewport.height = m_height;
-
     glClearColor(0, 0, 0, 0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    startSyncThread();
-
-    static int contextCounter = 1;
-    m_contextId = contextCounter++;
 }
 
 GraphicsContext3DInternal::~GraphicsContext3DInternal()
 {
     LOGWEBGL("~GraphicsContext3DInternal(), this = %p", this);
 
-    stopSyncThread();
+    if (m_commandBuffer)
+        m_commandBuffer->finish();
+    GraphicsContext3DSyncService::instance()->cancel(this);
 
     m_proxy->setGraphicsContext(0);
-    MutexLocker lock(m_fboMutex);
-    m_compositingLayer->unref();
-    m_compositingLayer = 0;
-    deleteContext(true);
+    {
+        MutexLocker lock(m_fboMutex);
+        m_compositingLayer->unref();
+        m_compositingLayer = 0;
+    }
+    if (m_commandBuffer) {
+        m_commandBuffer->postAndWait(destroyContextTask, this);
+        m_commandBuffer->stop();
+    }
 
     JNIEnv* env = JSC::Bindings::getJNIEnv();
     env->DeleteGlobalRef(m_webView);
 }
 
+void GraphicsContext3DInternal::destroyContextTask(void* self)
+{
+    GraphicsContext3DInternal* context = static_cast<GraphicsContext3DInternal*>(self);
+    MutexLocker lock(context->m_fboMutex);
+    context->deleteContext(true);
+}
+
 bool GraphicsContext3DInternal::initEGL()
 {
     m_dpy = eglGetDisplay(EGL_DEFAULT_DISPLAY);
@@ -316,16 +390,17 @@ bool GraphicsContext3DInternal::createContext(bool createEGLContext)
     }
 
     makeContextCurrent();
-    for (int i = 0; i < NUM_BUFFERS; i++) {
+    for (int i = 0; i < m_swapChainDepth; i++) {
         FBO* tmp = FBO::createFBO(m_dpy, m_width > 0 ? m_width : 1, m_height > 0 ? m_height : 1);
         if (tmp == 0) {
             LOGWEBGL("Failed to create FBO");
             deleteContext(createEGLContext);
             return false;
         }
-        m_fbo[i] = tmp;
+        m_fbo.append(tmp);
         m_freeBuffers.append(tmp);
     }
+    m_swapChainStats.depth = m_fbo.size();
 
     m_currentFBO = dequeueBuffer();
     m_boundFBO = m_currentFBO->fbo();
@@ -345,12 +420,8 @@ void GraphicsContext3DInternal::deleteContext(bool deleteEGLContext)
     m_freeBuffers.clear();
     m_queuedBuffers.clear();
     m_preparedBuffers.clear();
-    for (int i = 0; i < NUM_BUFFERS; i++) {
-        if (m_fbo[i]) {
-            delete m_fbo[i];
-            m_fbo[i] = 0;
-        }
-    }
+    deleteAllValues(m_fbo);
+    m_fbo.clear();
     m_currentFBO = 0;
     m_frontFBO = 0;
 
@@ -388,8 +459,38 @@ unsigned long GraphicsContext3DInternal::getError()
         return err;
     }
     LOGWEBGL("glGetError()");
-    makeContextCurrent();
-    return glGetError();
+    GLenum error = GL_NO_ERROR;
+    m_commandBuffer->append(GLCommandGetError, &error);
+    m_commandBuffer->finish();
+    return error;
+}
+
+Platform3DObject GraphicsContext3DInternal::createName(NameType type)
+{
+    static const GLCommand genCommands[NameTypeCount] = {
+        GLCommandGenBuffers,
+        GLCommandGenFramebuffers,
+        GLCommandGenRenderbuffers,
+        GLCommandGenTextures
+    };
+    static const int namePoolSize = 16;
+
+    // Names are generated in batches so that creating objects does not
+    // require a round trip to the GL thread every time.
+    Vector<GLuint>& pool = m_namePool[type];
+    if (pool.isEmpty()) {
+        GLuint names[namePoolSize];
+        memset(names, 0, sizeof(names));
+        m_commandBuffer->append(genCommands[type], namePoolSize, names);
+        m_commandBuffer->finish();
+        for (int i = namePoolSize - 1; i >= 0; i--) {
+            if (names[i])
+                pool.append(names[i]);
+        }
+        if (pool.isEmpty())
+            return 0;
+    }
+    return pool.takeLast();
 }
 
 void GraphicsContext3DInternal::synthesizeGLError(unsigned long error)
@@ -553,94 +654,41 @@ GLuint FBO::createTexture(EGLImageKHR image, int width, int height)
     return texture;
 }
 
-void GraphicsContext3DInternal::startSyncThread()
+/*
+ * Called by a GraphicsContext3DSyncService worker for every FBO queued in
+ * swapBuffers(). Waits for the rendering to the oldest queued FBO to finish
+ * and then makes it available to the compositor.
+ */
+void GraphicsContext3DInternal::prepareQueuedBuffer()
 {
-    LOGWEBGL("+startSyncThread()");
-    MutexLocker lock(m_threadMutex);
-    m_threadState = THREAD_STATE_STOPPED;
-    m_syncThread = createThread(syncThreadStart, this, "GraphicsContext3DInternal");
-    // Wait for thread to start
-    while (m_threadState != THREAD_STATE_RUN) {
-        m_threadCondition.wait(m_threadMutex);
+    FBO* fbo = 0;
+    {
+        MutexLocker lock(m_fboMutex);
+        if (m_queuedBuffers.isEmpty())
+            return;
+        fbo = m_queuedBuffers.takeFirst();
     }
-    LOGWEBGL("-startSyncThread()");
-}
+    LOGWEBGL("prepareQueuedBuffer(): fbo = %p", fbo);
 
-void GraphicsContext3DInternal::stopSyncThread()
-{
-    LOGWEBGL("+stopSyncThread()");
-    MutexLocker lock(m_threadMutex);
-    if (m_syncThread) {
-        m_threadState = THREAD_STATE_STOP;
-        // Signal thread to wake up
-        m_threadCondition.broadcast();
-        // Wait for thread to stop
-        while (m_threadState != THREAD_STATE_STOPPED) {
-            m_threadCondition.wait(m_threadMutex);
-        }
-        m_syncThread = 0;
+    if (fbo->sync() != EGL_NO_SYNC_KHR) {
+        eglClientWaitSyncKHR(m_dpy, fbo->sync(), 0, 0);
+        eglDestroySyncKHR(m_dpy, fbo->sync());
+        fbo->setSync(EGL_NO_SYNC_KHR);
+        LOGWEBGL("prepareQueuedBuffer(): returned after waiting for Sync");
     }
-    LOGWEBGL("-stopSyncThread()");
-}
-
-void* GraphicsContext3DInternal::syncThreadStart(void* ctx)
-{
-    GraphicsContext3DInternal* context = static_cast<GraphicsContext3DInternal*>(ctx);
-    context->runSyncThread();
-
-    return 0;
-}
-
-void GraphicsContext3DInternal::runSyncThread()
-{
-    LOGWEBGL("SyncThread: starting");
-    FBO* fbo = 0;
-
-    MutexLocker lock(m_threadMutex);
-    m_threadState = THREAD_STATE_RUN;
-    // Signal to creator that we are up and running
-    m_threadCondition.broadcast();
-
-    while (m_threadState == THREAD_STATE_RUN) {
-        while (m_threadState == THREAD_STATE_RUN) {
-            {
-                MutexLocker lock(m_fboMutex);
-                if (!m_queuedBuffers.isEmpty()) {
-                    fbo = m_queuedBuffers.takeFirst();
-                    break;
-                }
-            }
-            m_threadCondition.wait(m_threadMutex);
-        }
-        LOGWEBGL("SyncThread: woke after waiting for FBO, fbo = %p", fbo);
-        if (m_threadState != THREAD_STATE_RUN)
-            break;
-
-        if (fbo->sync() != EGL_NO_SYNC_KHR) {
-            eglClientWaitSyncKHR(m_dpy, fbo->sync(), 0, 0);
-            eglDestroySyncKHR(m_dpy, fbo->sync());
-            fbo->setSync(EGL_NO_SYNC_KHR);
-            LOGWEBGL("SyncThread: returned after waiting for Sync");
-        }
-
-        {
-            MutexLocker lock(m_fboMutex);
-            m_preparedBuffers.append(fbo);
-            LOGWEBGL("SyncThread: prepared buffer = %p", fbo);
-            updateFrontBuffer();
-        }
 
-        // Invalidate the canvas region
-        if (m_postInvalidate) {
-            JNIEnv* env = JSC::Bindings::getJNIEnv();
-            env->CallVoidMethod(m_webView, m_postInvalidate);
-        }
+    {
+        MutexLocker lock(m_fboMutex);
+        m_preparedBuffers.append(fbo);
+        LOGWEBGL("prepareQueuedBuffer(): prepared buffer = %p", fbo);
+        updateFrontBuffer();
     }
 
-    // Signal to calling thread that we have stopped
-    m_threadState = THREAD_STATE_STOPPED;
-    m_threadCondition.broadcast();
-    LOGWEBGL("SyncThread: terminating");
+    // Invalidate the canvas region
+    if (m_postInvalidate) {
+        JNIEnv* env = JSC::Bindings::getJNIEnv();
+        env->CallVoidMethod(m_webView, m_postInvalidate);
+    }
 }
 
 PlatformLayer* GraphicsContext3DInternal::platformLayer() const
@@ -652,53 +700,79 @@ PlatformLayer* GraphicsContext3DInternal::platformLayer() const
 void GraphicsContext3DInternal::reshape(int width, int height)
 {
     LOGWEBGL("reshape(%d, %d)", width, height);
-    bool mustRestoreFBO = (m_boundFBO != (m_currentFBO ? m_currentFBO->fbo() : 0));
+    m_commandBuffer->finish();
+    // The FBOs are about to be deleted, make sure no fence wait is using them
+    GraphicsContext3DSyncService::instance()->cancel(this);
 
     m_width = width > m_maxwidth ? m_maxwidth : width;
     m_height = height > m_maxheight ? m_maxheight : height;
 
-    stopSyncThread();
-    makeContextCurrent();
     m_proxy->setGraphicsContext(0);
-    {
-        MutexLocker lock(m_fboMutex);
-        deleteContext(false);
+    m_commandBuffer->postAndWait(reshapeTask, this);
+    m_proxy->setGraphicsContext(this);
+}
 
-        if (createContext(false)) {
-            if (!mustRestoreFBO) {
-                m_boundFBO = m_currentFBO->fbo();
-            }
-            glBindFramebuffer(GL_FRAMEBUFFER, m_boundFBO);
+void GraphicsContext3DInternal::reshapeTask(void* self)
+{
+    static_cast<GraphicsContext3DInternal*>(self)->reshapeSurface();
+}
+
+void GraphicsContext3DInternal::reshapeSurface()
+{
+    bool mustRestoreFBO = (m_boundFBO != (m_currentFBO ? m_currentFBO->fbo() : 0));
+
+    makeContextCurrent();
+    MutexLocker lock(m_fboMutex);
+    deleteContext(false);
+
+    if (createContext(false)) {
+        if (!mustRestoreFBO) {
+            m_boundFBO = m_currentFBO->fbo();
         }
+        glBindFramebuffer(GL_FRAMEBUFFER, m_boundFBO);
     }
-    m_proxy->setGraphicsContext(this);
-    startSyncThread();
 }
 
 void GraphicsContext3DInternal::recreateSurface()
 {
     LOGWEBGL("recreateSurface()");
+    // m_currentFBO belongs to the GL thread, wait for it to go idle
+    m_commandBuffer->finish();
     if (m_currentFBO != 0)
         // We already have a current surface
         return;
     reshape(m_width, m_height);
-    glViewport(m_savedViewport.x, m_savedViewport.y, m_savedViewport.width, m_savedViewport.height);
+    m_commandBuffer->append(GLCommandViewport, m_savedViewport.x, m_savedViewport.y,
+                            m_savedViewport.width, m_savedViewport.height);
 }
 
 void GraphicsContext3DInternal::releaseSurface()
 {
     LOGWEBGL("releaseSurface(%d)", m_contextId);
+    // m_currentFBO belongs to the GL thread, wait for it to go idle
+    m_commandBuffer->finish();
     if (m_currentFBO == 0)
         // We don't have any current surface
         return;
-    stopSyncThread();
+    GraphicsContext3DSyncService::instance()->cancel(this);
     m_proxy->setGraphicsContext(0);
+    m_commandBuffer->postAndWait(releaseSurfaceTask, this);
+    m_proxy->setGraphicsContext(this);
+    m_readbackBuffer.clear();
+}
+
+void GraphicsContext3DInternal::releaseSurfaceTask(void* self)
+{
+    GraphicsContext3DInternal* context = static_cast<GraphicsContext3DInternal*>(self);
     {
-        MutexLocker lock(m_fboMutex);
-        deleteContext(false);
+        MutexLocker lock(context->m_fboMutex);
+        context->deleteContext(false);
+        // Start over with a minimal swap chain when the surface comes back
+        context->m_swapChainDepth = MIN_NUM_BUFFERS;
+        context->m_stalledDequeues = 0;
+        context->m_dequeuesSinceEvaluation = 0;
     }
-    makeContextCurrent();
-    m_proxy->setGraphicsContext(this);
+    context->makeContextCurrent();
 }
 
 void GraphicsContext3DInternal::syncTimerFired(Timer<GraphicsContext3DInternal>*)
@@ -706,8 +780,18 @@ void GraphicsContext3DInternal::syncTimerFired(Timer<GraphicsContext3DInternal>*
     m_syncRequested = false;
 
     // Do not perform the composition step if it is an offscreen canvas
-    if (m_canvas->renderer())
-        swapBuffers();
+    if (m_canvas->renderer()) {
+        m_commandBuffer->post(swapBuffersTask, this);
+        m_canvasDirty = false;
+        m_layerComposited = true;
+    }
+    // Let the GL thread start on the frame while the next one is recorded
+    m_commandBuffer->flush();
+}
+
+void GraphicsContext3DInternal::swapBuffersTask(void* self)
+{
+    static_cast<GraphicsContext3DInternal*>(self)->swapBuffers();
 }
 
 void GraphicsContext3DInternal::markContextChanged()
@@ -726,9 +810,19 @@ void GraphicsContext3DInternal::markContextChanged()
 FBO* GraphicsContext3DInternal::dequeueBuffer()
 {
     LOGWEBGL("GraphicsContext3DInternal::dequeueBuffer()");
-    while (m_freeBuffers.isEmpty()) {
-        m_fboCondition.wait(m_fboMutex);
+    // Rather than stalling again, add a buffer if we have been stalling lately
+    if (m_freeBuffers.isEmpty() && m_stalledDequeues >= s_stallsBeforeGrowing)
+        growSwapChain();
+
+    double waitTime = 0;
+    if (m_freeBuffers.isEmpty()) {
+        double start = WTF::currentTime();
+        while (m_freeBuffers.isEmpty()) {
+            m_fboCondition.wait(m_fboMutex);
+        }
+        waitTime = WTF::currentTime() - start;
     }
+    updateSwapChainStatistics(waitTime);
     FBO* fbo = m_freeBuffers.takeFirst();
 
     if (fbo->sync() != EGL_NO_SYNC_KHR) {
@@ -740,6 +834,112 @@ FBO* GraphicsContext3DInternal::dequeueBuffer()
     return fbo;
 }
 
+/*
+ * Must hold m_fboMutex when calling this function.
+ */
+void GraphicsContext3DInternal::updateSwapChainStatistics(double waitTime)
+{
+    m_swapChainStats.dequeueCount++;
+    if (waitTime > 0) {
+        m_swapChainStats.waitCount++;
+        m_swapChainStats.totalWaitTime += waitTime;
+        if (waitTime > m_swapChainStats.maxWaitTime)
+            m_swapChainStats.maxWaitTime = waitTime;
+    }
+    if (waitTime > s_dequeueStallThreshold)
+        m_stalledDequeues++;
+
+    pthread_mutex_lock(&gSwapChainStatisticsLock);
+    gSwapChainStatistics.depth = std::max(gSwapChainStatistics.depth, static_cast<int>(m_fbo.size()));
+    gSwapChainStatistics.dequeueCount++;
+    if (waitTime > 0) {
+        gSwapChainStatistics.waitCount++;
+        gSwapChainStatistics.totalWaitTime += waitTime;
+        gSwapChainStatistics.maxWaitTime = std::max(gSwapChainStatistics.maxWaitTime, waitTime);
+    }
+    pthread_mutex_unlock(&gSwapChainStatisticsLock);
+
+    if (++m_dequeuesSinceEvaluation < s_swapChainEvaluationInterval)
+        return;
+
+    LOGWEBGL("swap chain: depth = %d, stalls = %u, dequeues = %u, waits = %u, "
+             "total wait = %.1f ms, max wait = %.1f ms", static_cast<int>(m_fbo.size()), m_stalledDequeues,
+             m_swapChainStats.dequeueCount, m_swapChainStats.waitCount,
+             m_swapChainStats.totalWaitTime * 1000, m_swapChainStats.maxWaitTime * 1000);
+
+    // Give memory back when the system is running low, or when the chain is
+    // longer than allowed
+    int highMemoryUsageMB = PlatformBridge::highMemoryUsageMB();
+    if ((highMemoryUsageMB > 0 && PlatformBridge::memoryUsageMB() > highMemoryUsageMB)
+        || static_cast<int>(m_fbo.size()) > gMaxSwapChainDepth)
+        shrinkSwapChain();
+
+    m_stalledDequeues = 0;
+    m_dequeuesSinceEvaluation = 0;
+}
+
+/*
+ * Must hold m_fboMutex when calling this function.
+ */
+bool GraphicsContext3DInternal::growSwapChain()
+{
+    if (static_cast<int>(m_fbo.size()) >= std::min(m_maxSwapChainDepth, gMaxSwapChainDepth))
+        return false;
+
+    int highMemoryUsageMB = PlatformBridge::highMemoryUsageMB();
+    if (highMemoryUsageMB > 0 && PlatformBridge::memoryUsageMB() > highMemoryUsageMB)
+        return false;
+
+    // This runs in the middle of the application's command stream, and
+    // creating the FBO leaves texture and renderbuffer 0 bound. The caller,
+    // swapBuffers(), restores the framebuffer binding.
+    GLint boundTexture = 0;
+    GLint boundRenderbuffer = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+    glGetIntegerv(GL_RENDERBUFFER_BINDING, &boundRenderbuffer);
+    FBO* fbo = FBO::createFBO(m_dpy, m_width > 0 ? m_width : 1, m_height > 0 ? m_height : 1);
+    glBindTexture(GL_TEXTURE_2D, boundTexture);
+    glBindRenderbuffer(GL_RENDERBUFFER, boundRenderbuffer);
+    if (!fbo) {
+        LOGWEBGL("growSwapChain(): failed to create FBO");
+        // Don't retry on every frame
+        m_maxSwapChainDepth = m_fbo.size();
+        return false;
+    }
+    m_fbo.append(fbo);
+    m_freeBuffers.append(fbo);
+    m_swapChainDepth = m_fbo.size();
+    m_swapChainStats.depth = m_swapChainDepth;
+    m_stalledDequeues = 0;
+    LOGWEBGL("growSwapChain(): depth = %d", m_swapChainDepth);
+    return true;
+}
+
+/*
+ * Must hold m_fboMutex when calling this function.
+ * Only buffers that are free can be released; if none is, we try again
+ * at the next evaluation.
+ */
+bool GraphicsContext3DInternal::shrinkSwapChain()
+{
+    if (m_fbo.size() <= MIN_NUM_BUFFERS || m_freeBuffers.isEmpty())
+        return false;
+
+    FBO* fbo = m_freeBuffers.takeFirst();
+    size_t index = m_fbo.find(fbo);
+    ASSERT(index != notFound);
+    m_fbo.remove(index);
+    if (fbo->sync() != EGL_NO_SYNC_KHR) {
+        eglClientWaitSyncKHR(m_dpy, fbo->sync(), 0, 0);
+        eglDestroySyncKHR(m_dpy, fbo->sync());
+    }
+    delete fbo;
+    m_swapChainDepth = m_fbo.size();
+    m_swapChainStats.depth = m_swapChainDepth;
+    LOGWEBGL("shrinkSwapChain(): depth = %d", m_swapChainDepth);
+    return true;
+}
+
 void GraphicsContext3DInternal::swapBuffers()
 {
     LOGWEBGL("+swapBuffers()");
@@ -756,11 +956,11 @@ void GraphicsContext3DInternal::swapBuffers()
         glBindFramebuffer(GL_FRAMEBUFFER, fbo->fbo());
     }
 
-    // Create the fence sync and notify the sync thread
+    // Create the fence sync and let the sync service wait for it
     fbo->setSync(eglCreateSyncKHR(m_dpy, EGL_SYNC_FENCE_KHR, 0));
     glFlush();
     m_queuedBuffers.append(fbo);
-    m_threadCondition.broadcast();
+    GraphicsContext3DSyncService::instance()->queueBuffer(this);
 
     // Dequeue a new buffer
     fbo = dequeueBuffer();
@@ -770,8 +970,6 @@ void GraphicsContext3DInternal::swapBuffers()
         m_boundFBO = m_currentFBO->fbo();
     }
     glBindFramebuffer(GL_FRAMEBUFFER, m_boundFBO);
-    m_canvasDirty = false;
-    m_layerComposited = true;
     LOGWEBGL("-swapBuffers()");
 }
 
@@ -831,6 +1029,43 @@ void GraphicsContext3DInternal::releaseFrontBuffer()
     updateFrontBuffer();
 }
 
+const unsigned char* GraphicsContext3DInternal::mapDrawingBuffer(int& bytesPerRow)
+{
+    // Once the GL thread has finished rendering, the GraphicBuffer backing
+    // the current FBO holds the drawing buffer and can be read in place.
+    m_commandBuffer->append(GLCommandFinish);
+    m_commandBuffer->finish();
+
+    {
+        MutexLocker lock(m_fboMutex);
+        unsigned char* bits = 0;
+        if (m_currentFBO && m_currentFBO->lockGraphicBuffer((void**)&bits)) {
+            m_mappedFBO = m_currentFBO;
+            bytesPerRow = m_currentFBO->bytesPerRow();
+            return bits;
+        }
+    }
+
+    LOGWEBGL("  could not map the current FBO, using glReadPixels()");
+    // The staging buffer is kept between calls, resize() only reallocates
+    // when the drawing buffer has grown.
+    bytesPerRow = m_width * 4;
+    m_readbackBuffer.resize(bytesPerRow * m_height);
+    m_commandBuffer->append(GLCommandReadPixels, 0, 0, m_width, m_height,
+                            GL_RGBA, GL_UNSIGNED_BYTE, m_readbackBuffer.data());
+    m_commandBuffer->finish();
+    return m_readbackBuffer.data();
+}
+
+void GraphicsContext3DInternal::unmapDrawingBuffer()
+{
+    MutexLocker lock(m_fboMutex);
+    if (m_mappedFBO) {
+        m_mappedFBO->unlockGraphicBuffer();
+        m_mappedFBO = 0;
+    }
+}
+
 void GraphicsContext3DInternal::paintRenderingResultsToCanvas(CanvasRenderingContext* context)
 {
     LOGWEBGL("paintRenderingResultsToCanvas()");
@@ -839,25 +1074,40 @@ void GraphicsContext3DInternal::paintRenderingResultsToCanvas(CanvasRenderingCon
         imageBuffer->context()->platformContext()->mCanvas->getDevice()->accessBitmap(false);
     SkCanvas canvas(canvasBitmap);
 
+    int bytesPerRow = 0;
+    const unsigned char* pixels = mapDrawingBuffer(bytesPerRow);
+
     SkBitmap bitmap;
-    bitmap.setConfig(SkBitmap::kARGB_8888_Config, m_width, m_height);
-    bitmap.allocPixels();
-    unsigned char *pixels = static_cast<unsigned char*>(bitmap.getPixels());
-    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    bitmap.setConfig(SkBitmap::kARGB_8888_Config, m_width, m_height, bytesPerRow);
+    bitmap.setPixels(const_cast<unsigned char*>(pixels));
 
     SkRect  dstRect;
     dstRect.iset(0, 0, imageBuffer->size().width(), imageBuffer->size().height());
+    canvas.save();
+    canvas.translate(0, SkIntToScalar(imageBuffer->size().height()));
+    canvas.scale(SK_Scalar1, -SK_Scalar1);
     canvas.drawBitmapRect(bitmap, 0, dstRect);
+    canvas.restore();
+    bitmap.setPixels(0);
+
+    unmapDrawingBuffer();
 }
 
 PassRefPtr<ImageData> GraphicsContext3DInternal::paintRenderingResultsToImageData()
 {
     LOGWEBGL("paintRenderingResultsToImageData()");
     RefPtr<ImageData> imageData = ImageData::create(IntSize(m_width, m_height));
-    unsigned char* pixels = imageData->data()->data()->data();
+    unsigned char* dst = imageData->data()->data()->data();
+
+    int bytesPerRow = 0;
+    const unsigned char* src = mapDrawingBuffer(bytesPerRow);
 
-    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    // ImageData is top row first
+    int rowBytes = m_width * 4;
+    for (int y = 0; y < m_height; y++)
+        memcpy(dst + y * rowBytes, src + (m_height - 1 - y) * bytesPerRow, rowBytes);
 
+    unmapDrawingBuffer();
     return imageData;
 }
 
@@ -899,7 +1149,12 @@ bool GraphicsContext3DInternal::paintCompositedResultsToCanvas(CanvasRenderingCo
 void GraphicsContext3DInternal::bindFramebuffer(GC3Denum target, Platform3DObject buffer)
 {
     LOGWEBGL("glBindFrameBuffer(%d, %d)", target, buffer);
-    makeContextCurrent();
+    // Binding 0 means binding the current FBO, which only the GL thread knows
+    m_commandBuffer->append(GLCommandBindFramebuffer, target, buffer);
+}
+
+void GraphicsContext3DInternal::bindFramebufferOnGLThread(GC3Denum target, Platform3DObject buffer)
+{
     MutexLocker lock(m_fboMutex);
     if (!buffer && m_currentFBO) {
         buffer = m_currentFBO->fbo();
@@ -918,15 +1173,26 @@ void GraphicsContext3DInternal::compileShader(Platform3DObject shader)
     }
     ShaderSourceEntry& entry = result->second;
 
-    int shaderType;
-    glGetShaderiv(shader, GL_SHADER_TYPE, &shaderType);
+    if (!entry.type) {
+        GLint shaderType = 0;
+        m_commandBuffer->append(GLCommandGetShaderiv, shader, GL_SHADER_TYPE, &shaderType);
+        m_commandBuffer->finish();
+        entry.type = shaderType;
+    }
 
-    ANGLEShaderType ast = shaderType == GL_VERTEX_SHADER ?
+    ANGLEShaderType ast = entry.type == GL_VERTEX_SHADER ?
         SHADER_TYPE_VERTEX : SHADER_TYPE_FRAGMENT;
 
-    String src;
     String log;
-    bool isValid = m_compiler.validateShaderSource(entry.source.utf8().data(), ast, src, log);
+    bool isValid = false;
+    ShBuiltInResources resources = m_compiler.getResources();
+    GraphicsContext3DShaderCache* cache = GraphicsContext3DShaderCache::instance();
+    if (!cache->lookup(ast, entry.source, resources, log, isValid)) {
+        // the translated source is not used, GL compiles entry.source
+        String translatedSource;
+        isValid = m_compiler.validateShaderSource(entry.source.utf8().data(), ast, translatedSource, log);
+        cache->store(ast, entry.source, resources, log, isValid);
+    }
 
     entry.log = log;
     entry.isValid = isValid;
@@ -935,15 +1201,14 @@ void GraphicsContext3DInternal::compileShader(Platform3DObject shader)
         LOGWEBGL("  shader validation failed");
         return;
     }
-    int len = entry.source.length();
     CString cstr = entry.source.utf8();
-    const char* s = cstr.data();
 
     LOGWEBGL("glShaderSource(%s)", cstr.data());
-    glShaderSource(shader, 1, &s, &len);
+    m_commandBuffer->append(GLCommandShaderSource, shader);
+    m_commandBuffer->appendData(cstr.data(), cstr.length());
 
     LOGWEBGL("glCompileShader()");
-    glCompileShader(shader);
+    m_commandBuffer->append(GLCommandCompileShader, shader);
 }
 
 String GraphicsContext3DInternal::getShaderInfoLog(Platform3DObject shader)
@@ -961,16 +1226,19 @@ String GraphicsContext3DInternal::getShaderInfoLog(Platform3DObject shader)
     if (entry.isValid) {
         LOGWEBGL("  validated shader, retrieve OpenGL log");
         GLuint shaderID = shader;
-        GLint logLength;
-        glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &logLength);
+        GLint logLength = 0;
+        m_commandBuffer->append(GLCommandGetShaderiv, shaderID, GL_INFO_LOG_LENGTH, &logLength);
+        m_commandBuffer->finish();
         if (!logLength)
             return "";
 
         char* log = 0;
         if ((log = (char *)fastMalloc(logLength * sizeof(char))) == 0)
             return "";
-        GLsizei returnedLogLength;
-        glGetShaderInfoLog(shaderID, logLength, &returnedLogLength, log);
+        GLsizei returnedLogLength = 0;
+        m_commandBuffer->append(GLCommandGetShaderInfoLog, shaderID, logLength,
+                                &returnedLogLength, log);
+        m_commandBuffer->finish();
         String res = String(log, returnedLogLength);
         fastFree(log);
 
@@ -998,15 +1266,42 @@ void GraphicsContext3DInternal::shaderSource(Platform3DObject shader, const Stri
     LOGWEBGL("shaderSource()");
     ShaderSourceEntry entry;
 
+    HashMap<Platform3DObject, ShaderSourceEntry>::iterator result = m_shaderSourceMap.find(shader);
+    entry.type = result != m_shaderSourceMap.end() ? result->second.type : 0;
     entry.source = string;
+    entry.isValid = false;
 
     m_shaderSourceMap.set(shader, entry);
 }
 
+Platform3DObject GraphicsContext3DInternal::createShader(GC3Denum type)
+{
+    LOGWEBGL("glCreateShader()");
+    GLuint shader = 0;
+    m_commandBuffer->append(GLCommandCreateShader, type, &shader);
+    m_commandBuffer->finish();
+    if (shader) {
+        // Remember the type so compileShader() does not have to ask the GL thread
+        ShaderSourceEntry entry;
+        entry.type = type;
+        entry.isValid = false;
+        m_shaderSourceMap.set(shader, entry);
+    }
+    return shader;
+}
+
+void GraphicsContext3DInternal::deleteShader(Platform3DObject shader)
+{
+    LOGWEBGL("glDeleteShader()");
+    m_shaderSourceMap.remove(shader);
+    m_commandBuffer->append(GLCommandDeleteShader, shader);
+}
+
 void GraphicsContext3DInternal::viewport(long x, long y, unsigned long width, unsigned long height)
 {
     LOGWEBGL("glViewport(%d, %d, %d, %d)", x, y, width, height);
-    glViewport(x, y, width, height);
+    m_commandBuffer->append(GLCommandViewport, static_cast<GLint>(x), static_cast<GLint>(y),
+                            static_cast<GLsizei>(width), static_cast<GLsizei>(height));
     m_savedViewport.x = x;
     m_savedViewport.y = y;
     m_savedViewport.width = width;
@@ -33,6 +33,7 @@
 #include "CanvasRenderingContext.h"
 #include "Extensions3DAndroid.h"
 #include "GraphicsContext3D.h"
+#include "GraphicsContext3DCommandBuffer.h"
 #include "HTMLCanvasElement.h"
 #include "SkRect.h"
 #include "Threading.h"
@@ -58,8 +59,11 @@
 #define LOGWEBGL(...)
 #endif
 
-// This can be increased to 3, for example, if that has a positive impact on performance.
-#define NUM_BUFFERS 2
+// Bounds for the depth of the FBO swap chain. Every buffer is a full canvas
+// sized GraphicBuffer, so the chain starts out at MIN_NUM_BUFFERS and only
+// grows when the producer keeps stalling on dequeueBuffer().
+#define MIN_NUM_BUFFERS 2
+#define MAX_NUM_BUFFERS 4
 
 using namespace android;
 
@@ -67,13 +71,6 @@ namespace WebCore {
 
 #define CLAMP(x) GraphicsContext3DInternal::clampValue(x)
 
-typedef enum {
-    THREAD_STATE_STOPPED,
-    THREAD_STATE_RUN,
-    THREAD_STATE_RESTART,
-    THREAD_STATE_STOP
-} thread_state_t;
-
 class GraphicsContext3DProxy;
 class FBO;
 
@@ -87,6 +84,19 @@ public:
 
     PlatformLayer* platformLayer() const;
 
+    // All GL calls for this context are recorded here and executed on the
+    // GL thread, which is the only thread the EGL context is current on.
+    GraphicsContext3DCommandBuffer* commands() { return m_commandBuffer.get(); }
+
+    enum NameType {
+        BufferName,
+        FramebufferName,
+        RenderbufferName,
+        TextureName,
+        NameTypeCount
+    };
+    Platform3DObject createName(NameType type);
+
     void makeContextCurrent();
     GraphicsContext3D::Attributes getContextAttributes();
     void reshape(int width, int height);
@@ -102,6 +112,8 @@ public:
     bool layerComposited() const { return m_layerComposited; }
 
     void updateFrontBuffer();
+    // Called by GraphicsContext3DSyncService, once per swapped buffer
+    void prepareQueuedBuffer();
     bool lockFrontBuffer(EGLImageKHR& image, SkRect& rect);
     void releaseFrontBuffer();
 
@@ -123,6 +135,28 @@ public:
     Extensions3D* getExtensions() { return m_extensions.get(); }
 
     void bindFramebuffer(GC3Denum target, Platform3DObject buffer);
+    void bindFramebufferOnGLThread(GC3Denum target, Platform3DObject buffer);
+
+    Platform3DObject createShader(GC3Denum type);
+    void deleteShader(Platform3DObject shader);
+
+    // Swap chain statistics, summed over all contexts of the process. depth
+    // is the deepest swap chain any context grew, wait times are in seconds.
+    struct SwapChainStatistics {
+        int depth;
+        unsigned dequeueCount;
+        unsigned waitCount;
+        double totalWaitTime;
+        double maxWaitTime;
+    };
+    static SwapChainStatistics swapChainStatistics();
+    // Caps the number of buffers a swap chain grows to, clamped to
+    // [MIN_NUM_BUFFERS, MAX_NUM_BUFFERS]. Longer chains are shrunk at their
+    // next evaluation.
+    static void setMaxSwapChainDepth(int depth);
+
+    int unpackAlignment() const { return m_unpackAlignment; }
+    void setUnpackAlignment(int alignment) { m_unpackAlignment = alignment; }
 
     static GLclampf clampValue(GLclampf x)  {
         GLclampf tmp = x;
@@ -150,6 +184,23 @@ private:
     bool createContext(bool createEGLContext);
     void deleteContext(bool deleteEGLContext);
 
+    // Tasks run on the GL thread through the command buffer
+    static void createContextTask(void* self);
+    static void initializeContextTask(void* self);
+    static void destroyContextTask(void* self);
+    static void reshapeTask(void* self);
+    static void releaseSurfaceTask(void* self);
+    static void swapBuffersTask(void* self);
+    void initializeContext();
+    void reshapeSurface();
+
+    // Makes the drawing buffer readable from the WebCore thread, bottom
+    // row first. Maps the GraphicBuffer of the current FBO when possible
+    // and otherwise reads the pixels back into m_readbackBuffer. Every
+    // call must be paired with unmapDrawingBuffer().
+    const unsigned char* mapDrawingBuffer(int& bytesPerRow);
+    void unmapDrawingBuffer();
+
     RefPtr<GraphicsContext3DProxy> m_proxy;
     WebGLLayer *m_compositingLayer;
     HTMLCanvasElement* m_canvas;
@@ -166,34 +217,44 @@ private:
     EGLConfig  m_config;
     EGLSurface m_surface;
     EGLContext m_context;
+    bool       m_contextCreated;
+
+    OwnPtr<GraphicsContext3DCommandBuffer> m_commandBuffer;
+    Vector<GLuint> m_namePool[NameTypeCount];
+    int m_unpackAlignment;
 
     // Routines for FBOs
-    FBO*                 m_fbo[NUM_BUFFERS];
+    Vector<FBO*>         m_fbo;
     GLuint               m_boundFBO;
     FBO*                 m_currentFBO;
     FBO*                 m_frontFBO;
     Deque<FBO*>          m_freeBuffers;
     Deque<FBO*>          m_queuedBuffers;
     Deque<FBO*>          m_preparedBuffers;
+    FBO*                 m_mappedFBO;
+    Vector<unsigned char> m_readbackBuffer;
     WTF::Mutex           m_fboMutex;
     WTF::ThreadCondition m_fboCondition;
 
-    void startSyncThread();
-    void stopSyncThread();
-    static void* syncThreadStart(void* ctx);
-    void runSyncThread();
-    ThreadIdentifier m_syncThread;
-    thread_state_t   m_threadState;
-    WTF::Mutex           m_threadMutex;
-    WTF::ThreadCondition m_threadCondition;
-
     void syncTimerFired(Timer<GraphicsContext3DInternal>*);
     FBO* dequeueBuffer();
     void swapBuffers();
+
+    // Swap chain adaptation, GL thread only with m_fboMutex held
+    bool growSwapChain();
+    bool shrinkSwapChain();
+    void updateSwapChainStatistics(double waitTime);
+    int m_swapChainDepth;
+    // lowered if allocating a buffer fails
+    int m_maxSwapChainDepth;
+    unsigned m_stalledDequeues;
+    unsigned m_dequeuesSinceEvaluation;
+    SwapChainStatistics m_swapChainStats;
     Timer<GraphicsContext3DInternal> m_syncTimer;
     bool m_syncRequested;
 
     typedef struct {
+        GC3Denum type;
         String source;
         String log;
         bool isValid;
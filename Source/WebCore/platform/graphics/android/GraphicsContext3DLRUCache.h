@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef GraphicsContext3DLRUCache_h
+#define GraphicsContext3DLRUCache_h
+
+#if ENABLE(WEBGL)
+
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/Noncopyable.h>
+
+#include <algorithm>
+
+namespace WebCore {
+
+// Map with a byte budget, shared by the process-wide WebGL caches. The
+// caller gives the size of each value, and values are evicted least
+// recently used first once the total goes over the budget. Not thread
+// safe.
+template<typename KeyType, typename ValueType>
+class GraphicsContext3DLRUCache {
+    WTF_MAKE_NONCOPYABLE(GraphicsContext3DLRUCache);
+public:
+    // Values larger than maxValueSize are not stored, so that a single one
+    // doesn't flush everything else out.
+    GraphicsContext3DLRUCache(size_t byteBudget, size_t maxValueSize)
+        : m_byteBudget(byteBudget)
+        , m_maxValueSize(std::min(maxValueSize, byteBudget))
+        , m_bytes(0)
+    {
+    }
+
+    ~GraphicsContext3DLRUCache() { clear(); }
+
+    // Returns the value for the key and marks it as most recently used, or
+    // 0 if there is none.
+    ValueType* get(const KeyType& key)
+    {
+        typename HashMap<KeyType, Entry*>::iterator it = m_entries.find(key);
+        if (it == m_entries.end())
+            return 0;
+
+        Entry* entry = it->second;
+        m_lru.remove(entry);
+        m_lru.add(entry);
+        return &entry->value;
+    }
+
+    // Adds or replaces the value for the key, unless it is too large.
+    void set(const KeyType& key, const ValueType& value, size_t size)
+    {
+        remove(key);
+        if (size > m_maxValueSize)
+            return;
+
+        while (!m_lru.isEmpty() && m_bytes + size > m_byteBudget)
+            evict(m_lru.first());
+
+        Entry* entry = new Entry(key, value, size);
+        m_entries.set(key, entry);
+        m_lru.add(entry);
+        m_bytes += size;
+    }
+
+    void remove(const KeyType& key)
+    {
+        typename HashMap<KeyType, Entry*>::iterator it = m_entries.find(key);
+        if (it != m_entries.end())
+            evict(it->second);
+    }
+
+    void clear()
+    {
+        while (!m_lru.isEmpty())
+            evict(m_lru.first());
+    }
+
+    unsigned size() const { return m_entries.size(); }
+    size_t bytes() const { return m_bytes; }
+
+private:
+    struct Entry {
+        Entry(const KeyType& key, const ValueType& value, size_t size)
+            : key(key)
+            , value(value)
+            , size(size)
+        {
+        }
+
+        KeyType key;
+        ValueType value;
+        size_t size;
+    };
+
+    void evict(Entry* entry)
+    {
+        m_entries.remove(entry->key);
+        m_lru.remove(entry);
+        m_bytes -= entry->size;
+        delete entry;
+    }
+
+    HashMap<KeyType, Entry*> m_entries;
+    // Least recently used entry first
+    ListHashSet<Entry*> m_lru;
+    size_t m_byteBudget;
+    size_t m_maxValueSize;
+    size_t m_bytes;
+};
+
+} // namespace WebCore
+
+#endif // ENABLE(WEBGL)
+#endif // GraphicsContext3DLRUCache_h
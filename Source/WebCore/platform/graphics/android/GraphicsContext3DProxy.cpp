@@ -30,6 +30,7 @@
 
 #include "GraphicsContext3DProxy.h"
 #include "GraphicsContext3DInternal.h"
+#include "TilesManager.h"
 
 namespace WebCore {
 
@@ -74,8 +75,10 @@ bool GraphicsContext3DProxy::lockFrontBuffer(GLuint& texture, SkRect& rect)
     EGLImageKHR image;
     bool locked = m_context->lockFrontBuffer(image, rect);
     if (locked) {
-        if (m_texture == 0)
+        if (m_texture == 0) {
             glGenTextures(1, &m_texture);
+            TilesManager::instance()->shader()->forgetTexture(m_texture);
+        }
 
         glBindTexture(GL_TEXTURE_EXTERNAL_OES, m_texture);
         glEGLImageTargetTexture2DOES(GL_TEXTURE_EXTERNAL_OES, image);
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include "GraphicsContext3DShaderCache.h"
+
+#if ENABLE(WEBGL)
+
+#include "GraphicsContext3DInternal.h"
+
+#include <pthread.h>
+#include <wtf/HashFunctions.h>
+#include <wtf/StringHasher.h>
+
+namespace WebCore {
+
+// Shader sources are a few kilobytes each, this holds the shaders of
+// several shader-heavy pages.
+static const size_t s_defaultByteBudget = 512 * 1024;
+
+static GraphicsContext3DShaderCache* gShaderCache = 0;
+static pthread_once_t gShaderCacheOnce = PTHREAD_ONCE_INIT;
+
+void GraphicsContext3DShaderCache::createInstance()
+{
+    gShaderCache = new GraphicsContext3DShaderCache();
+}
+
+GraphicsContext3DShaderCache* GraphicsContext3DShaderCache::instance()
+{
+    pthread_once(&gShaderCacheOnce, createInstance);
+    return gShaderCache;
+}
+
+GraphicsContext3DShaderCache::GraphicsContext3DShaderCache()
+    : m_entries(s_defaultByteBudget, s_defaultByteBudget / 4)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+unsigned GraphicsContext3DShaderCache::computeHash(ANGLEShaderType type, const String& source,
+                                                   const ShBuiltInResources& resources)
+{
+    unsigned resourcesHash = StringHasher::hashMemory<sizeof(ShBuiltInResources)>(&resources);
+    unsigned hash = WTF::intHash((static_cast<uint64_t>(source.impl() ? source.impl()->hash() : 0) << 32) | resourcesHash);
+    hash = WTF::intHash((static_cast<uint64_t>(hash) << 32) | static_cast<unsigned>(type));
+    // 0 and -1 are reserved as empty and deleted values in the HashMap
+    if (!hash || hash == static_cast<unsigned>(-1))
+        hash = 1;
+    return hash;
+}
+
+bool GraphicsContext3DShaderCache::lookup(ANGLEShaderType type, const String& source,
+                                          const ShBuiltInResources& resources,
+                                          String& log, bool& isValid)
+{
+    Entry* entry = m_entries.get(computeHash(type, source, resources));
+    if (!entry || entry->type != type || entry->source != source
+        || memcmp(&entry->resources, &resources, sizeof(ShBuiltInResources))) {
+        // On a hash collision store() replaces the entry
+        m_misses++;
+        return false;
+    }
+
+    log = entry->log;
+    isValid = entry->isValid;
+    m_hits++;
+    LOGWEBGL("GraphicsContext3DShaderCache: hit, %u hits, %u misses", m_hits, m_misses);
+    return true;
+}
+
+void GraphicsContext3DShaderCache::store(ANGLEShaderType type, const String& source,
+                                         const ShBuiltInResources& resources,
+                                         const String& log, bool isValid)
+{
+    size_t size = sizeof(Entry) + (source.length() + log.length()) * sizeof(UChar);
+
+    Entry entry;
+    entry.type = type;
+    entry.source = source;
+    entry.resources = resources;
+    entry.log = log;
+    entry.isValid = isValid;
+    m_entries.set(computeHash(type, source, resources), entry, size);
+    LOGWEBGL("GraphicsContext3DShaderCache: stored %u bytes, %u entries, %u bytes total",
+             size, m_entries.size(), m_entries.bytes());
+}
+
+void GraphicsContext3DShaderCache::clear()
+{
+    LOGWEBGL("GraphicsContext3DShaderCache::clear(), %u entries, %u bytes", m_entries.size(), m_entries.bytes());
+    m_entries.clear();
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(WEBGL)
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GraphicsContext3DShaderCache_h
+#define GraphicsContext3DShaderCache_h
+
+#if ENABLE(WEBGL)
+
+#include "ANGLEWebKitBridge.h"
+#include "GraphicsContext3DLRUCache.h"
+#include "PlatformString.h"
+
+namespace WebCore {
+
+// Process-wide cache of ANGLE validation results, so that compiling a
+// shader source that has been seen before, in any context, skips the
+// ANGLE parse. The shader source itself is what is sent to GL, so only the
+// validation log and result are kept. Entries are looked up by a hash of the shader type, the
+// source and the ANGLE resources, verified against the full key, and
+// evicted least recently used first once the byte budget is exceeded.
+// Only used from the WebCore thread.
+class GraphicsContext3DShaderCache {
+public:
+    static GraphicsContext3DShaderCache* instance();
+
+    bool lookup(ANGLEShaderType type, const String& source, const ShBuiltInResources& resources,
+                String& log, bool& isValid);
+    void store(ANGLEShaderType type, const String& source, const ShBuiltInResources& resources,
+               const String& log, bool isValid);
+
+    // Drops all entries, called when the system is low on memory.
+    void clear();
+
+private:
+    GraphicsContext3DShaderCache();
+    static void createInstance();
+
+    struct Entry {
+        ANGLEShaderType type;
+        String source;
+        ShBuiltInResources resources;
+        String log;
+        bool isValid;
+    };
+
+    static unsigned computeHash(ANGLEShaderType type, const String& source, const ShBuiltInResources& resources);
+
+    GraphicsContext3DLRUCache<unsigned, Entry> m_entries;
+    unsigned m_hits;
+    unsigned m_misses;
+};
+
+} // namespace WebCore
+
+#endif // ENABLE(WEBGL)
+#endif // GraphicsContext3DShaderCache_h
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include "GraphicsContext3DSyncService.h"
+
+#if ENABLE(WEBGL)
+
+#include "GraphicsContext3DInternal.h"
+
+#include <pthread.h>
+
+namespace WebCore {
+
+static GraphicsContext3DSyncService* gSyncService = 0;
+static pthread_once_t gSyncServiceOnce = PTHREAD_ONCE_INIT;
+
+void GraphicsContext3DSyncService::createInstance()
+{
+    gSyncService = new GraphicsContext3DSyncService();
+}
+
+// Contexts are created on the WebCore thread and torn down from the GL
+// threads, so the first call can come from either.
+GraphicsContext3DSyncService* GraphicsContext3DSyncService::instance()
+{
+    pthread_once(&gSyncServiceOnce, createInstance);
+    return gSyncService;
+}
+
+GraphicsContext3DSyncService::GraphicsContext3DSyncService()
+    : m_idleWorkers(0)
+{
+}
+
+void GraphicsContext3DSyncService::queueBuffer(GraphicsContext3DInternal* context)
+{
+    MutexLocker lock(m_mutex);
+    m_pending.append(context);
+
+    // Workers are started on demand and then live for the rest of the process
+    if (!m_idleWorkers && m_workers.size() < s_maxWorkers) {
+        ThreadIdentifier worker = createThread(workerStart, this, "GraphicsContext3DSync");
+        if (worker)
+            m_workers.append(worker);
+    }
+    m_condition.broadcast();
+}
+
+void GraphicsContext3DSyncService::cancel(GraphicsContext3DInternal* context)
+{
+    LOGWEBGL("+GraphicsContext3DSyncService::cancel(%p)", context);
+    MutexLocker lock(m_mutex);
+    Deque<GraphicsContext3DInternal*> remaining;
+    while (!m_pending.isEmpty()) {
+        GraphicsContext3DInternal* pending = m_pending.takeFirst();
+        if (pending != context)
+            remaining.append(pending);
+    }
+    m_pending.swap(remaining);
+    while (m_active.contains(context))
+        m_condition.wait(m_mutex);
+    LOGWEBGL("-GraphicsContext3DSyncService::cancel(%p)", context);
+}
+
+GraphicsContext3DInternal* GraphicsContext3DSyncService::takeNext()
+{
+    // Skip contexts that another worker is busy with so that the buffers
+    // of a context are prepared in the order they were swapped.
+    Deque<GraphicsContext3DInternal*>::iterator end = m_pending.end();
+    for (Deque<GraphicsContext3DInternal*>::iterator it = m_pending.begin(); it != end; ++it) {
+        GraphicsContext3DInternal* context = *it;
+        if (!m_active.contains(context)) {
+            m_pending.remove(it);
+            return context;
+        }
+    }
+    return 0;
+}
+
+void* GraphicsContext3DSyncService::workerStart(void* self)
+{
+    static_cast<GraphicsContext3DSyncService*>(self)->runWorker();
+    return 0;
+}
+
+void GraphicsContext3DSyncService::runWorker()
+{
+    LOGWEBGL("GraphicsContext3DSync: starting");
+    MutexLocker lock(m_mutex);
+    while (true) {
+        GraphicsContext3DInternal* context = takeNext();
+        if (!context) {
+            m_idleWorkers++;
+            m_condition.wait(m_mutex);
+            m_idleWorkers--;
+            continue;
+        }
+
+        m_active.add(context);
+        m_mutex.unlock();
+        context->prepareQueuedBuffer();
+        m_mutex.lock();
+        m_active.remove(context);
+        // Wakes up cancel() as well as workers skipping this context
+        m_condition.broadcast();
+    }
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(WEBGL)
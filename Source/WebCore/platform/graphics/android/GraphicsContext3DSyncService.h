@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GraphicsContext3DSyncService_h
+#define GraphicsContext3DSyncService_h
+
+#if ENABLE(WEBGL)
+
+#include "Threading.h"
+
+#include <wtf/Deque.h>
+#include <wtf/HashCountedSet.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class GraphicsContext3DInternal;
+
+// Process-wide service that waits for the fences of swapped FBOs and hands
+// them to the compositor. All WebGL contexts share a small, bounded set of
+// worker threads instead of running one sync thread each.
+class GraphicsContext3DSyncService {
+public:
+    static GraphicsContext3DSyncService* instance();
+
+    // Called once for every FBO the context appends to its queue of
+    // swapped buffers. The buffers of one context are always processed
+    // in order, by one worker at a time.
+    void queueBuffer(GraphicsContext3DInternal* context);
+
+    // Drops the context's pending work and waits until no worker is
+    // processing it anymore. Buffers still queued on the context are left
+    // for the caller to dispose of.
+    void cancel(GraphicsContext3DInternal* context);
+
+private:
+    GraphicsContext3DSyncService();
+    static void createInstance();
+
+    static void* workerStart(void* self);
+    void runWorker();
+    // Must hold m_mutex when calling this function.
+    GraphicsContext3DInternal* takeNext();
+
+    static const unsigned s_maxWorkers = 2;
+
+    Deque<GraphicsContext3DInternal*> m_pending;
+    HashCountedSet<GraphicsContext3DInternal*> m_active;
+    Vector<ThreadIdentifier> m_workers;
+    unsigned m_idleWorkers;
+    WTF::Mutex m_mutex;
+    WTF::ThreadCondition m_condition;
+};
+
+} // namespace WebCore
+
+#endif // ENABLE(WEBGL)
+#endif // GraphicsContext3DSyncService_h
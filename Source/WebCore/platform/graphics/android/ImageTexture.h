@@ -55,6 +55,9 @@ class TiledTexture;
 // Simply comparing the address is not enough -- different image could end up
 // at the same address (i.e. the image is deallocated then a new one is
 // reallocated at the old address)
+// ImagesManager remembers the CRC of the bitmaps it has seen by the
+// generation ID of their pixels, which unlike the address is never reused,
+// so that the copy and CRC are only done for new pixels.
 //
 // Each ImageTexture's CRC being unique, LayerAndroid instances simply store that
 // and retain/release the corresponding ImageTexture (so that
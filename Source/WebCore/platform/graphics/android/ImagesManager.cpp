@@ -52,6 +52,9 @@
 
 namespace WebCore {
 
+// Unused images kept around for layers setting them again
+#define UNUSED_IMAGES_BYTE_BUDGET (4 * 1024 * 1024)
+
 ImagesManager* ImagesManager::instance()
 {
     if (!gInstance)
@@ -62,6 +65,38 @@ ImagesManager* ImagesManager::instance()
 
 ImagesManager* ImagesManager::gInstance = 0;
 
+ImagesManager::ImagesManager()
+    : m_unusedImagesBytes(0)
+    , m_unusedImagesByteBudget(UNUSED_IMAGES_BYTE_BUDGET)
+{
+}
+
+void ImagesManager::identify(const SkBitmap* bitmap, BitmapIdentity& identity)
+{
+    identity.generationID = bitmap->getGenerationID();
+    identity.pixelRefOffset = bitmap->pixelRefOffset();
+    identity.width = bitmap->width();
+    identity.height = bitmap->height();
+    identity.rowBytes = bitmap->rowBytes();
+    identity.config = bitmap->config();
+    identity.crc = 0;
+}
+
+bool ImagesManager::sameBitmap(const BitmapIdentity& a, const BitmapIdentity& b)
+{
+    return a.generationID == b.generationID
+        && a.pixelRefOffset == b.pixelRefOffset
+        && a.width == b.width
+        && a.height == b.height
+        && a.rowBytes == b.rowBytes
+        && a.config == b.config;
+}
+
+size_t ImagesManager::imageBytes(ImageTexture* image)
+{
+    return image->bitmap() ? image->bitmap()->getSize() : 0;
+}
+
 ImageTexture* ImagesManager::setImage(SkBitmapRef* imgRef)
 {
     if (!imgRef)
@@ -72,14 +107,34 @@ ImageTexture* ImagesManager::setImage(SkBitmapRef* imgRef)
     SkBitmap* img = 0;
     unsigned crc = 0;
 
+    // A bitmap without pixels has a generation ID of 0
+    BitmapIdentity identity;
+    identify(bitmap, identity);
+
+    if (identity.generationID) {
+        android::Mutex::Autolock lock(m_imagesLock);
+        HashMap<uint32_t, BitmapIdentity>::iterator it = m_identities.find(identity.generationID);
+        if (it != m_identities.end() && sameBitmap(it->second, identity)) {
+            image = useImage(it->second.crc);
+            if (image)
+                return image;
+        }
+    }
+
     img = ImageTexture::convertBitmap(bitmap);
     crc = ImageTexture::computeCRC(img);
 
     {
         android::Mutex::Autolock lock(m_imagesLock);
-        if (m_images.contains(crc)) {
-            image = m_images.get(crc);
-            SkSafeRef(image);
+        if (identity.generationID) {
+            identity.crc = crc;
+            m_identities.set(identity.generationID, identity);
+            pruneIdentities();
+        }
+
+        image = useImage(crc);
+        if (image) {
+            delete img;
             return image;
         }
     }
@@ -89,6 +144,14 @@ ImageTexture* ImagesManager::setImage(SkBitmapRef* imgRef)
     image = new ImageTexture(img, crc);
 
     android::Mutex::Autolock lock(m_imagesLock);
+    ImageTexture* existing = useImage(crc);
+    if (existing) {
+        // added by another thread meanwhile
+        SkSafeUnref(image);
+        return existing;
+    }
+    // one reference for the caller, one for the map
+    image->ref();
     m_images.set(crc, image);
 
     return image;
@@ -100,12 +163,7 @@ ImageTexture* ImagesManager::retainImage(unsigned imgCRC)
         return 0;
 
     android::Mutex::Autolock lock(m_imagesLock);
-    ImageTexture* image = 0;
-    if (m_images.contains(imgCRC)) {
-        image = m_images.get(imgCRC);
-        SkSafeRef(image);
-    }
-    return image;
+    return useImage(imgCRC);
 }
 
 void ImagesManager::releaseImage(unsigned imgCRC)
@@ -114,12 +172,75 @@ void ImagesManager::releaseImage(unsigned imgCRC)
         return;
 
     android::Mutex::Autolock lock(m_imagesLock);
-    if (m_images.contains(imgCRC)) {
-        ImageTexture* image = m_images.get(imgCRC);
-        if (image->getRefCnt() == 1)
-            m_images.remove(imgCRC);
+    ImageTexture* image = m_images.get(imgCRC);
+    if (!image || m_unusedImages.contains(imgCRC))
+        return;
+
+    image->unref();
+    if (image->getRefCnt() == 1) {
+        // only the map holds it now
+        m_unusedImages.add(imgCRC);
+        m_unusedImagesBytes += imageBytes(image);
+        evictUnusedImages(m_unusedImagesByteBudget);
+    }
+}
+
+ImageTexture* ImagesManager::useImage(unsigned imgCRC)
+{
+    ImageTexture* image = m_images.get(imgCRC);
+    if (!image)
+        return 0;
+
+    if (m_unusedImages.contains(imgCRC)) {
+        m_unusedImages.remove(imgCRC);
+        m_unusedImagesBytes -= imageBytes(image);
+    }
+    image->ref();
+    return image;
+}
+
+void ImagesManager::evictUnusedImages(size_t budget)
+{
+    while (m_unusedImagesBytes > budget && !m_unusedImages.isEmpty()) {
+        unsigned crc = m_unusedImages.first();
+        m_unusedImages.remove(crc);
+        ImageTexture* image = m_images.take(crc);
+        m_unusedImagesBytes -= imageBytes(image);
+        XLOG("evicting unused image %x, %d bytes of unused images left",
+             crc, m_unusedImagesBytes);
         SkSafeUnref(image);
     }
+    pruneIdentities();
+}
+
+void ImagesManager::pruneIdentities()
+{
+    // identities of evicted images are only dropped once they would
+    // outnumber the images, to keep this amortized
+    if (m_identities.size() <= 2 * m_images.size() + 16)
+        return;
+
+    Vector<uint32_t> staleIdentities;
+    HashMap<uint32_t, BitmapIdentity>::iterator end = m_identities.end();
+    for (HashMap<uint32_t, BitmapIdentity>::iterator it = m_identities.begin(); it != end; ++it) {
+        if (!m_images.contains(it->second.crc))
+            staleIdentities.append(it->first);
+    }
+    for (unsigned int i = 0; i < staleIdentities.size(); i++)
+        m_identities.remove(staleIdentities[i]);
+}
+
+void ImagesManager::setUnusedImagesByteBudget(size_t bytes)
+{
+    android::Mutex::Autolock lock(m_imagesLock);
+    m_unusedImagesByteBudget = bytes;
+    evictUnusedImages(m_unusedImagesByteBudget);
+}
+
+void ImagesManager::releaseUnusedImages()
+{
+    android::Mutex::Autolock lock(m_imagesLock);
+    evictUnusedImages(0);
 }
 
 int ImagesManager::nbTextures()
@@ -129,6 +250,8 @@ int ImagesManager::nbTextures()
     int i = 0;
     int nb = 0;
     for (HashMap<unsigned, ImageTexture*>::iterator it = m_images.begin(); it != end; ++it) {
+        if (m_unusedImages.contains(it->first))
+            continue;
         nb += it->second->nbTextures();
         i++;
     }
@@ -141,9 +264,19 @@ bool ImagesManager::prepareTextures(GLWebViewState* state)
     android::Mutex::Autolock lock(m_imagesLock);
     HashMap<unsigned, ImageTexture*>::iterator end = m_images.end();
     for (HashMap<unsigned, ImageTexture*>::iterator it = m_images.begin(); it != end; ++it) {
+        if (m_unusedImages.contains(it->first))
+            continue;
         ret |= it->second->prepareGL(state);
     }
     return ret;
 }
 
+void ImagesManager::showImages()
+{
+    android::Mutex::Autolock lock(m_imagesLock);
+    XLOGC("%d images (%d unused, %d bytes out of %d), %d bitmap identities",
+          m_images.size(), m_unusedImages.size(), m_unusedImagesBytes,
+          m_unusedImagesByteBudget, m_identities.size());
+}
+
 } // namespace WebCore
@@ -27,6 +27,7 @@
 #define ImagesManager_h
 
 #include "HashMap.h"
+#include "ListHashSet.h"
 #include "SkBitmap.h"
 #include "SkBitmapRef.h"
 #include "SkRefCnt.h"
@@ -48,13 +49,48 @@ public:
     bool prepareTextures(GLWebViewState*);
     int nbTextures();
 
+    // Images no layer uses anymore are kept around, so that setting them
+    // again is cheap, as long as they fit in this budget.
+    void setUnusedImagesByteBudget(size_t bytes);
+    // Called on memory pressure
+    void releaseUnusedImages();
+
+    void showImages();
+
 private:
-    ImagesManager() {}
+    ImagesManager();
+
+    // What identifies the pixels of a bitmap, and the CRC they had.
+    struct BitmapIdentity {
+        uint32_t generationID;
+        size_t pixelRefOffset;
+        int width;
+        int height;
+        size_t rowBytes;
+        SkBitmap::Config config;
+        unsigned crc;
+    };
+
+    static void identify(const SkBitmap* bitmap, BitmapIdentity& identity);
+    static bool sameBitmap(const BitmapIdentity& a, const BitmapIdentity& b);
+    static size_t imageBytes(ImageTexture* image);
+
+    // All the following must be called with m_imagesLock held
+    ImageTexture* useImage(unsigned imgCRC);
+    void evictUnusedImages(size_t budget);
+    void pruneIdentities();
 
     static ImagesManager* gInstance;
 
     android::Mutex m_imagesLock;
+    // The map holds a reference to each image, on top of the layers'
     HashMap<unsigned, ImageTexture*> m_images;
+    HashMap<uint32_t, BitmapIdentity> m_identities;
+
+    // Images only referenced by the map, least recently used first
+    ListHashSet<unsigned> m_unusedImages;
+    size_t m_unusedImagesBytes;
+    size_t m_unusedImagesByteBudget;
 };
 
 } // namespace WebCore
@@ -2,6 +2,8 @@
 #include "Layer.h"
 #include "SkCanvas.h"
 
+#include <cutils/atomic.h>
+
 //#define DEBUG_DRAW_LAYER_BOUNDS
 //#define DEBUG_TRACK_NEW_DELETE
 
@@ -9,6 +11,13 @@
     static int gLayerAllocCount;
 #endif
 
+// Layers are changed from both the WebKit and the UI thread
+static int32_t gLayerGeneration;
+
+static int32_t nextGeneration() {
+    return android_atomic_inc(&gLayerGeneration) + 1;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 Layer::Layer() {
@@ -25,6 +34,10 @@ Layer::Layer() {
     m_hasOverflowChildren = false;
     m_state = 0;
 
+    m_propertiesGeneration = 0;
+    m_subtreeGeneration = 0;
+    m_contentGeneration = 0;
+
 #ifdef DEBUG_TRACK_NEW_DELETE
     gLayerAllocCount += 1;
     SkDebugf("Layer new:    %d\n", gLayerAllocCount);
@@ -45,6 +58,10 @@ Layer::Layer(const Layer& src) : INHERITED() {
     m_hasOverflowChildren = src.m_hasOverflowChildren;
     m_state = 0;
 
+    m_propertiesGeneration = 0;
+    m_subtreeGeneration = 0;
+    m_contentGeneration = 0;
+
 #ifdef DEBUG_TRACK_NEW_DELETE
     gLayerAllocCount += 1;
     SkDebugf("Layer copy:   %d\n", gLayerAllocCount);
@@ -82,11 +99,13 @@ Layer* Layer::addChild(Layer* child) {
     child->fParent = this;
 
     *m_children.append() = child;
+    subtreeChanged();
     return child;
 }
 
 void Layer::detachFromParent() {
     if (fParent) {
+        fParent->subtreeChanged();
         int index = fParent->m_children.find(this);
         SkASSERT(index >= 0);
         fParent->m_children.remove(index);
@@ -97,6 +116,8 @@ void Layer::detachFromParent() {
 
 void Layer::removeChildren() {
     int count = m_children.count();
+    if (count)
+        subtreeChanged();
     for (int i = 0; i < count; i++) {
         Layer* child = m_children[i];
         SkASSERT(child->fParent == this);
@@ -106,6 +127,25 @@ void Layer::removeChildren() {
     m_children.reset();
 }
 
+void Layer::subtreeChanged() {
+    contentChanged();
+    for (Layer* layer = this; layer; layer = layer->fParent)
+        layer->onSubtreeChanged();
+}
+
+void Layer::propertiesChanged() {
+    int32_t generation = nextGeneration();
+    m_propertiesGeneration = generation;
+    for (Layer* layer = this; layer; layer = layer->fParent)
+        layer->m_subtreeGeneration = generation;
+}
+
+void Layer::contentChanged() {
+    int32_t generation = nextGeneration();
+    for (Layer* layer = this; layer; layer = layer->fParent)
+        layer->m_contentGeneration = generation;
+}
+
 Layer* Layer::getRootLayer() const {
     const Layer* root = this;
     while (root->fParent != NULL) {
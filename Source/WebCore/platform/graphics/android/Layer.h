@@ -55,13 +55,27 @@ public:
     SkScalar getWidth() const { return m_size.width(); }
     SkScalar getHeight() const { return m_size.height(); }
 
-    void setShouldInheritFromRootTransform(bool inherit) { m_shouldInheritFromRootTransform = inherit; }
-    void setOpacity(SkScalar opacity) { m_opacity = opacity; }
-    void setSize(SkScalar w, SkScalar h) { m_size.set(w, h); }
-    void setPosition(SkScalar x, SkScalar y) { m_position.set(x, y); }
-    void setAnchorPoint(SkScalar x, SkScalar y) { m_anchorPoint.set(x, y); }
-    void setMatrix(const SkMatrix& matrix) { m_matrix = matrix; }
-    void setChildrenMatrix(const SkMatrix& matrix) { m_childrenMatrix = matrix; }
+    void setShouldInheritFromRootTransform(bool inherit) { m_shouldInheritFromRootTransform = inherit; contentChanged(); }
+    void setOpacity(SkScalar opacity) { m_opacity = opacity; propertiesChanged(); }
+    void setSize(SkScalar w, SkScalar h) { m_size.set(w, h); propertiesChanged(); }
+    void setPosition(SkScalar x, SkScalar y) { m_position.set(x, y); propertiesChanged(); }
+    void setAnchorPoint(SkScalar x, SkScalar y) { m_anchorPoint.set(x, y); propertiesChanged(); }
+    void setMatrix(const SkMatrix& matrix) { m_matrix = matrix; contentChanged(); }
+    void setChildrenMatrix(const SkMatrix& matrix) { m_childrenMatrix = matrix; contentChanged(); }
+
+// change tracking
+
+    // Every change to a layer is stamped with a global, increasing
+    // generation. The stamps let LayerAndroid::updateWithTree() visit only
+    // the subtrees that changed since a copy of the tree was made.
+
+    // last change to one of the basic properties (position, size, ...)
+    int32_t propertiesGeneration() const { return m_propertiesGeneration; }
+    // last change to the basic properties of this layer or a descendant
+    int32_t subtreeGeneration() const { return m_subtreeGeneration; }
+    // last change of this layer or a descendant that is not a basic
+    // property: structure, content, invalidations, ...
+    int32_t contentGeneration() const { return m_contentGeneration; }
 
 // rendering asset management
 
@@ -79,6 +93,7 @@ public:
 
     void markAsDirty(const SkRegion& invalRegion) {
         m_dirtyRegion.op(invalRegion, SkRegion::kUnion_Op);
+        contentChanged();
     }
 
     bool isDirty() {
@@ -170,13 +185,23 @@ public:
         this->draw(canvas, SK_Scalar1);
     }
 
-    void setHasOverflowChildren(bool value) { m_hasOverflowChildren = value; }
+    void setHasOverflowChildren(bool value) { m_hasOverflowChildren = value; contentChanged(); }
 
     virtual bool contentIsScrollable() const { return false; }
 
 protected:
     virtual void onDraw(SkCanvas*, SkScalar opacity);
 
+    /** Called on a layer and on all of its ancestors when a layer is added
+        to or removed from its subtree.
+     */
+    virtual void onSubtreeChanged() {}
+
+    // Stamp a change of this layer, see propertiesGeneration() and
+    // contentGeneration().
+    void propertiesChanged();
+    void contentChanged();
+
     bool m_hasOverflowChildren;
 
     bool isAncestor(const Layer*) const;
@@ -195,6 +220,12 @@ protected:
 
     SkTDArray<Layer*> m_children;
 
+    int32_t m_propertiesGeneration;
+    int32_t m_subtreeGeneration;
+    int32_t m_contentGeneration;
+
+    void subtreeChanged();
+
     // invalidation region
     SkRegion m_dirtyRegion;
 
@@ -148,6 +148,7 @@ LayerAndroid::LayerAndroid(RenderLayer* owner) : Layer(),
     m_anchorPointZ(0),
     m_recordingPicture(0),
     m_uniqueId(++gUniqueId),
+    m_syncedGeneration(0),
     m_texture(0),
     m_imageCRC(0),
     m_pictureUsed(0),
@@ -172,6 +173,9 @@ LayerAndroid::LayerAndroid(const LayerAndroid& layer) : Layer(layer),
     m_haveClip(layer.m_haveClip),
     m_isIframe(layer.m_isIframe),
     m_uniqueId(layer.m_uniqueId),
+    m_syncedGeneration(layer.m_type == WebCoreLayer
+                       ? std::max(layer.subtreeGeneration(), layer.contentGeneration())
+                       : layer.m_syncedGeneration),
     m_texture(0),
     m_owningLayer(layer.m_owningLayer),
     m_type(LayerAndroid::UILayer),
@@ -238,6 +242,7 @@ void LayerAndroid::checkTextPresence()
                          m_recordingPicture->width(),
                          m_recordingPicture->height());
         checker.setBitmapDevice(bitmap);
+        android::Mutex::Autolock lock(TilesManager::pictureLock(m_recordingPicture));
         checker.drawPicture(*m_recordingPicture);
         m_hasText = checker.hasText();
     }
@@ -249,6 +254,7 @@ LayerAndroid::LayerAndroid(SkPicture* picture) : Layer(),
     m_isIframe(false),
     m_recordingPicture(picture),
     m_uniqueId(++gUniqueId),
+    m_syncedGeneration(0),
     m_texture(0),
     m_imageCRC(0),
     m_scale(1),
@@ -354,6 +360,7 @@ void LayerAndroid::addAnimation(PassRefPtr<AndroidAnimation> prpAnim)
     pair<String, int> key(anim->name(), anim->type());
     removeAnimationsForProperty(anim->type());
     m_animations.add(key, anim);
+    contentChanged();
 }
 
 void LayerAndroid::removeAnimationsForProperty(AnimatedPropertyID property)
@@ -367,6 +374,7 @@ void LayerAndroid::removeAnimationsForProperty(AnimatedPropertyID property)
 
     for (unsigned int i = 0; i < toDelete.size(); i++)
         m_animations.remove(toDelete[i]);
+    contentChanged();
 }
 
 void LayerAndroid::removeAnimationsForKeyframes(const String& name)
@@ -380,6 +388,7 @@ void LayerAndroid::removeAnimationsForKeyframes(const String& name)
 
     for (unsigned int i = 0; i < toDelete.size(); i++)
         m_animations.remove(toDelete[i]);
+    contentChanged();
 }
 
 // We only use the bounding rect of the layer as mask...
@@ -388,11 +397,13 @@ void LayerAndroid::setMaskLayer(LayerAndroid* layer)
 {
     if (layer)
         m_haveClip = true;
+    contentChanged();
 }
 
 void LayerAndroid::setBackgroundColor(SkColor color)
 {
     m_backgroundColor = color;
+    contentChanged();
 }
 
 static int gDebugChildLevel;
@@ -773,6 +784,7 @@ void LayerAndroid::setContentsImage(SkBitmapRef* img)
     ImageTexture* image = ImagesManager::instance()->setImage(img);
     ImagesManager::instance()->releaseImage(m_imageCRC);
     m_imageCRC = image ? image->imageCRC() : 0;
+    contentChanged();
 }
 
 bool LayerAndroid::needsTexture()
@@ -931,21 +943,39 @@ bool LayerAndroid::isReady()
 
 bool LayerAndroid::updateWithTree(LayerAndroid* newTree)
 {
-// Disable fast update for now
-#if (0)
-    bool needsRepaint = false;
-    int count = this->countChildren();
-    for (int i = 0; i < count; i++)
-        needsRepaint |= this->getChild(i)->updateWithTree(newTree);
+    // Anything but a change of the basic properties (a new layer, a
+    // repaint...) since we were copied needs a full update
+    if (!newTree || newTree->uniqueId() != uniqueId()
+        || newTree->contentGeneration() > m_syncedGeneration)
+        return true;
+
+    if (updateWithSubtree(newTree, m_syncedGeneration))
+        return true;
+
+    m_syncedGeneration = std::max(m_syncedGeneration, newTree->subtreeGeneration());
+    return false;
+}
+
+// Walk the subtrees of newLayer changed after syncedGeneration and update
+// the matching layers of this tree
+bool LayerAndroid::updateWithSubtree(LayerAndroid* newLayer, int32_t syncedGeneration)
+{
+    if (newLayer->subtreeGeneration() <= syncedGeneration)
+        return false;
 
-    if (newTree) {
-        LayerAndroid* newLayer = newTree->findById(uniqueId());
-        needsRepaint |= updateWithLayer(newLayer);
+    if (newLayer->propertiesGeneration() > syncedGeneration) {
+        LayerAndroid* layer = findById(newLayer->uniqueId());
+        if (!layer || layer->updateWithLayer(newLayer))
+            return true;
     }
-    return needsRepaint;
-#else
-    return true;
-#endif
+
+    int count = newLayer->countChildren();
+    for (int i = 0; i < count; i++) {
+        LayerAndroid* child = static_cast<LayerAndroid*>(newLayer->getChild(i));
+        if (updateWithSubtree(child, syncedGeneration))
+            return true;
+    }
+    return false;
 }
 
 // Return true to indicate to WebViewCore that the updates
@@ -1181,8 +1211,10 @@ bool LayerAndroid::drawChildrenGL()
 
 void LayerAndroid::contentDraw(SkCanvas* canvas)
 {
-    if (m_recordingPicture)
-      canvas->drawPicture(*m_recordingPicture);
+    if (m_recordingPicture) {
+        android::Mutex::Autolock lock(TilesManager::pictureLock(m_recordingPicture));
+        canvas->drawPicture(*m_recordingPicture);
+    }
 
     if (TilesManager::instance()->getShowVisualIndicator()) {
         float w = getSize().width();
@@ -1459,16 +1491,25 @@ void LayerAndroid::dumpToLog() const
     fclose(file);
 }
 
+void LayerAndroid::indexLayers(HashMap<int, LayerAndroid*>& index)
+{
+    // add() keeps the first layer found in depth-first order, as the
+    // recursive search used to
+    index.add(m_uniqueId, this);
+    for (int i = 0; i < countChildren(); i++)
+        getChild(i)->indexLayers(index);
+}
+
 LayerAndroid* LayerAndroid::findById(int match)
 {
     if (m_uniqueId == match)
         return this;
-    for (int i = 0; i < countChildren(); i++) {
-        LayerAndroid* result = getChild(i)->findById(match);
-        if (result)
-            return result;
-    }
-    return 0;
+    // ids are allocated from 1, and callers use -1 for "no layer"
+    if (match <= 0 || !countChildren())
+        return 0;
+    if (m_layersById.isEmpty())
+        indexLayers(m_layersById);
+    return m_layersById.get(match);
 }
 
 } // namespace WebCore
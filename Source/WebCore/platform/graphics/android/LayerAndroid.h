@@ -124,8 +124,8 @@ public:
 
     virtual TiledPage* page() { return 0; }
 
-    void setBackfaceVisibility(bool value) { m_backfaceVisibility = value; }
-    void setTransform(const TransformationMatrix& matrix) { m_transform = matrix; }
+    void setBackfaceVisibility(bool value) { m_backfaceVisibility = value; contentChanged(); }
+    void setTransform(const TransformationMatrix& matrix) { m_transform = matrix; propertiesChanged(); }
     FloatPoint translation() const;
     // Returns a rect describing the bounds of the layer with the local
     // transformation applied, expressed relative to the parent layer.
@@ -163,15 +163,15 @@ public:
                                    const FloatRect& clip, float opacity, float scale);
     void setDrawOpacity(float opacity) { m_drawOpacity = opacity; }
     float drawOpacity() { return m_drawOpacity; }
-    void setVisible(bool value) { m_visible = value; }
+    void setVisible(bool value) { m_visible = value; contentChanged(); }
 
     bool preserves3D() { return m_preserves3D; }
-    void setPreserves3D(bool value) { m_preserves3D = value; }
-    void setAnchorPointZ(float z) { m_anchorPointZ = z; }
+    void setPreserves3D(bool value) { m_preserves3D = value; contentChanged(); }
+    void setAnchorPointZ(float z) { m_anchorPointZ = z; contentChanged(); }
     float anchorPointZ() { return m_anchorPointZ; }
     void setDrawTransform(const TransformationMatrix& transform) { m_drawTransform = transform; }
     const TransformationMatrix* drawTransform() const { return &m_drawTransform; }
-    void setChildrenTransform(const TransformationMatrix& t) { m_childrenTransform = t; }
+    void setChildrenTransform(const TransformationMatrix& t) { m_childrenTransform = t; contentChanged(); }
     void setDrawClip(const FloatRect& rect) { m_clippingRect = rect; }
     const FloatRect& drawClip() { return m_clippingRect; }
 
@@ -204,6 +204,7 @@ public:
     void setMasksToBounds(bool masksToBounds)
     {
         m_haveClip = masksToBounds;
+        contentChanged();
     }
     bool masksToBounds() const { return m_haveClip; }
 
@@ -250,6 +251,8 @@ public:
     {
         return const_cast<LayerAndroid*>(this)->findById(uniqueID);
     }
+    // Lookups use an index of the subtree, built on the first call and
+    // dropped whenever a layer is added to or removed from the subtree.
     LayerAndroid* findById(int uniqueID);
     LayerAndroid* getChild(int index) const
     {
@@ -282,7 +285,7 @@ public:
 
     RenderLayer* owningLayer() const { return m_owningLayer; }
 
-    void setIsIframe(bool isIframe) { m_isIframe = isIframe; }
+    void setIsIframe(bool isIframe) { m_isIframe = isIframe; contentChanged(); }
     float zValue() const { return m_zValue; }
 
     // ViewStateSerializer friends
@@ -293,9 +296,10 @@ public:
     PaintedSurface* texture() { return m_texture; }
     void obtainTextureForPainting(LayerAndroid* drawingLayer);
 
-    // Update layers using another tree. Only works for basic properties
-    // such as the position, the transform. Return true if anything more
-    // complex is needed.
+    // Update layers using a newer copy of the tree this one was copied
+    // from. Only the subtrees changed since then are visited, and only basic
+    // properties such as the position, the transform can be updated. Return
+    // true if anything more complex is needed.
     bool updateWithTree(LayerAndroid*);
     virtual bool updateWithLayer(LayerAndroid*);
 
@@ -315,6 +319,7 @@ public:
 
 protected:
     virtual void onDraw(SkCanvas*, SkScalar opacity);
+    virtual void onSubtreeChanged() { m_layersById.clear(); }
 
     TransformationMatrix m_drawTransform;
 
@@ -325,6 +330,8 @@ private:
 #endif
 
     void copyAnimationStartTimes(LayerAndroid* oldLayer);
+    bool updateWithSubtree(LayerAndroid* newLayer, int32_t syncedGeneration);
+    void indexLayers(HashMap<int, LayerAndroid*>& index);
     void findInner(FindState&) const;
     bool prepareContext(bool force = false);
     void clipInner(SkTDArray<SkRect>* region, const SkRect& local) const;
@@ -387,6 +394,13 @@ private:
 
     int m_uniqueId;
 
+    // unique id -> layer of our subtree, empty until findById() needs it
+    HashMap<int, LayerAndroid*> m_layersById;
+
+    // Generation of the WebKit tree this tree is a copy of, see
+    // updateWithTree()
+    int32_t m_syncedGeneration;
+
     PaintedSurface* m_texture;
     unsigned m_imageCRC;
 
@@ -299,6 +299,7 @@ MediaTexture::TextureWrapper* MediaTexture::createTexture()
 
     // populate the wrapper
     glGenTextures(1, &wrapper->textureId);
+    TilesManager::instance()->shader()->forgetTexture(wrapper->textureId);
     wrapper->surfaceTexture = new android::SurfaceTexture(wrapper->textureId);
     wrapper->nativeWindow = new android::SurfaceTextureClient(wrapper->surfaceTexture);
     wrapper->dimensions.setEmpty();
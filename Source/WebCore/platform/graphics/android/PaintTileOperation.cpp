@@ -29,6 +29,9 @@
 #include "ImagesManager.h"
 #include "LayerAndroid.h"
 #include "PaintedSurface.h"
+#include "TilesManager.h"
+#include <math.h>
+#include <wtf/CurrentTime.h>
 
 namespace WebCore {
 
@@ -36,7 +39,10 @@ PaintTileOperation::PaintTileOperation(BaseTile* tile, SurfacePainter* surface)
     : QueuedOperation(QueuedOperation::PaintTile, tile->page())
     , m_tile(tile)
     , m_surface(surface)
+    , m_queuedTime(0)
 {
+    if (TilesManager::instance()->getProfiler()->enabled())
+        m_queuedTime = currentTimeMS();
     if (m_tile)
         m_tile->setRepaintPending(true);
     SkSafeRef(m_surface);
@@ -68,7 +74,20 @@ bool PaintTileOperation::operator==(const QueuedOperation* operation)
 void PaintTileOperation::run()
 {
     if (m_tile) {
+        TilesProfiler* profiler = TilesManager::instance()->getProfiler();
+        double startTime = 0;
+        if (m_queuedTime) {
+            startTime = currentTimeMS();
+            profiler->recordTiming(TilesProfiler::QueueWait,
+                                   (startTime - m_queuedTime) * 1000);
+        }
+
         m_tile->paintBitmap();
+
+        if (startTime) {
+            profiler->recordTiming(TilesProfiler::TilePaint,
+                                   (currentTimeMS() - startTime) * 1000);
+        }
         m_tile->setRepaintPending(false);
         m_tile = 0;
     }
@@ -99,15 +118,28 @@ int PaintTileOperation::priority()
     if (m_tile->frontTexture())
         priority += 50000;
 
-    // for base tiles, prioritize based on position
+    // for base tiles, prioritize based on how soon the viewport is predicted
+    // to reach them, then on position. The viewport tile bounds are at the
+    // viewport's scale, while the prefetch page, or the page painted for a
+    // zoom, has tiles at another scale.
     if (!m_tile->isLayerTile()) {
-        bool goingDown = m_tile->page()->scrollingDown();
-        priority += m_tile->x();
-
-        if (goingDown)
-            priority += 100000 - (1 + m_tile->y()) * 1000;
-        else
-            priority += m_tile->y() * 1000;
+        GLWebViewState* state = page->glWebViewState();
+        float toViewportScale = m_tile->scale() > 0 ? state->scale() / m_tile->scale() : 1;
+        int x = static_cast<int>(floorf(m_tile->x() * toViewportScale));
+        int y = static_cast<int>(floorf(m_tile->y() * toViewportScale));
+        priority += state->tileVisibilityDelay(x, y);
+
+        // order by row, then column, over the tiles a page prepares
+        const SkIRect& bounds = state->viewportTileBounds();
+        int columns = bounds.width() + state->expandedTileBoundsX() * 2;
+        int rows = bounds.height() + state->expandedTileBoundsY() * 2;
+        int column = x - bounds.fLeft + state->expandedTileBoundsX();
+        int row = y - bounds.fTop + state->expandedTileBoundsY();
+        column = std::max(0, std::min(column, columns - 1));
+        row = std::max(0, std::min(row, rows - 1));
+        if (page->scrollingDown())
+            row = rows - 1 - row;
+        priority += row * columns + column;
     }
 
     return priority;
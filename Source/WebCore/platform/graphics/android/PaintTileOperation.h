@@ -46,10 +46,13 @@ public:
     virtual int priority();
     TilePainter* painter() { return m_tile->painter(); }
     float scale() { return m_tile->scale(); }
+    BaseTile* tile() { return m_tile; }
 
 private:
     BaseTile* m_tile;
     SurfacePainter* m_surface;
+    // when the operation was queued, if profiling
+    double m_queuedTime;
 };
 
 class ScaleFilter : public OperationFilter {
@@ -72,6 +75,29 @@ private:
 };
 
 
+// Matches the base tile paints of a page that fall outside of its
+// currently prepared tile bounds
+class TileBoundsFilter : public OperationFilter {
+public:
+    TileBoundsFilter(TiledPage* page, const SkIRect& bounds)
+        : m_page(page)
+        , m_bounds(bounds) {}
+    virtual bool check(QueuedOperation* operation)
+    {
+        if (operation->type() == QueuedOperation::PaintTile) {
+            PaintTileOperation* op = static_cast<PaintTileOperation*>(operation);
+            BaseTile* tile = op->tile();
+            if (tile && !tile->isLayerTile() && tile->page() == m_page
+                && !m_bounds.contains(tile->x(), tile->y()))
+                return true;
+        }
+        return false;
+    }
+private:
+    TiledPage* m_page;
+    SkIRect m_bounds;
+};
+
 class TilePainterFilter : public OperationFilter {
 public:
     TilePainterFilter(TilePainter* painter) : m_painter(painter) {}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "PixelBufferPool.h"
+
+#if USE(ACCELERATED_COMPOSITING)
+
+#include "SkColorTable.h"
+#include "SkPixelRef.h"
+
+#include <cutils/log.h>
+#include <wtf/text/CString.h>
+
+#ifdef DEBUG
+
+#undef XLOG
+#define XLOG(...) android_printLog(ANDROID_LOG_DEBUG, "PixelBufferPool", __VA_ARGS__)
+
+#else
+
+#undef XLOG
+#define XLOG(...)
+
+#endif // DEBUG
+
+// Smaller buffers are cheap enough for malloc, larger ones are too rare to
+// keep around.
+#define MIN_POOLED_SIZE (16 * 1024)
+#define MAX_POOLED_SIZE (4 * 1024 * 1024)
+
+// Idle bytes kept for reuse, 8 tiles of 256x256 in 8888
+#define IDLE_BYTES_BUDGET (2 * 1024 * 1024)
+
+namespace WebCore {
+
+class PooledPixelRef : public SkPixelRef {
+public:
+    PooledPixelRef(void* buffer, size_t size, SkColorTable* colorTable)
+        : m_buffer(buffer)
+        , m_size(size)
+        , m_colorTable(colorTable)
+    {
+        SkSafeRef(m_colorTable);
+    }
+
+    virtual ~PooledPixelRef()
+    {
+        PixelBufferPool::instance()->release(m_buffer, m_size);
+        SkSafeUnref(m_colorTable);
+    }
+
+protected:
+    virtual void* onLockPixels(SkColorTable** colorTable)
+    {
+        *colorTable = m_colorTable;
+        return m_buffer;
+    }
+
+    virtual void onUnlockPixels() {}
+
+private:
+    void* m_buffer;
+    size_t m_size;
+    SkColorTable* m_colorTable;
+};
+
+void PixelBufferPool::createInstance()
+{
+    gInstance = new PixelBufferPool();
+}
+
+// The first calls can come at once from the texture generators, the WebCore
+// thread and the UI thread
+PixelBufferPool* PixelBufferPool::instance()
+{
+    pthread_once(&gInstanceOnce, createInstance);
+    return gInstance;
+}
+
+PixelBufferPool* PixelBufferPool::gInstance = 0;
+pthread_once_t PixelBufferPool::gInstanceOnce = PTHREAD_ONCE_INIT;
+
+PixelBufferPool::PixelBufferPool()
+    : m_idleBytes(0)
+    , m_inUseBytes(0)
+    , m_highWaterBytes(0)
+    , m_reused(0)
+    , m_allocated(0)
+{
+}
+
+size_t PixelBufferPool::sizeClass(size_t size)
+{
+    if (size < MIN_POOLED_SIZE || size > MAX_POOLED_SIZE)
+        return 0;
+
+    // round up to a quarter of the highest power of two below size, this
+    // wastes at most 25%, and tiles fall exactly on a class
+    size_t step = 1;
+    while (step <= size >> 1)
+        step <<= 1;
+    step >>= 2;
+    return (size + step - 1) & ~(step - 1);
+}
+
+void* PixelBufferPool::acquire(size_t allocSize)
+{
+    android::Mutex::Autolock lock(m_lock);
+    void* buffer = 0;
+    HashMap<size_t, Vector<void*> >::iterator it = m_idleBuffers.find(allocSize);
+    if (it != m_idleBuffers.end() && it->second.size()) {
+        buffer = it->second.last();
+        it->second.removeLast();
+        m_idleBytes -= allocSize;
+        m_reused++;
+    } else {
+        buffer = malloc(allocSize);
+        if (!buffer) {
+            XLOG("couldn't allocate %d bytes", allocSize);
+            return 0;
+        }
+        m_allocated++;
+    }
+
+    m_inUseBytes += allocSize;
+    if (m_inUseBytes > m_highWaterBytes)
+        m_highWaterBytes = m_inUseBytes;
+    return buffer;
+}
+
+bool PixelBufferPool::allocPixelRef(SkBitmap* bitmap, SkColorTable* colorTable)
+{
+    Sk64 size = bitmap->getSize64();
+    if (size.isNeg() || !size.is32() || !size.get32())
+        return false;
+
+    size_t allocSize = sizeClass(size.get32());
+    if (!allocSize)
+        allocSize = size.get32();
+
+    void* buffer = acquire(allocSize);
+    if (!buffer)
+        return false;
+
+    bitmap->setPixelRef(new PooledPixelRef(buffer, allocSize, colorTable))->unref();
+    // since we're already allocated, we lockPixels right away
+    bitmap->lockPixels();
+    return true;
+}
+
+void PixelBufferPool::release(void* buffer, size_t size)
+{
+    android::Mutex::Autolock lock(m_lock);
+    m_inUseBytes -= size;
+
+    if (sizeClass(size) != size || m_idleBytes + size > IDLE_BYTES_BUDGET) {
+        free(buffer);
+        return;
+    }
+
+    m_idleBuffers.add(size, Vector<void*>()).first->second.append(buffer);
+    m_idleBytes += size;
+}
+
+void PixelBufferPool::trim()
+{
+    android::Mutex::Autolock lock(m_lock);
+    XLOG("trimming %d idle bytes, high water mark was %d bytes",
+         m_idleBytes, m_highWaterBytes);
+
+    HashMap<size_t, Vector<void*> >::iterator end = m_idleBuffers.end();
+    for (HashMap<size_t, Vector<void*> >::iterator it = m_idleBuffers.begin(); it != end; ++it) {
+        for (unsigned int i = 0; i < it->second.size(); i++)
+            free(it->second[i]);
+    }
+    m_idleBuffers.clear();
+    m_idleBytes = 0;
+    m_highWaterBytes = m_inUseBytes;
+}
+
+void PixelBufferPool::gatherStats(size_t* inUseBytes, size_t* idleBytes,
+                                  size_t* highWaterBytes,
+                                  unsigned int* reused, unsigned int* allocated)
+{
+    android::Mutex::Autolock lock(m_lock);
+    *inUseBytes = m_inUseBytes;
+    *idleBytes = m_idleBytes;
+    *highWaterBytes = m_highWaterBytes;
+    *reused = m_reused;
+    *allocated = m_allocated;
+}
+
+} // namespace WebCore
+
+#endif // USE(ACCELERATED_COMPOSITING)
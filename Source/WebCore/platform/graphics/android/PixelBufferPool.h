@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PixelBufferPool_h
+#define PixelBufferPool_h
+
+#if USE(ACCELERATED_COMPOSITING)
+
+#include "SkBitmap.h"
+#include <pthread.h>
+#include <utils/threads.h>
+#include <wtf/HashMap.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+// Recycles the pixel storage of the bitmaps of the tile pipeline (renderer
+// bitmaps, TransferQueue slots, image copies), so that painting doesn't
+// allocate and free a tile-sized buffer each time. Use it as the allocator of
+// SkBitmap::allocPixels(); the storage goes back to the pool when the pixel
+// ref dies. Buffers are grouped in size classes of a quarter of a power of
+// two, and the idle ones are kept up to a byte budget.
+// Thread safe.
+class PixelBufferPool : public SkBitmap::Allocator {
+public:
+    static PixelBufferPool* instance();
+
+    virtual bool allocPixelRef(SkBitmap* bitmap, SkColorTable* colorTable);
+
+    // Called by the pixel refs when they are destroyed
+    void release(void* buffer, size_t size);
+
+    // Frees all the idle buffers, for memory pressure
+    void trim();
+
+    void gatherStats(size_t* inUseBytes, size_t* idleBytes, size_t* highWaterBytes,
+                     unsigned int* reused, unsigned int* allocated);
+
+private:
+    PixelBufferPool();
+
+    static size_t sizeClass(size_t size);
+    void* acquire(size_t allocSize);
+
+    static void createInstance();
+
+    static PixelBufferPool* gInstance;
+    static pthread_once_t gInstanceOnce;
+
+    android::Mutex m_lock;
+    // size class -> idle buffers of that size
+    HashMap<size_t, Vector<void*> > m_idleBuffers;
+    size_t m_idleBytes;
+    size_t m_inUseBytes;
+    // most bytes handed out at once since the last trim
+    size_t m_highWaterBytes;
+    unsigned int m_reused;
+    unsigned int m_allocated;
+};
+
+} // namespace WebCore
+
+#endif // USE(ACCELERATED_COMPOSITING)
+#endif // PixelBufferPool_h
@@ -30,6 +30,7 @@
 #if USE(ACCELERATED_COMPOSITING)
 
 #include "GLUtils.h"
+#include "PixelBufferPool.h"
 #include "SkBitmap.h"
 #include "SkBitmapRef.h"
 #include "SkCanvas.h"
@@ -65,20 +66,28 @@ static const String TAGS[] = {
     TAG_UPDATE_TEXTURE,
 };
 
-SkBitmap* RasterRenderer::g_bitmap = 0;
+WTF::ThreadSpecific<SkBitmap>* RasterRenderer::g_bitmaps = 0;
 
 RasterRenderer::RasterRenderer() : BaseRenderer(BaseRenderer::Raster)
 {
 #ifdef DEBUG_COUNT
     ClassTracker::instance()->increment("RasterRenderer");
 #endif
-    if (!g_bitmap) {
-        g_bitmap = new SkBitmap();
-        g_bitmap->setConfig(SkBitmap::kARGB_8888_Config,
-                           TilesManager::instance()->tileWidth(),
-                           TilesManager::instance()->tileHeight());
-        g_bitmap->allocPixels();
+    if (!g_bitmaps)
+        g_bitmaps = new WTF::ThreadSpecific<SkBitmap>();
+}
+
+SkBitmap* RasterRenderer::threadBitmap()
+{
+    SkBitmap* bitmap = *g_bitmaps;
+    if (!bitmap->getPixels()) {
+        bitmap->setConfig(SkBitmap::kARGB_8888_Config,
+                          TilesManager::instance()->tileWidth(),
+                          TilesManager::instance()->tileHeight());
+        // the pixels outlive the thread, for the next generator thread
+        bitmap->allocPixels(PixelBufferPool::instance(), 0);
     }
+    return bitmap;
 }
 
 RasterRenderer::~RasterRenderer()
@@ -93,15 +102,16 @@ void RasterRenderer::setupCanvas(const TileRenderInfo& renderInfo, SkCanvas* can
     if (renderInfo.measurePerf)
         m_perfMon.start(TAG_CREATE_BITMAP);
 
+    SkBitmap* bitmap = threadBitmap();
     if (renderInfo.baseTile->isLayerTile()) {
-        g_bitmap->setIsOpaque(false);
-        g_bitmap->eraseARGB(0, 0, 0, 0);
+        bitmap->setIsOpaque(false);
+        bitmap->eraseARGB(0, 0, 0, 0);
     } else {
-        g_bitmap->setIsOpaque(true);
-        g_bitmap->eraseARGB(255, 255, 255, 255);
+        bitmap->setIsOpaque(true);
+        bitmap->eraseARGB(255, 255, 255, 255);
     }
 
-    SkDevice* device = new SkDevice(NULL, *g_bitmap, false);
+    SkDevice* device = new SkDevice(NULL, *bitmap, false);
 
     if (renderInfo.measurePerf) {
         m_perfMon.stop(TAG_CREATE_BITMAP);
@@ -31,6 +31,7 @@
 #include "BaseRenderer.h"
 #include "SkBitmap.h"
 #include "SkRect.h"
+#include <wtf/ThreadSpecific.h>
 
 class SkCanvas;
 class SkDevice;
@@ -52,7 +53,9 @@ protected:
     virtual const String* getPerformanceTags(int& tagCount);
 
 private:
-    static SkBitmap* g_bitmap;
+    // Each thread painting tiles renders into its own bitmap
+    static SkBitmap* threadBitmap();
+    static WTF::ThreadSpecific<SkBitmap>* g_bitmaps;
 
 };
 
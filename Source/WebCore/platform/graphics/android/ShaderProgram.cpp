@@ -194,10 +194,19 @@ GLuint ShaderProgram::createProgram(const char* pVertexSource, const char* pFrag
 
 ShaderProgram::ShaderProgram()
     : m_blendingEnabled(false)
+    , m_currentProgram(-1)
+    , m_currentPosition(-1)
+    , m_quadBufferBound(false)
+    , m_textureUnitActive(false)
+    , m_currentAlpha(-1)
+    , m_currentContrast(-1)
+    , m_drawingThread(0)
     , m_contrast(1)
     , m_alphaLayer(false)
     , m_currentScale(1.0f)
 {
+    memset(m_glCalls, 0, sizeof(m_glCalls));
+    memset(m_lastFrameGLCalls, 0, sizeof(m_lastFrameGLCalls));
     init();
 }
 
@@ -260,6 +269,20 @@ void ShaderProgram::init()
     glBindBuffer(GL_ARRAY_BUFFER, m_textureBuffer[0]);
     glBufferData(GL_ARRAY_BUFFER, 2 * 4 * sizeof(GLfloat), coord, GL_STATIC_DRAW);
 
+    // All our programs sample from the first texture unit, so the samplers
+    // are set once here rather than for every quad.
+    const GLint programs[] = { m_program, m_programInverted, m_videoProgram,
+                               m_surfTexOESProgram, m_surfTexOESProgramInverted };
+    const GLint samplers[] = { m_hTexSampler, m_hTexSamplerInverted, m_hVideoTexSampler,
+                               m_hSTOESTexSampler, m_hSTOESTexSamplerInverted };
+    for (unsigned int i = 0; i < sizeof(programs) / sizeof(programs[0]); i++) {
+        glUseProgram(programs[i]);
+        glUniform1i(samplers[i], 0);
+    }
+
+    m_textureFilters.clear();
+    invalidateGLState();
+
     GLUtils::checkGlError("init");
 }
 
@@ -284,6 +307,136 @@ void ShaderProgram::setBlendingState(bool enableBlending)
     m_blendingEnabled = enableBlending;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////
+// GL state cache
+/////////////////////////////////////////////////////////////////////////////////////////
+
+void ShaderProgram::startFrame()
+{
+    m_drawingThread = pthread_self();
+    memcpy(m_lastFrameGLCalls, m_glCalls, sizeof(m_glCalls));
+    memset(m_glCalls, 0, sizeof(m_glCalls));
+    invalidateGLState();
+}
+
+void ShaderProgram::invalidateGLState()
+{
+    m_currentProgram = -1;
+    m_currentPosition = -1;
+    m_quadBufferBound = false;
+    m_textureUnitActive = false;
+}
+
+void ShaderProgram::forgetTexture(GLuint textureId)
+{
+    if (!pthread_equal(pthread_self(), m_drawingThread))
+        return;
+    m_textureFilters.remove(textureId);
+}
+
+void ShaderProgram::gatherGLCalls(unsigned int* counts)
+{
+    memcpy(counts, m_lastFrameGLCalls, sizeof(m_lastFrameGLCalls));
+}
+
+void ShaderProgram::useProgram(GLint program)
+{
+    if (program == m_currentProgram) {
+        m_glCalls[ElidedCall]++;
+        return;
+    }
+
+    glUseProgram(program);
+    m_currentProgram = program;
+    // uniforms are per program, only remember the ones of the current one
+    m_currentAlpha = -1;
+    m_currentContrast = -1;
+    m_glCalls[ProgramSwitch]++;
+}
+
+void ShaderProgram::bindTexture(GLenum textureTarget, GLint textureId, GLint texFilter)
+{
+    if (!m_textureUnitActive) {
+        glActiveTexture(GL_TEXTURE0);
+        m_textureUnitActive = true;
+    } else
+        m_glCalls[ElidedCall]++;
+
+    // The binding is always done: other code binds textures without telling
+    // us, and consecutive quads rarely share a texture anyway.
+    glBindTexture(textureTarget, textureId);
+    m_glCalls[TextureBind]++;
+
+    // The sampler state however belongs to the texture, and only needs to be
+    // set again when the filter changes.
+    bool setWrap = true;
+    if (textureId) {
+        pair<HashMap<GLuint, GLint>::iterator, bool> result =
+            m_textureFilters.add(textureId, texFilter);
+        if (!result.second) {
+            setWrap = false;
+            m_glCalls[ElidedCall] += 2;
+            if (result.first->second == texFilter) {
+                m_glCalls[ElidedCall] += 2;
+                return;
+            }
+            result.first->second = texFilter;
+        }
+    }
+
+    glTexParameteri(textureTarget, GL_TEXTURE_MIN_FILTER, texFilter);
+    glTexParameteri(textureTarget, GL_TEXTURE_MAG_FILTER, texFilter);
+    m_glCalls[TexParameterCall] += 2;
+    if (setWrap) {
+        glTexParameteri(textureTarget, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(textureTarget, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        m_glCalls[TexParameterCall] += 2;
+    }
+}
+
+void ShaderProgram::bindQuadBuffer(GLint position)
+{
+    if (!m_quadBufferBound) {
+        glBindBuffer(GL_ARRAY_BUFFER, m_textureBuffer[0]);
+        m_quadBufferBound = true;
+        m_currentPosition = -1;
+    } else
+        m_glCalls[ElidedCall]++;
+
+    if (position == m_currentPosition) {
+        m_glCalls[ElidedCall] += 2;
+        return;
+    }
+
+    glEnableVertexAttribArray(position);
+    glVertexAttribPointer(position, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    m_currentPosition = position;
+}
+
+void ShaderProgram::setAlpha(GLint alpha, float opacity)
+{
+    if (opacity == m_currentAlpha) {
+        m_glCalls[ElidedCall]++;
+        return;
+    }
+
+    glUniform1f(alpha, opacity);
+    m_currentAlpha = opacity;
+    m_glCalls[UniformUpload]++;
+}
+
+void ShaderProgram::setContrastUniform(GLint contrast)
+{
+    if (m_contrast == m_currentContrast) {
+        m_glCalls[ElidedCall]++;
+        return;
+    }
+
+    glUniform1f(contrast, m_contrast);
+    m_currentContrast = m_contrast;
+    m_glCalls[UniformUpload]++;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////
 // Drawing
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -315,6 +468,7 @@ void ShaderProgram::setProjectionMatrix(SkRect& geometry, GLint projectionMatrix
     GLfloat projectionMatrix[16];
     GLUtils::toGLMatrix(projectionMatrix, total);
     glUniformMatrix4fv(projectionMatrixHandle, 1, GL_FALSE, projectionMatrix);
+    m_glCalls[UniformUpload]++;
 }
 
 void ShaderProgram::drawQuadInternal(SkRect& geometry,
@@ -329,7 +483,7 @@ void ShaderProgram::drawQuadInternal(SkRect& geometry,
                                      GLint texFilter,
                                      GLint contrast)
 {
-    glUseProgram(program);
+    useProgram(program);
 
     if (!geometry.isEmpty())
          setProjectionMatrix(geometry, projectionMatrixHandle);
@@ -341,25 +495,18 @@ void ShaderProgram::drawQuadInternal(SkRect& geometry,
         GLfloat projectionMatrix[16];
         GLUtils::toGLMatrix(projectionMatrix, matrix);
         glUniformMatrix4fv(projectionMatrixHandle, 1, GL_FALSE, projectionMatrix);
+        m_glCalls[UniformUpload]++;
     }
 
-    glActiveTexture(GL_TEXTURE0);
-    glUniform1i(texSampler, 0);
-    glBindTexture(textureTarget, textureId);
-    glTexParameteri(textureTarget, GL_TEXTURE_MIN_FILTER, texFilter);
-    glTexParameteri(textureTarget, GL_TEXTURE_MAG_FILTER, texFilter);
-    glTexParameteri(textureTarget, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(textureTarget, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_textureBuffer[0]);
-    glEnableVertexAttribArray(position);
-    glVertexAttribPointer(position, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    glUniform1f(alpha, opacity);
+    bindTexture(textureTarget, textureId, texFilter);
+    bindQuadBuffer(position);
+    setAlpha(alpha, opacity);
     if (contrast != -1)
-        glUniform1f(contrast, m_contrast);
+        setContrastUniform(contrast);
 
     setBlendingState(opacity < 1.0);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_glCalls[DrawCall]++;
 }
 
 void ShaderProgram::drawQuad(SkRect& geometry, int textureId, float opacity,
@@ -537,24 +684,15 @@ void ShaderProgram::drawLayerQuadInternal(const GLfloat* projectionMatrix,
                                           GLint position, GLint alpha,
                                           GLint contrast)
 {
-    glUseProgram(program);
+    useProgram(program);
     glUniformMatrix4fv(matrix, 1, GL_FALSE, projectionMatrix);
+    m_glCalls[UniformUpload]++;
 
-    glActiveTexture(GL_TEXTURE0);
-    glUniform1i(texSample, 0);
-    glBindTexture(textureTarget, textureId);
-    glTexParameteri(textureTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(textureTarget, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(textureTarget, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(textureTarget, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_textureBuffer[0]);
-    glEnableVertexAttribArray(position);
-    glVertexAttribPointer(position, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    glUniform1f(alpha, opacity);
+    bindTexture(textureTarget, textureId, GL_LINEAR);
+    bindQuadBuffer(position);
+    setAlpha(alpha, opacity);
     if (contrast != -1)
-        glUniform1f(contrast, m_contrast);
+        setContrastUniform(contrast);
 }
 
 
@@ -608,6 +746,7 @@ void ShaderProgram::drawLayerQuad(const TransformationMatrix& drawMatrix,
 
     setBlendingState(forceBlending || opacity < 1.0);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_glCalls[DrawCall]++;
 
     GLUtils::checkGlError("drawLayerQuad");
 }
@@ -617,7 +756,7 @@ void ShaderProgram::drawVideoLayerQuad(const TransformationMatrix& drawMatrix,
                                        int textureId)
 {
     // switch to our custom yuv video rendering program
-    glUseProgram(m_videoProgram);
+    useProgram(m_videoProgram);
 
     TransformationMatrix modifiedDrawMatrix = drawMatrix;
     modifiedDrawMatrix.translate(geometry.fLeft, geometry.fTop);
@@ -628,17 +767,20 @@ void ShaderProgram::drawVideoLayerQuad(const TransformationMatrix& drawMatrix,
     GLUtils::toGLMatrix(projectionMatrix, renderMatrix);
     glUniformMatrix4fv(m_hVideoProjectionMatrix, 1, GL_FALSE, projectionMatrix);
     glUniformMatrix4fv(m_hVideoTextureMatrix, 1, GL_FALSE, textureMatrix);
+    m_glCalls[UniformUpload] += 2;
 
-    glActiveTexture(GL_TEXTURE0);
-    glUniform1i(m_hVideoTexSampler, 0);
+    if (!m_textureUnitActive) {
+        glActiveTexture(GL_TEXTURE0);
+        m_textureUnitActive = true;
+    }
     glBindTexture(GL_TEXTURE_EXTERNAL_OES, textureId);
+    m_glCalls[TextureBind]++;
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_textureBuffer[0]);
-    glEnableVertexAttribArray(m_hVideoPosition);
-    glVertexAttribPointer(m_hVideoPosition, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    bindQuadBuffer(m_hVideoPosition);
 
     setBlendingState(false);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_glCalls[DrawCall]++;
 }
 
 void ShaderProgram::setWebViewMatrix(const float* matrix, bool alphaLayer)
@@ -24,6 +24,8 @@
 #include "SkRect.h"
 #include "TransformationMatrix.h"
 #include <GLES2/gl2.h>
+#include <pthread.h>
+#include <wtf/HashMap.h>
 
 #define MAX_CONTRAST 5
 
@@ -31,6 +33,17 @@ namespace WebCore {
 
 class ShaderProgram {
 public:
+    // GL calls issued by the quad drawing functions, counted per frame
+    enum GLCallType {
+        DrawCall,
+        ProgramSwitch,
+        TextureBind,
+        TexParameterCall,
+        UniformUpload,
+        ElidedCall, // state change skipped as redundant
+        GLCallTypeCount
+    };
+
     ShaderProgram();
     void init();
     int program() { return m_program; }
@@ -101,6 +114,21 @@ public:
     int getAnimationDeltaX() { return m_animationDelta.x(); }
     int getAnimationDeltaY() { return m_animationDelta.y(); }
 
+    // Called at the beginning of each drawGL: keeps the GL call counts of the
+    // previous frame and forgets the cached GL bindings.
+    void startFrame();
+    // The quad drawing functions skip state changes that are already in
+    // place. Code outside of ShaderProgram changing the program, the array
+    // buffer or the active texture unit must call this before the next quad.
+    void invalidateGLState();
+    // Must be called when a texture name is (re)generated, or when its
+    // sampler parameters are changed outside of ShaderProgram. Calls from
+    // other threads than the one drawing, such as the texture generators
+    // uploading into their own context, are ignored: their texture names
+    // are not the ones we cache.
+    void forgetTexture(GLuint textureId);
+    void gatherGLCalls(unsigned int* counts);
+
 private:
     GLuint loadShader(GLenum shaderType, const char* pSource);
     GLuint createProgram(const char* vertexSource, const char* fragmentSource);
@@ -108,6 +136,12 @@ private:
 
     void setBlendingState(bool enableBlending);
 
+    void useProgram(GLint program);
+    void bindTexture(GLenum textureTarget, GLint textureId, GLint texFilter);
+    void bindQuadBuffer(GLint position);
+    void setAlpha(GLint alpha, float opacity);
+    void setContrastUniform(GLint contrast);
+
     void drawQuadInternal(SkRect& geometry, GLint textureId, float opacity,
                           GLint program, GLint projectionMatrixHandle,
                           GLint texSampler, GLenum textureTarget,
@@ -121,6 +155,21 @@ private:
 
     bool m_blendingEnabled;
 
+    // GL state cache, see invalidateGLState()
+    GLint m_currentProgram;
+    GLint m_currentPosition;
+    bool m_quadBufferBound;
+    bool m_textureUnitActive;
+    float m_currentAlpha;
+    float m_currentContrast;
+    // filter of the textures whose sampler state was set by us, only
+    // accessed by the thread drawing the frames
+    HashMap<GLuint, GLint> m_textureFilters;
+    pthread_t m_drawingThread;
+
+    unsigned int m_glCalls[GLCallTypeCount];
+    unsigned int m_lastFrameGLCalls[GLCallTypeCount];
+
     int m_program;
     int m_programInverted;
     int m_videoProgram;
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "TexturePool.h"
+
+#if USE(ACCELERATED_COMPOSITING)
+
+#include "BaseTile.h"
+#include "BaseTileTexture.h"
+#include <algorithm>
+
+namespace WebCore {
+
+TexturePool::TexturePool()
+    : m_size(0)
+{
+}
+
+bool TexturePool::drawnAfter(const OwnedEntry& a, const OwnedEntry& b)
+{
+    return a.drawCount > b.drawCount;
+}
+
+void TexturePool::reset(const Vector<BaseTileTexture*>& textures)
+{
+    m_freeTextures.shrink(0);
+    m_ownedTextures.shrink(0);
+    m_painterBuckets.clear();
+
+    for (unsigned int i = 0; i < textures.size(); i++) {
+        BaseTileTexture* texture = textures[i];
+        texture->m_isAvailable = true;
+        if (texture->owner())
+            pushOwned(texture);
+        else
+            m_freeTextures.append(texture);
+    }
+    m_size = textures.size();
+}
+
+void TexturePool::remove(BaseTileTexture* texture)
+{
+    // the entries referencing the texture are dropped once they get looked at
+    if (texture->m_isAvailable) {
+        texture->m_isAvailable = false;
+        m_size--;
+    }
+}
+
+void TexturePool::pushOwned(BaseTileTexture* texture)
+{
+    TextureOwner* owner = texture->owner();
+    OwnedEntry entry = { texture, owner, owner->drawCount() };
+    pushOwnedEntry(entry);
+
+    TilePainter* painter = static_cast<BaseTile*>(owner)->painter();
+    const float scale = texture->scale();
+    Vector<ScaleBucket>& buckets = m_painterBuckets.add(painter, Vector<ScaleBucket>()).first->second;
+    for (unsigned int i = 0; i < buckets.size(); i++) {
+        if (buckets[i].scale == scale) {
+            buckets[i].textures.append(texture);
+            return;
+        }
+    }
+    buckets.append(ScaleBucket());
+    buckets.last().scale = scale;
+    buckets.last().textures.append(texture);
+}
+
+void TexturePool::pushOwnedEntry(const OwnedEntry& entry)
+{
+    m_ownedTextures.append(entry);
+    std::push_heap(m_ownedTextures.begin(), m_ownedTextures.end(), drawnAfter);
+}
+
+void TexturePool::popOwnedEntry()
+{
+    std::pop_heap(m_ownedTextures.begin(), m_ownedTextures.end(), drawnAfter);
+    m_ownedTextures.removeLast();
+}
+
+BaseTileTexture* TexturePool::pick(BaseTile* owner, unsigned long long drawCountLimit,
+                                   PickType& type)
+{
+    type = NoPick;
+    BaseTileTexture* texture = pickFree();
+    if (texture)
+        type = FreePick;
+    else {
+        texture = pickOtherScale(owner);
+        if (texture)
+            type = ScalePick;
+        else
+            texture = pickLeastRecentlyDrawn(owner, drawCountLimit, type);
+    }
+
+    // put back what was skipped, it may do for the next tile
+    for (unsigned int i = 0; i < m_skippedFree.size(); i++)
+        m_freeTextures.append(m_skippedFree[i]);
+    for (unsigned int i = 0; i < m_skippedOwned.size(); i++)
+        pushOwnedEntry(m_skippedOwned[i]);
+    for (unsigned int i = 0; i < m_skippedScaled.size(); i++)
+        m_skippedScaled[i].first->append(m_skippedScaled[i].second);
+    m_skippedFree.shrink(0);
+    m_skippedOwned.shrink(0);
+    m_skippedScaled.shrink(0);
+
+    return texture;
+}
+
+BaseTileTexture* TexturePool::pickFree()
+{
+    while (!m_freeTextures.isEmpty()) {
+        BaseTileTexture* texture = m_freeTextures.last();
+        if (!texture->m_isAvailable) {
+            m_freeTextures.removeLast();
+            continue;
+        }
+
+        if (texture->owner()) {
+            // got an owner since the gather
+            m_freeTextures.removeLast();
+            pushOwned(texture);
+            continue;
+        }
+
+        if (texture->busy()) {
+            // don't bother, since the acquire() will likely fail
+            m_freeTextures.removeLast();
+            m_skippedFree.append(texture);
+            continue;
+        }
+
+        return texture;
+    }
+    return 0;
+}
+
+BaseTileTexture* TexturePool::pickOtherScale(BaseTile* owner)
+{
+    PainterBuckets::iterator it = m_painterBuckets.find(owner->painter());
+    if (it == m_painterBuckets.end())
+        return 0;
+
+    Vector<ScaleBucket>& buckets = it->second;
+    for (unsigned int i = 0; i < buckets.size(); i++) {
+        if (buckets[i].scale == owner->scale())
+            continue;
+
+        Vector<BaseTileTexture*>& textures = buckets[i].textures;
+        while (!textures.isEmpty()) {
+            BaseTileTexture* texture = textures.last();
+            BaseTile* currentOwner = static_cast<BaseTile*>(texture->owner());
+            if (!texture->m_isAvailable || !currentOwner
+                || currentOwner->painter() != owner->painter()
+                || texture->scale() != buckets[i].scale) {
+                // out of date, the heap of owned textures still has it
+                textures.removeLast();
+                continue;
+            }
+
+            if (texture->busy() || currentOwner == owner) {
+                textures.removeLast();
+                m_skippedScaled.append(std::make_pair(&textures, texture));
+                continue;
+            }
+
+            return texture;
+        }
+    }
+    return 0;
+}
+
+BaseTileTexture* TexturePool::pickLeastRecentlyDrawn(BaseTile* owner,
+                                                     unsigned long long drawCountLimit,
+                                                     PickType& type)
+{
+    while (!m_ownedTextures.isEmpty()) {
+        OwnedEntry entry = m_ownedTextures.first();
+        BaseTileTexture* texture = entry.texture;
+        if (!texture->m_isAvailable) {
+            popOwnedEntry();
+            continue;
+        }
+
+        TextureOwner* currentOwner = texture->owner();
+        if (!currentOwner) {
+            // released since the gather
+            if (texture->busy()) {
+                popOwnedEntry();
+                m_skippedFree.append(texture);
+                continue;
+            }
+            type = FreePick;
+            return texture;
+        }
+
+        if (currentOwner != entry.owner || currentOwner->drawCount() != entry.drawCount) {
+            // drawn (or changed hands) since indexed, requeue it with the
+            // current draw count. Draw counts only grow, so the entries
+            // that remain out of date still come out early enough to get
+            // requeued in turn.
+            popOwnedEntry();
+            entry.owner = currentOwner;
+            entry.drawCount = currentOwner->drawCount();
+            pushOwnedEntry(entry);
+            continue;
+        }
+
+        // all the other textures were drawn even more recently
+        if (entry.drawCount >= drawCountLimit)
+            return 0;
+
+        if (texture->busy() || currentOwner == owner) {
+            // Don't let a tile acquire its own front texture, as the
+            // acquisition logic doesn't handle that
+            popOwnedEntry();
+            m_skippedOwned.append(entry);
+            continue;
+        }
+
+        type = StealPick;
+        return texture;
+    }
+    return 0;
+}
+
+} // namespace WebCore
+
+#endif // USE(ACCELERATED_COMPOSITING)
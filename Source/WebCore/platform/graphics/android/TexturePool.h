@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TexturePool_h
+#define TexturePool_h
+
+#if USE(ACCELERATED_COMPOSITING)
+
+#include <wtf/HashMap.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class BaseTile;
+class BaseTileTexture;
+class TilePainter;
+class TextureOwner;
+
+// Index over the textures TilesManager may hand out during a frame, replacing
+// a linear scan per request. It is rebuilt from the textures vector at each
+// gather, and updated lazily afterwards: entries whose texture got taken,
+// released or redrawn since are fixed up when they reach the top of their
+// container. The availability flag lives in the texture itself, see
+// BaseTileTexture::m_isAvailable.
+// Must be used under TilesManager's textures lock.
+class TexturePool {
+public:
+    enum PickType {
+        NoPick,
+        FreePick, // texture without owner
+        ScalePick, // texture of the same painter, at another scale
+        StealPick // least recently drawn texture
+    };
+
+    TexturePool();
+
+    // Make all the textures available again.
+    void reset(const Vector<BaseTileTexture*>& textures);
+
+    void remove(BaseTileTexture* texture);
+
+    // Select a texture for owner, following TilesManager's heuristic. Only
+    // textures whose owner was drawn before drawCountLimit can be stolen.
+    // The texture is not removed from the pool, as acquiring it may fail.
+    BaseTileTexture* pick(BaseTile* owner, unsigned long long drawCountLimit,
+                          PickType& type);
+
+    unsigned int size() const { return m_size; }
+
+private:
+    struct OwnedEntry {
+        BaseTileTexture* texture;
+        TextureOwner* owner;
+        unsigned long long drawCount;
+    };
+
+    struct ScaleBucket {
+        float scale;
+        Vector<BaseTileTexture*> textures;
+    };
+
+    typedef HashMap<TilePainter*, Vector<ScaleBucket> > PainterBuckets;
+
+    static bool drawnAfter(const OwnedEntry& a, const OwnedEntry& b);
+
+    void pushOwned(BaseTileTexture* texture);
+    void pushOwnedEntry(const OwnedEntry& entry);
+    void popOwnedEntry();
+
+    BaseTileTexture* pickFree();
+    BaseTileTexture* pickOtherScale(BaseTile* owner);
+    BaseTileTexture* pickLeastRecentlyDrawn(BaseTile* owner,
+                                            unsigned long long drawCountLimit,
+                                            PickType& type);
+
+    // textures without owner at gather time, used as a stack
+    Vector<BaseTileTexture*> m_freeTextures;
+    // owned textures, as a min-heap on the owner's draw count
+    Vector<OwnedEntry> m_ownedTextures;
+    // owned textures, by painter then scale
+    PainterBuckets m_painterBuckets;
+
+    // entries set aside while picking, as the texture is busy or belongs to
+    // the requesting tile, to be restored once done
+    Vector<BaseTileTexture*> m_skippedFree;
+    Vector<OwnedEntry> m_skippedOwned;
+    Vector<std::pair<Vector<BaseTileTexture*>*, BaseTileTexture*> > m_skippedScaled;
+
+    unsigned int m_size;
+};
+
+} // namespace WebCore
+
+#endif // USE(ACCELERATED_COMPOSITING)
+#endif // TexturePool_h
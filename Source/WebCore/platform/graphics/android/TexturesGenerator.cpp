@@ -29,10 +29,14 @@
 #if USE(ACCELERATED_COMPOSITING)
 
 #include "BaseLayerAndroid.h"
+#include "BaseRenderer.h"
 #include "GLUtils.h"
 #include "PaintTileOperation.h"
 #include "TilesManager.h"
 
+#include <algorithm>
+#include <unistd.h>
+
 #ifdef DEBUG
 
 #include <cutils/log.h>
@@ -51,13 +55,67 @@
 
 namespace WebCore {
 
+// Heap order for std::push_heap() and friends, which keep the greatest
+// element first: the operation to run next is the one with the lowest
+// priority value, or the oldest one among equal priorities.
+bool TexturesGenerator::runsAfter(const QueuedEntry& a, const QueuedEntry& b)
+{
+    if (a.priority != b.priority)
+        return a.priority > b.priority;
+    return a.sequence > b.sequence;
+}
+
+TexturesGenerator::TexturesGenerator()
+    : m_nextSequence(0)
+    , m_prioritizedDrawCount(0)
+    , m_waitingForCompletion(0)
+    , m_readyWorkerCount(0)
+{
+    // Leave one core to the UI and WebCore threads
+    long cores = sysconf(_SC_NPROCESSORS_CONF);
+    m_activeWorkerCount = std::max(1, std::min(static_cast<int>(cores) - 1, MAX_TEXTURES_GENERATORS));
+    for (int i = 0; i < MAX_TEXTURES_GENERATORS; i++)
+        m_runningOperations[i] = 0;
+}
+
+void TexturesGenerator::start()
+{
+    for (int i = 0; i < MAX_TEXTURES_GENERATORS; i++) {
+        m_workers[i] = new Worker(this, i);
+        m_workers[i]->run("TexturesGenerator");
+    }
+}
+
+int TexturesGenerator::activeWorkerCount()
+{
+    android::Mutex::Autolock lock(mRequestedOperationsLock);
+    return m_activeWorkerCount;
+}
+
+void TexturesGenerator::setActiveWorkerCount(int count)
+{
+    {
+        android::Mutex::Autolock lock(mRequestedOperationsLock);
+        m_activeWorkerCount = std::max(1, std::min(count, MAX_TEXTURES_GENERATORS));
+        XLOG("%d active workers", m_activeWorkerCount);
+    }
+    mRequestedOperationsCond.broadcast();
+}
+
 void TexturesGenerator::scheduleOperation(QueuedOperation* operation)
 {
     {
         android::Mutex::Autolock lock(mRequestedOperationsLock);
-        mRequestedOperations.append(operation);
+        QueuedEntry entry;
+        entry.operation = operation;
+        entry.priority = operation->priority();
+        entry.sequence = m_nextSequence++;
+        mRequestedOperations.append(entry);
+        std::push_heap(mRequestedOperations.begin(), mRequestedOperations.end(), runsAfter);
     }
-    mRequestedOperationsCond.signal();
+    // Idle workers beyond the active count also wait on the condition,
+    // so waking a single thread may not start the operation.
+    mRequestedOperationsCond.broadcast();
 }
 
 void TexturesGenerator::removeOperationsForPage(TiledPage* page)
@@ -81,127 +139,138 @@ void TexturesGenerator::removeOperationsForFilter(OperationFilter* filter, bool
         return;
 
     android::Mutex::Autolock lock(mRequestedOperationsLock);
-    for (unsigned int i = 0; i < mRequestedOperations.size();) {
-        QueuedOperation* operation = mRequestedOperations[i];
-        if (filter->check(operation)) {
-            mRequestedOperations.remove(i);
+    // Compact the queue in one pass, then restore the heap order
+    unsigned int kept = 0;
+    for (unsigned int i = 0; i < mRequestedOperations.size(); i++) {
+        QueuedOperation* operation = mRequestedOperations[i].operation;
+        if (filter->check(operation))
             delete operation;
-        } else {
-            i++;
-        }
+        else
+            mRequestedOperations[kept++] = mRequestedOperations[i];
+    }
+    if (kept != mRequestedOperations.size()) {
+        mRequestedOperations.shrink(kept);
+        std::make_heap(mRequestedOperations.begin(), mRequestedOperations.end(), runsAfter);
     }
 
-    if (waitForRunning && m_currentOperation) {
-        QueuedOperation* operation = m_currentOperation;
-
-        if (operation && filter->check(operation)) {
-            m_waitForCompletion = true;
-            // The reason we are signaling the transferQueue is :
-            // TransferQueue may be waiting a slot to work on, but now UI
-            // thread is waiting for Tex Gen thread to finish first before the
-            // UI thread can free a slot for the transferQueue.
-            // Therefore, it could be a deadlock.
-            // The solution is use this as a flag to tell Tex Gen thread that
-            // UI thread is waiting now, Tex Gen thread should not wait for the
-            // queue any more.
+    if (waitForRunning && isRunning(filter)) {
+        // The reason we are signaling the transferQueue is :
+        // TransferQueue may be waiting a slot to work on, but now UI
+        // thread is waiting for Tex Gen thread to finish first before the
+        // UI thread can free a slot for the transferQueue.
+        // Therefore, it could be a deadlock.
+        // The solution is use this as a flag to tell Tex Gen thread that
+        // UI thread is waiting now, Tex Gen thread should not wait for the
+        // queue any more.
+        if (!m_waitingForCompletion++)
             TilesManager::instance()->transferQueue()->interruptTransferQueue(true);
-        }
-
-        delete filter;
-
-        // At this point, it means that we are currently executing an operation that
-        // we want to be removed -- we should wait until it is done, so that
-        // when we return our caller can be sure that there is no more operations
-        // in the queue matching the given filter.
-        while (m_waitForCompletion)
-            mRequestedOperationsCond.wait(mRequestedOperationsLock);
-    } else {
-        delete filter;
+
+        // At this point, it means that workers are currently executing
+        // operations that we want to be removed -- we should wait until they
+        // are done, so that when we return our caller can be sure that there
+        // is no more operations in the queue matching the given filter.
+        while (isRunning(filter))
+            mCompletedOperationCond.wait(mRequestedOperationsLock);
+
+        if (!--m_waitingForCompletion)
+            TilesManager::instance()->transferQueue()->interruptTransferQueue(false);
+    }
+
+    delete filter;
+}
+
+// Must be called from within a lock!
+bool TexturesGenerator::isRunning(OperationFilter* filter)
+{
+    for (int i = 0; i < MAX_TEXTURES_GENERATORS; i++) {
+        if (m_runningOperations[i] && filter->check(m_runningOperations[i]))
+            return true;
     }
+    return false;
 }
 
-status_t TexturesGenerator::readyToRun()
+status_t TexturesGenerator::Worker::readyToRun()
 {
-    TilesManager::instance()->markGeneratorAsReady();
-    XLOG("Thread ready to run");
+    m_generator->workerReady();
+    XLOG("Worker %d ready to run", m_index);
     return NO_ERROR;
 }
 
+bool TexturesGenerator::Worker::threadLoop()
+{
+    m_generator->runNextOperation(m_index);
+    return true;
+}
+
+void TexturesGenerator::workerReady()
+{
+    bool allReady = false;
+    {
+        android::Mutex::Autolock lock(mRequestedOperationsLock);
+        allReady = ++m_readyWorkerCount == MAX_TEXTURES_GENERATORS;
+    }
+    if (allReady)
+        TilesManager::instance()->markGeneratorAsReady();
+}
+
+// Must be called from within a lock!
+bool TexturesGenerator::isWorkerActive(int worker)
+{
+    if (worker >= m_activeWorkerCount)
+        return false;
+    // Ganesh paints through a single GL context, keep it on one thread
+    if (worker && BaseRenderer::getCurrentRendererType() == BaseRenderer::Ganesh)
+        return false;
+    return true;
+}
+
+// Must be called from within a lock!
+void TexturesGenerator::reprioritize()
+{
+    for (unsigned int i = 0; i < mRequestedOperations.size(); i++)
+        mRequestedOperations[i].priority = mRequestedOperations[i].operation->priority();
+    std::make_heap(mRequestedOperations.begin(), mRequestedOperations.end(), runsAfter);
+}
+
 // Must be called from within a lock!
 QueuedOperation* TexturesGenerator::popNext()
 {
-    // Priority can change between when it was added and now
-    // Hence why the entire queue is rescanned
-    QueuedOperation* current = mRequestedOperations.last();
-    int currentPriority = current->priority();
-    if (currentPriority < 0) {
-        mRequestedOperations.removeLast();
-        return current;
-    }
-    int currentIndex = mRequestedOperations.size() - 1;
-    // Scan from the back to make removing faster (less items to copy)
-    for (int i = mRequestedOperations.size() - 2; i >= 0; i--) {
-        QueuedOperation *next = mRequestedOperations[i];
-        int nextPriority = next->priority();
-        if (nextPriority < 0) {
-            // Found a very high priority item, go ahead and just handle it now
-            mRequestedOperations.remove(i);
-            return next;
-        }
-        // pick items preferrably by priority, or if equal, by order of
-        // insertion (as we add items at the back of the queue)
-        if (nextPriority <= currentPriority) {
-            current = next;
-            currentPriority = nextPriority;
-            currentIndex = i;
-        }
+    // Priorities depend on the last drawn frame (draw counts, scrolling
+    // direction, which tiles have a front texture), so they only need to
+    // be recomputed when a new frame has been drawn.
+    unsigned long long drawCount = TilesManager::instance()->getDrawGLCount();
+    if (drawCount != m_prioritizedDrawCount) {
+        reprioritize();
+        m_prioritizedDrawCount = drawCount;
     }
-    mRequestedOperations.remove(currentIndex);
-    return current;
+
+    std::pop_heap(mRequestedOperations.begin(), mRequestedOperations.end(), runsAfter);
+    QueuedOperation* next = mRequestedOperations.last().operation;
+    mRequestedOperations.removeLast();
+    return next;
 }
 
-bool TexturesGenerator::threadLoop()
+void TexturesGenerator::runNextOperation(int worker)
 {
-    // Check if we have any pending operations.
     mRequestedOperationsLock.lock();
-    while (!mRequestedOperations.size())
+    while (!mRequestedOperations.size() || !isWorkerActive(worker))
         mRequestedOperationsCond.wait(mRequestedOperationsLock);
 
-    XLOG("threadLoop, got signal");
+    XLOG("worker %d, %d operations in the queue", worker, mRequestedOperations.size());
+    QueuedOperation* operation = popNext();
+    m_runningOperations[worker] = operation;
     mRequestedOperationsLock.unlock();
 
-    m_currentOperation = 0;
-    bool stop = false;
-    while (!stop) {
-        mRequestedOperationsLock.lock();
-        XLOG("threadLoop, %d operations in the queue", mRequestedOperations.size());
-        if (mRequestedOperations.size())
-            m_currentOperation = popNext();
-        mRequestedOperationsLock.unlock();
-
-        if (m_currentOperation) {
-            XLOG("threadLoop, painting the request with priority %d", m_currentOperation->priority());
-            m_currentOperation->run();
-        }
-
-        QueuedOperation* oldOperation = m_currentOperation;
-        mRequestedOperationsLock.lock();
-        if (m_currentOperation)
-            m_currentOperation = 0;
-        if (!mRequestedOperations.size())
-            stop = true;
-        if (m_waitForCompletion) {
-            m_waitForCompletion = false;
-            TilesManager::instance()->transferQueue()->interruptTransferQueue(false);
-            mRequestedOperationsCond.signal();
-        }
-        mRequestedOperationsLock.unlock();
-        if (oldOperation)
-            delete oldOperation; // delete outside lock
-    }
-    XLOG("threadLoop empty");
+    XLOG("worker %d, painting the request with priority %d", worker, operation->priority());
+    operation->run();
 
-    return true;
+    mRequestedOperationsLock.lock();
+    m_runningOperations[worker] = 0;
+    if (m_waitingForCompletion)
+        mCompletedOperationCond.broadcast();
+    mRequestedOperationsLock.unlock();
+
+    delete operation; // delete outside lock
 }
 
 } // namespace WebCore
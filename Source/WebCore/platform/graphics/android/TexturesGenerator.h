@@ -32,6 +32,10 @@
 #include "TiledPage.h"
 #include "TilePainter.h"
 #include <utils/threads.h>
+#include <wtf/Vector.h>
+
+// Upper bound for the number of threads painting tiles in parallel
+#define MAX_TEXTURES_GENERATORS 3
 
 namespace WebCore {
 
@@ -40,13 +44,19 @@ using namespace android;
 class BaseLayerAndroid;
 class LayerAndroid;
 
-class TexturesGenerator : public Thread {
+// Paints queued operations on a pool of worker threads. Operations are kept
+// in a binary heap ordered by priority, then by order of insertion. The
+// priority of an operation depends on the state of the last drawn frame, so
+// the whole heap is re-keyed once per drawn frame instead of rescanning the
+// queue for every operation popped.
+class TexturesGenerator : public RefBase {
 public:
-    TexturesGenerator() : Thread(false)
-        , m_waitForCompletion(false)
-        , m_currentOperation(0) { }
+    TexturesGenerator();
     virtual ~TexturesGenerator() { }
-    virtual status_t readyToRun();
+
+    // Starts all the worker threads, the first activeWorkerCount() of
+    // them take operations from the queue.
+    void start();
 
     void removeOperationsForPage(TiledPage* page);
     void removePaintOperationsForPage(TiledPage* page, bool waitForRunning);
@@ -55,14 +65,53 @@ public:
 
     void scheduleOperation(QueuedOperation* operation);
 
+    int activeWorkerCount();
+    // Clamped to [1, MAX_TEXTURES_GENERATORS]
+    void setActiveWorkerCount(int count);
+
 private:
+    class Worker : public Thread {
+    public:
+        Worker(TexturesGenerator* generator, int index)
+            : Thread(false)
+            , m_generator(generator)
+            , m_index(index) { }
+        virtual status_t readyToRun();
+        virtual bool threadLoop();
+    private:
+        TexturesGenerator* m_generator;
+        int m_index;
+    };
+
+    struct QueuedEntry {
+        QueuedOperation* operation;
+        int priority;
+        unsigned sequence;
+    };
+
+    static bool runsAfter(const QueuedEntry& a, const QueuedEntry& b);
+    void workerReady();
+    void runNextOperation(int worker);
+    bool isWorkerActive(int worker);
+    bool isRunning(OperationFilter* filter);
     QueuedOperation* popNext();
-    virtual bool threadLoop();
-    Vector<QueuedOperation*> mRequestedOperations;
+    void reprioritize();
+
+    Vector<QueuedEntry> mRequestedOperations;
     android::Mutex mRequestedOperationsLock;
+    // Signaled when operations are scheduled
     android::Condition mRequestedOperationsCond;
-    bool m_waitForCompletion;
-    QueuedOperation* m_currentOperation;
+    // Signaled when an operation finishes while someone is waiting for it
+    android::Condition mCompletedOperationCond;
+    unsigned m_nextSequence;
+    unsigned long long m_prioritizedDrawCount;
+    int m_waitingForCompletion;
+
+    sp<Worker> m_workers[MAX_TEXTURES_GENERATORS];
+    // The operation being run by each worker, or 0
+    QueuedOperation* m_runningOperations[MAX_TEXTURES_GENERATORS];
+    int m_activeWorkerCount;
+    int m_readyWorkerCount;
 };
 
 } // namespace WebCore
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "TilePrefetchPredictor.h"
+
+#if USE(ACCELERATED_COMPOSITING)
+
+#include "TilesManager.h"
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+// Viewport velocity tracking, in tiles per second: a pause longer than the
+// timeout stops the scroll, and each viewport update weighs this much in the
+// smoothed velocity.
+#define VELOCITY_TIMEOUT 0.2
+#define VELOCITY_SMOOTHING 0.5
+#define MIN_APPROACH_VELOCITY 0.5
+// In seconds, for tiles the viewport is not going towards
+#define NOT_APPROACHING_TILE_DELAY 1.0
+// In ms
+#define MAX_TILE_VISIBILITY_DELAY 40000
+
+namespace WebCore {
+
+TilePrefetchPredictor::TilePrefetchPredictor()
+    : m_velocityX(0)
+    , m_velocityY(0)
+    , m_scale(0)
+    , m_left(0)
+    , m_top(0)
+    , m_time(0)
+{
+    m_prefetchTiles.setEmpty();
+}
+
+int TilePrefetchPredictor::prefetchDistance(float viewSize, float contentSize, bool useMinimalMemory)
+{
+    if (useMinimalMemory || viewSize * TILE_PREFETCH_RATIO >= contentSize)
+        return 0;
+    return TILE_PREFETCH_DISTANCE;
+}
+
+void TilePrefetchPredictor::setViewport(const SkRect& viewport, float scale, double time)
+{
+    double delta = time - m_time;
+    float left = m_left;
+    float top = m_top;
+    m_time = time;
+    m_left = viewport.fLeft;
+    m_top = viewport.fTop;
+
+    // Tiles are different at another scale, and a pause ends the gesture
+    if (scale != m_scale || delta <= 0 || delta > VELOCITY_TIMEOUT) {
+        m_velocityX = 0;
+        m_velocityY = 0;
+        m_scale = scale;
+        return;
+    }
+
+    float tilesX = (viewport.fLeft - left) * scale / TilesManager::tileWidth();
+    float tilesY = (viewport.fTop - top) * scale / TilesManager::tileHeight();
+    m_velocityX += (tilesX / delta - m_velocityX) * VELOCITY_SMOOTHING;
+    m_velocityY += (tilesY / delta - m_velocityY) * VELOCITY_SMOOTHING;
+}
+
+// Keeps the 2 * distance tiles of prefetch along an axis, moving them to the
+// side the viewport is going to.
+static void skewPrefetch(int distance, float velocity, int32_t* before, int32_t* after)
+{
+    int shift = std::min(distance,
+                         static_cast<int>(roundf(fabsf(velocity) * TILE_PREFETCH_LOOKAHEAD)));
+    if (velocity < 0)
+        shift = -shift;
+    *before = distance - shift;
+    *after = distance + shift;
+}
+
+void TilePrefetchPredictor::updatePrefetchTiles(int distanceX, int distanceY, double time)
+{
+    if (time - m_time > VELOCITY_TIMEOUT) {
+        m_velocityX = 0;
+        m_velocityY = 0;
+    }
+
+    skewPrefetch(distanceX, m_velocityX, &m_prefetchTiles.fLeft, &m_prefetchTiles.fRight);
+    skewPrefetch(distanceY, m_velocityY, &m_prefetchTiles.fTop, &m_prefetchTiles.fBottom);
+}
+
+// Time for the viewport to move over distance tiles, given its velocity.
+// Tiles the viewport moves away from are given a fixed delay per tile.
+static float timeToReach(int distance, float velocity)
+{
+    if (!distance)
+        return 0;
+    if (distance * velocity > 0 && fabsf(velocity) > MIN_APPROACH_VELOCITY)
+        return distance / velocity;
+    return NOT_APPROACHING_TILE_DELAY * abs(distance);
+}
+
+int TilePrefetchPredictor::tileVisibilityDelay(const SkIRect& bounds, int x, int y) const
+{
+    int distanceX = 0;
+    if (x < bounds.fLeft)
+        distanceX = x - bounds.fLeft;
+    else if (x >= bounds.fRight)
+        distanceX = x - bounds.fRight + 1;
+    int distanceY = 0;
+    if (y < bounds.fTop)
+        distanceY = y - bounds.fTop;
+    else if (y >= bounds.fBottom)
+        distanceY = y - bounds.fBottom + 1;
+
+    float delay = std::max(timeToReach(distanceX, m_velocityX),
+                           timeToReach(distanceY, m_velocityY));
+    return std::min(static_cast<int>(delay * 1000), MAX_TILE_VISIBILITY_DELAY);
+}
+
+} // namespace WebCore
+
+#endif // USE(ACCELERATED_COMPOSITING)
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TilePrefetchPredictor_h
+#define TilePrefetchPredictor_h
+
+#if USE(ACCELERATED_COMPOSITING)
+
+#include "SkRect.h"
+
+// Prefetch and render 1 tiles ahead of the scroll
+// TODO: We should either dynamically change the outer bound by detecting the
+// HW limit or save further in the GPU memory consumption.
+#define TILE_PREFETCH_DISTANCE 1
+
+// ratio of content to view required for prefetching to enable
+#define TILE_PREFETCH_RATIO 1.2
+
+// The prefetched tiles are moved towards the direction of travel, by as many
+// tiles as the viewport covers in this many seconds at the current velocity
+#define TILE_PREFETCH_LOOKAHEAD 0.3
+
+namespace WebCore {
+
+// Tracks the velocity of the viewport, in tiles per second, and derives from
+// it which tiles around the viewport to prefetch and how soon each tile will
+// be needed. Times are passed in rather than read from the clock.
+class TilePrefetchPredictor {
+public:
+    TilePrefetchPredictor();
+
+    // Number of tiles to prefetch on each side of the viewport along an
+    // axis, or 0 if the content barely extends past the viewport.
+    static int prefetchDistance(float viewSize, float contentSize, bool useMinimalMemory);
+
+    // Called with every new viewport, in content coordinates
+    void setViewport(const SkRect& viewport, float scale, double time);
+
+    // Skews distanceX and distanceY tiles of prefetch on each side of the
+    // viewport towards the scrolling direction
+    void updatePrefetchTiles(int distanceX, int distanceY, double time);
+    const SkIRect& prefetchTiles() const { return m_prefetchTiles; }
+
+    // predicted time in ms before the tile enters viewportTileBounds, capped
+    int tileVisibilityDelay(const SkIRect& viewportTileBounds, int x, int y) const;
+
+private:
+    float m_velocityX;
+    float m_velocityY;
+    float m_scale;
+    float m_left;
+    float m_top;
+    double m_time;
+    SkIRect m_prefetchTiles;
+};
+
+} // namespace WebCore
+
+#endif // USE(ACCELERATED_COMPOSITING)
+#endif // TilePrefetchPredictor_h
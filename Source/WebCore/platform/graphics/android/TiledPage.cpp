@@ -71,6 +71,7 @@ TiledPage::TiledPage(int id, GLWebViewState* state)
     , m_willDraw(false)
 {
     m_baseTiles = new BaseTile[TilesManager::getMaxTextureAllocation() + 1];
+    m_preparedBounds.setEmpty();
 #ifdef DEBUG_COUNT
     ClassTracker::instance()->increment("TiledPage");
 #endif
@@ -248,15 +249,15 @@ void TiledPage::prepare(bool goingDown, bool goingLeft, const SkIRect& tileBound
     int nMaxTilesPerPage = m_baseTileSize / 2;
 
     if (bounds == ExpandedBounds) {
-        // prepare tiles outside of the visible bounds
-        int expandX = m_glWebViewState->expandedTileBoundsX();
-        int expandY = m_glWebViewState->expandedTileBoundsY();
+        // prepare tiles outside of the visible bounds, more of them on the
+        // side the viewport is moving to
+        const SkIRect& prefetch = m_glWebViewState->prefetchTiles();
 
-        firstTileX -= expandX;
-        nbTilesWidth += expandX * 2;
+        firstTileX -= prefetch.fLeft;
+        nbTilesWidth += prefetch.fLeft + prefetch.fRight;
 
-        firstTileY -= expandY;
-        nbTilesHeight += expandY * 2;
+        firstTileY -= prefetch.fTop;
+        nbTilesHeight += prefetch.fTop + prefetch.fBottom;
     }
 
     // crop the tile bounds in each dimension to the larger of the base layer or viewport
@@ -287,6 +288,17 @@ void TiledPage::prepare(bool goingDown, bool goingLeft, const SkIRect& tileBound
               " nbTilesHeight %d nbTilesWidth %d", nbTilesHeight, nbTilesWidth);
         return;
     }
+
+    // drop the queued paints the viewport moved away from
+    SkIRect preparedBounds;
+    preparedBounds.set(firstTileX, firstTileY,
+                       firstTileX + nbTilesWidth, firstTileY + nbTilesHeight);
+    if (preparedBounds != m_preparedBounds) {
+        m_preparedBounds = preparedBounds;
+        TilesManager::instance()->removeOperationsForFilter(
+            new TileBoundsFilter(this, m_preparedBounds));
+    }
+
     for (int i = 0; i < nbTilesHeight; i++)
         prepareRow(goingLeft, nbTilesWidth, firstTileX, firstTileY + i, tileBounds);
 
@@ -132,6 +132,8 @@ private:
     // info saved in prepare, used in drawGL()
     bool m_willDraw;
     SkIRect m_tileBounds;
+    // tiles requested by the latest prepare(), including prefetched ones
+    SkIRect m_preparedBounds;
     float m_transparency;
 };
 
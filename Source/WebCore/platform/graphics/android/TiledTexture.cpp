@@ -300,7 +300,12 @@ bool TiledTexture::paint(BaseTile* tile, SkCanvas* canvas, unsigned int* picture
 
     XLOG("TT %p painting tile %d, %d with picture %p", this, tile->x(), tile->y(), picture);
 
-    canvas->drawPicture(*picture);
+    {
+        // The picture may be shared with other tiles of this layer painted
+        // by the other generators, or with the DualTiledTexture's sibling
+        android::Mutex::Autolock lock(TilesManager::pictureLock(picture));
+        canvas->drawPicture(*picture);
+    }
 
     SkSafeUnref(picture);
 
@@ -94,6 +94,16 @@ int TilesManager::getMaxTextureAllocation()
     return MAX_TEXTURE_ALLOCATION;
 }
 
+// Pictures share a few locks, so that the texture generators still paint
+// different layers in parallel
+#define PICTURE_LOCK_COUNT 16
+static android::Mutex gPictureLocks[PICTURE_LOCK_COUNT];
+
+android::Mutex& TilesManager::pictureLock(const SkPicture* picture)
+{
+    return gPictureLocks[(reinterpret_cast<uintptr_t>(picture) >> 4) % PICTURE_LOCK_COUNT];
+}
+
 TilesManager::TilesManager()
     : m_layerTexturesRemain(true)
     , m_maxTextureCount(0)
@@ -109,11 +119,10 @@ TilesManager::TilesManager()
 {
     XLOG("TilesManager ctor");
     m_textures.reserveCapacity(MAX_TEXTURE_ALLOCATION);
-    m_availableTextures.reserveCapacity(MAX_TEXTURE_ALLOCATION);
     m_tilesTextures.reserveCapacity(MAX_TEXTURE_ALLOCATION);
-    m_availableTilesTextures.reserveCapacity(MAX_TEXTURE_ALLOCATION);
-    m_pixmapsGenerationThread = new TexturesGenerator();
-    m_pixmapsGenerationThread->run("TexturesGenerator");
+    memset(m_texturePicks, 0, sizeof(m_texturePicks));
+    m_texturesGenerator = new TexturesGenerator();
+    m_texturesGenerator->start();
 }
 
 void TilesManager::allocateTiles()
@@ -237,13 +246,13 @@ void TilesManager::addPaintedSurface(PaintedSurface* surface)
 void TilesManager::gatherTextures()
 {
     android::Mutex::Autolock lock(m_texturesLock);
-    m_availableTextures = m_textures;
+    m_availableTextures.reset(m_textures);
 }
 
 void TilesManager::gatherLayerTextures()
 {
     android::Mutex::Autolock lock(m_texturesLock);
-    m_availableTilesTextures = m_tilesTextures;
+    m_availableTilesTextures.reset(m_tilesTextures);
     m_layerTexturesRemain = true;
 }
 
@@ -256,13 +265,13 @@ BaseTileTexture* TilesManager::getAvailableTexture(BaseTile* owner)
         XLOG("same owner (%d, %d), getAvailableBackTexture(%x) => texture %x",
              owner->x(), owner->y(), owner, owner->backTexture());
         if (owner->isLayerTile())
-            m_availableTilesTextures.remove(m_availableTilesTextures.find(owner->backTexture()));
+            m_availableTilesTextures.remove(owner->backTexture());
         else
-            m_availableTextures.remove(m_availableTextures.find(owner->backTexture()));
+            m_availableTextures.remove(owner->backTexture());
         return owner->backTexture();
     }
 
-    WTF::Vector<BaseTileTexture*>* availableTexturePool;
+    TexturePool* availableTexturePool;
     if (owner->isLayerTile()) {
         availableTexturePool = &m_availableTilesTextures;
     } else {
@@ -278,60 +287,30 @@ BaseTileTexture* TilesManager::getAvailableTexture(BaseTile* owner)
     //         it's old and not visible. Break with that one
     //  5. Otherwise, use the least recently prepared tile, but ignoring tiles
     //         drawn in the last frame to avoid flickering
+    // The pool indexes the textures so that each step is a lookup instead of
+    // a scan over all of them.
 
-    BaseTileTexture* farthestTexture = 0;
-    unsigned long long oldestDrawCount = getDrawGLCount() - 1;
-    const unsigned int max = availableTexturePool->size();
-    for (unsigned int i = 0; i < max; i++) {
-        BaseTileTexture* texture = (*availableTexturePool)[i];
-        BaseTile* currentOwner = static_cast<BaseTile*>(texture->owner());
-
-        if (texture->busy()) {
-            // don't bother, since the acquire() will likely fail
-            continue;
-        }
-
-        if (!currentOwner) {
-            // unused texture! take it!
-            farthestTexture = texture;
-            break;
-        }
-
-        if (currentOwner == owner) {
-            // Don't let a tile acquire its own front texture, as the
-            // acquisition logic doesn't handle that
-            continue;
-        }
-
-        if (currentOwner->painter() == owner->painter() && texture->scale() != owner->scale()) {
-            // if we render the back page with one scale, then another while
-            // still zooming, we recycle the tiles with the old scale instead of
-            // taking ones from the front page
-            farthestTexture = texture;
-            break;
-        }
-
-        unsigned long long textureDrawCount = currentOwner->drawCount();
-        if (oldestDrawCount > textureDrawCount) {
-            farthestTexture = texture;
-            oldestDrawCount = textureDrawCount;
-        }
-    }
+    TexturePool::PickType pickType;
+    BaseTileTexture* farthestTexture = availableTexturePool->pick(owner, getDrawGLCount() - 1,
+                                                                 pickType);
 
     if (farthestTexture) {
         BaseTile* previousOwner = static_cast<BaseTile*>(farthestTexture->owner());
         if (farthestTexture->acquire(owner)) {
             if (previousOwner) {
                 previousOwner->removeTexture(farthestTexture);
+                m_profiler.recordTiming(TilesProfiler::TextureSteal,
+                                        getDrawGLCount() - previousOwner->drawCount());
 
                 XLOG("%s texture %p stolen from tile %d, %d for %d, %d, drawCount was %llu (now %llu)",
                      owner->isLayerTile() ? "LAYER" : "BASE",
                      farthestTexture, previousOwner->x(), previousOwner->y(),
                      owner->x(), owner->y(),
-                     oldestDrawCount, getDrawGLCount());
+                     previousOwner->drawCount(), getDrawGLCount());
             }
 
-            availableTexturePool->remove(availableTexturePool->find(farthestTexture));
+            availableTexturePool->remove(farthestTexture);
+            m_texturePicks[pickType]++;
             return farthestTexture;
         }
     } else {
@@ -343,15 +322,26 @@ BaseTileTexture* TilesManager::getAvailableTexture(BaseTile* owner)
         }
     }
 
+    m_texturePicks[TexturePool::NoPick]++;
     XLOG("Couldn't find an available texture for %s tile %x (%d, %d) out of %d available",
           owner->isLayerTile() ? "LAYER" : "BASE",
-          owner, owner->x(), owner->y(), max);
+          owner, owner->x(), owner->y(), availableTexturePool->size());
 #ifdef DEBUG
     printTextures();
 #endif // DEBUG
     return 0;
 }
 
+void TilesManager::gatherTexturePicks(unsigned int* freePicks, unsigned int* scalePicks,
+                                      unsigned int* stolenPicks, unsigned int* failedPicks)
+{
+    android::Mutex::Autolock lock(m_texturesLock);
+    *freePicks = m_texturePicks[TexturePool::FreePick];
+    *scalePicks = m_texturePicks[TexturePool::ScalePick];
+    *stolenPicks = m_texturePicks[TexturePool::StealPick];
+    *failedPicks = m_texturePicks[TexturePool::NoPick];
+}
+
 int TilesManager::maxTextureCount()
 {
     android::Mutex::Autolock lock(m_texturesLock);
@@ -34,6 +34,7 @@
 #include "LayerAndroid.h"
 #include "ShaderProgram.h"
 #include "SkBitmapRef.h"
+#include "TexturePool.h"
 #include "TexturesGenerator.h"
 #include "TiledPage.h"
 #include "TilesProfiler.h"
@@ -58,24 +59,34 @@ public:
         return gInstance != 0;
     }
 
+    // SkPicture playback is not thread safe: hold this lock while playing
+    // back a picture that another thread may be drawing as well
+    static android::Mutex& pictureLock(const SkPicture* picture);
+
     void removeOperationsForFilter(OperationFilter* filter, bool waitForRunning = false)
     {
-        m_pixmapsGenerationThread->removeOperationsForFilter(filter, waitForRunning);
+        m_texturesGenerator->removeOperationsForFilter(filter, waitForRunning);
     }
 
     void removeOperationsForPage(TiledPage* page)
     {
-        m_pixmapsGenerationThread->removeOperationsForPage(page);
+        m_texturesGenerator->removeOperationsForPage(page);
     }
 
     void removePaintOperationsForPage(TiledPage* page, bool waitForCompletion)
     {
-        m_pixmapsGenerationThread->removePaintOperationsForPage(page, waitForCompletion);
+        m_texturesGenerator->removePaintOperationsForPage(page, waitForCompletion);
     }
 
     void scheduleOperation(QueuedOperation* operation)
     {
-        m_pixmapsGenerationThread->scheduleOperation(operation);
+        m_texturesGenerator->scheduleOperation(operation);
+    }
+
+    // Number of threads painting tiles in parallel
+    void setTexturesGeneratorCount(int count)
+    {
+        m_texturesGenerator->setActiveWorkerCount(count);
     }
 
     void swapLayersTextures(LayerAndroid* newTree, LayerAndroid* oldTree);
@@ -93,6 +104,12 @@ public:
 
     BaseTileTexture* getAvailableTexture(BaseTile* owner);
 
+    // Number of textures handed out by getAvailableTexture that had no owner,
+    // were recycled from the same page at another scale, or were stolen from
+    // the least recently drawn tile, and number of requests that failed.
+    void gatherTexturePicks(unsigned int* freePicks, unsigned int* scalePicks,
+                            unsigned int* stolenPicks, unsigned int* failedPicks);
+
     void markGeneratorAsReady()
     {
         {
@@ -213,12 +230,15 @@ private:
                                   WTF::Vector<BaseTileTexture*>& textures);
 
     Vector<BaseTileTexture*> m_textures;
-    Vector<BaseTileTexture*> m_availableTextures;
+    TexturePool m_availableTextures;
 
     Vector<BaseTileTexture*> m_tilesTextures;
-    Vector<BaseTileTexture*> m_availableTilesTextures;
+    TexturePool m_availableTilesTextures;
     bool m_layerTexturesRemain;
 
+    // counters by TexturePool::PickType, NoPick counting the failures
+    unsigned int m_texturePicks[TexturePool::StealPick + 1];
+
     Vector<PaintedSurface*> m_paintedSurfaces;
 
     int m_maxTextureCount;
@@ -232,7 +252,7 @@ private:
 
     bool m_useMinimalMemory;
 
-    sp<TexturesGenerator> m_pixmapsGenerationThread;
+    sp<TexturesGenerator> m_texturesGenerator;
 
     android::Mutex m_texturesLock;
     android::Mutex m_generatorLock;
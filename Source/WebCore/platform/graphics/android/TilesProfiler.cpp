@@ -29,6 +29,9 @@
 #if USE(ACCELERATED_COMPOSITING)
 
 #include "TilesManager.h"
+#include <cutils/atomic.h>
+#include <stdio.h>
+#include <unistd.h>
 #include <wtf/CurrentTime.h>
 
 #ifdef DEBUG
@@ -51,9 +54,18 @@
 #define INVAL_CODE -2
 
 namespace WebCore {
+
+static const char* timingNames[] = { "paint", "queue_wait", "blit", "steal" };
+static const char* timingUnits[] = { "us", "us", "us", "frames" };
+
 TilesProfiler::TilesProfiler()
     : m_enabled(false)
+    , m_goodTiles(0)
+    , m_badTiles(0)
 {
+    memset(m_timings, 0, sizeof(m_timings));
+    memset(m_timingTotals, 0, sizeof(m_timingTotals));
+    memset(m_overflowTimingTotals, 0, sizeof(m_overflowTimingTotals));
 }
 
 void TilesProfiler::start()
@@ -62,6 +74,14 @@ void TilesProfiler::start()
     m_goodTiles = 0;
     m_badTiles = 0;
     m_records.clear();
+    memset(m_timings, 0, sizeof(m_timings));
+    // keep the slot owners, the threads keep recording into their slot
+    for (int i = 0; i < TIMING_SLOTS; i++)
+        memset(m_timingTotals[i].totals, 0, sizeof(m_timingTotals[i].totals));
+    {
+        android::Mutex::Autolock lock(m_overflowTimingTotalsLock);
+        memset(m_overflowTimingTotals, 0, sizeof(m_overflowTimingTotals));
+    }
     m_time = currentTimeMS();
     XLOG("initializing tileprofiling");
 }
@@ -138,6 +158,94 @@ void TilesProfiler::nextInval(const IntRect& rect, float scale)
          rect.maxX(), rect.maxY(), scale);
 }
 
+void TilesProfiler::recordTiming(TimingType type, unsigned int value)
+{
+    if (!m_enabled)
+        return;
+
+    int bucket = 0;
+    for (unsigned int v = value + 1; v > 1 && bucket < TIMING_BUCKETS - 1; v >>= 1)
+        bucket++;
+
+    android_atomic_inc(&m_timings[type][bucket]);
+
+    TimingTotals* slot = timingTotalsForCurrentThread();
+    if (!slot) {
+        android::Mutex::Autolock lock(m_overflowTimingTotalsLock);
+        m_overflowTimingTotals[type] += value;
+        return;
+    }
+
+    // only this thread writes the slot
+    int32_t sequence = slot->sequence;
+    android_atomic_acquire_cas(sequence, sequence + 1, &slot->sequence);
+    slot->totals[type] += value;
+    android_atomic_inc(&slot->sequence);
+}
+
+TilesProfiler::TimingTotals* TilesProfiler::timingTotalsForCurrentThread()
+{
+    int32_t thread = gettid();
+    for (int i = 0; i < TIMING_SLOTS; i++) {
+        if (m_timingTotals[i].owner == thread)
+            return &m_timingTotals[i];
+    }
+    for (int i = 0; i < TIMING_SLOTS; i++) {
+        if (!m_timingTotals[i].owner
+            && !android_atomic_release_cas(0, thread, &m_timingTotals[i].owner))
+            return &m_timingTotals[i];
+    }
+    return 0;
+}
+
+uint64_t TilesProfiler::timingTotal(TimingType type)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < TIMING_SLOTS; i++) {
+        TimingTotals& slot = m_timingTotals[i];
+        uint64_t value;
+        int32_t sequence;
+        do {
+            sequence = android_atomic_acquire_load(&slot.sequence);
+            value = slot.totals[type];
+            // retry if the owner was updating the slot meanwhile
+        } while ((sequence & 1) || android_atomic_release_cas(sequence, sequence, &slot.sequence));
+        total += value;
+    }
+
+    android::Mutex::Autolock lock(m_overflowTimingTotalsLock);
+    return total + m_overflowTimingTotals[type];
+}
+
+bool TilesProfiler::dumpTimings(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        XLOG("couldn't open %s to dump the tile timings", path);
+        return false;
+    }
+
+    fprintf(file, "{\"frames\":%d,\"good_tiles\":%u,\"bad_tiles\":%u,\"timings\":[",
+            m_records.size(), m_goodTiles, m_badTiles);
+    for (int type = 0; type < TimingTypeCount; type++) {
+        int count = 0;
+        for (int bucket = 0; bucket < TIMING_BUCKETS; bucket++)
+            count += m_timings[type][bucket];
+
+        uint64_t total = timingTotal(static_cast<TimingType>(type));
+        fprintf(file, "%s{\"name\":\"%s\",\"unit\":\"%s\",\"count\":%d,\"total\":%llu,\"buckets\":[",
+                type ? "," : "", timingNames[type], timingUnits[type],
+                count, static_cast<unsigned long long>(total));
+        for (int bucket = 0; bucket < TIMING_BUCKETS; bucket++)
+            fprintf(file, "%s%d", bucket ? "," : "", m_timings[type][bucket]);
+        fprintf(file, "]}");
+    }
+    fprintf(file, "]}\n");
+
+    fclose(file);
+    return true;
+}
+
 } // namespace WebCore
 
 #endif // USE(ACCELERATED_COMPOSITING)
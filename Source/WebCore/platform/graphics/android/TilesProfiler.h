@@ -31,6 +31,7 @@
 #include "BaseTile.h"
 #include "IntRect.h"
 #include "Vector.h"
+#include <utils/threads.h>
 
 namespace WebCore {
 
@@ -52,6 +53,15 @@ struct TileProfileRecord {
 
 class TilesProfiler {
 public:
+    // Timings recorded in fixed-bucket histograms while profiling
+    enum TimingType {
+        TilePaint, // time spent painting a tile, in us
+        QueueWait, // time a tile waited for a generator thread, in us
+        TransferBlit, // CPU time of uploading a tile to its texture, in us
+        TextureSteal, // frames since the previous owner of a stolen texture was drawn
+        TimingTypeCount
+    };
+
     TilesProfiler();
 
     void start();
@@ -72,12 +82,42 @@ public:
         return &m_records[frame][tile];
     }
 
+    bool enabled() { return m_enabled; }
+    // Lock free for the first TIMING_SLOTS threads that record, can be
+    // called from any thread
+    void recordTiming(TimingType type, unsigned int value);
+    // Writes the histograms and tile counts as JSON, so that runs of
+    // different builds can be diffed
+    bool dumpTimings(const char* path);
+
 private:
+    static const int TIMING_BUCKETS = 24;
+
     bool m_enabled;
     unsigned int m_goodTiles;
     unsigned int m_badTiles;
     Vector<Vector<TileProfileRecord> > m_records;
     double m_time;
+
+    // bucket i counts the values v with 2^i <= v + 1 < 2^(i + 1)
+    int32_t m_timings[TimingTypeCount][TIMING_BUCKETS];
+    // 32 bits of microseconds overflow after about 35 minutes, and there is
+    // no 64 bit atomic add. Each recording thread claims a slot and is its
+    // only writer, so the totals take no lock; the sequence count, odd while
+    // the owner updates the slot, lets dumpTimings() read them consistently.
+    static const int TIMING_SLOTS = 8;
+    struct TimingTotals {
+        int32_t owner; // thread id of the writer, 0 if the slot is free
+        int32_t sequence;
+        uint64_t totals[TimingTypeCount];
+    };
+    TimingTotals* timingTotalsForCurrentThread();
+    uint64_t timingTotal(TimingType type);
+
+    TimingTotals m_timingTotals[TIMING_SLOTS];
+    // used by the threads beyond the first TIMING_SLOTS
+    android::Mutex m_overflowTimingTotalsLock;
+    uint64_t m_overflowTimingTotals[TimingTypeCount];
 };
 
 } // namespace WebCore
@@ -30,11 +30,15 @@
 
 #include "BaseTile.h"
 #include "PaintedSurface.h"
+#include "PixelBufferPool.h"
+#include "TilesManager.h"
+#include <algorithm>
 #include <android/native_window.h>
 #include <gui/SurfaceTexture.h>
 #include <gui/SurfaceTextureClient.h>
 
 #include <cutils/log.h>
+#include <wtf/CurrentTime.h>
 #include <wtf/text/CString.h>
 #define XLOGC(...) android_printLog(ANDROID_LOG_DEBUG, "TransferQueue", __VA_ARGS__)
 
@@ -89,6 +93,7 @@ void TransferQueue::initSharedSurfaceTextures(int width, int height)
 {
     if (!m_sharedSurfaceTextureId) {
         glGenTextures(1, &m_sharedSurfaceTextureId);
+        TilesManager::instance()->shader()->forgetTexture(m_sharedSurfaceTextureId);
         m_sharedSurfaceTexture =
 #if GPU_UPLOAD_WITHOUT_DRAW
             new android::SurfaceTexture(m_sharedSurfaceTextureId, true, GL_TEXTURE_2D);
@@ -141,21 +146,56 @@ bool TransferQueue::checkObsolete(int index)
     return false;
 }
 
-void TransferQueue::blitTileFromQueue(GLuint fboID, BaseTileTexture* destTex,
-                                      GLuint srcTexId, GLenum srcTexTarget,
-                                      int index)
+// A partial update is painted against the content the tile had at the time.
+// If the update was meant for another texture, or if the texture holding
+// the previous content got stolen meanwhile, the update can't be applied.
+bool TransferQueue::checkPartialUpdate(int index, BaseTileTexture* destTex)
+{
+    const TileTransferData* item = &m_transferQueue[index];
+    const SkIRect& rect = item->dirtyRect;
+    if (!rect.fLeft && !rect.fTop
+        && rect.width() == destTex->getSize().width()
+        && rect.height() == destTex->getSize().height())
+        return true;
+
+    if (destTex != item->savedBaseTileTexturePtr) {
+        XLOG("Partial update for texture %p, but tile now uses %p",
+             item->savedBaseTileTexturePtr, destTex);
+        return false;
+    }
+
+    BaseTileTexture* sourceTex = item->sourceBaseTileTexturePtr;
+    if (sourceTex && (sourceTex->owner() != item->savedBaseTilePtr
+                      || !sourceTex->readyFor(item->savedBaseTilePtr))) {
+        XLOG("Partial update source texture %p lost its content", sourceTex);
+        return false;
+    }
+
+    return true;
+}
+
+SkIRect TransferQueue::tileDirtyRect(const TileRenderInfo* renderInfo,
+                                     const SkBitmap* bitmap)
+{
+    SkIRect rect = SkIRect::MakeWH(TilesManager::instance()->tileWidth(),
+                                   TilesManager::instance()->tileHeight());
+    if (renderInfo->invalRect && !rect.intersect(*renderInfo->invalRect))
+        rect.setEmpty();
+
+    // the bitmap holds the inval rect at its origin
+    if (bitmap) {
+        rect.fRight = std::min(rect.fRight, rect.fLeft + bitmap->width());
+        rect.fBottom = std::min(rect.fBottom, rect.fTop + bitmap->height());
+    }
+    return rect;
+}
+
+void TransferQueue::blitRect(GLuint fboID, BaseTileTexture* destTex,
+                             GLuint srcTexId, GLenum srcTexTarget,
+                             const SkIRect& rect)
 {
 #if GPU_UPLOAD_WITHOUT_DRAW
-    glBindFramebuffer(GL_FRAMEBUFFER, fboID);
-    glFramebufferTexture2D(GL_FRAMEBUFFER,
-                           GL_COLOR_ATTACHMENT0,
-                           GL_TEXTURE_2D,
-                           srcTexId,
-                           0);
-    glBindTexture(GL_TEXTURE_2D, destTex->m_ownTextureId);
-    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0,
-                        destTex->getSize().width(),
-                        destTex->getSize().height());
+    copyRect(fboID, destTex, srcTexId, rect);
 #else
     // Then set up the FBO and copy the SurfTex content in.
     glBindFramebuffer(GL_FRAMEBUFFER, fboID);
@@ -173,11 +213,42 @@ void TransferQueue::blitTileFromQueue(GLuint fboID, BaseTileTexture* destTex,
         return;
     }
 
+    // Only touch the pixels of the rect, the rest of the source is stale.
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(rect.fLeft, rect.fTop, rect.width(), rect.height());
+
     // Use empty rect to set up the special matrix to draw.
-    SkRect rect  = SkRect::MakeEmpty();
-    TilesManager::instance()->shader()->drawQuad(rect, srcTexId, 1.0,
+    SkRect quadRect  = SkRect::MakeEmpty();
+    TilesManager::instance()->shader()->drawQuad(quadRect, srcTexId, 1.0,
                        srcTexTarget, GL_NEAREST);
 
+    glDisable(GL_SCISSOR_TEST);
+#endif
+}
+
+void TransferQueue::copyRect(GLuint fboID, BaseTileTexture* destTex,
+                             GLuint srcTexId, const SkIRect& rect)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fboID);
+    glFramebufferTexture2D(GL_FRAMEBUFFER,
+                           GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D,
+                           srcTexId,
+                           0);
+    glBindTexture(GL_TEXTURE_2D, destTex->m_ownTextureId);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, rect.fLeft, rect.fTop,
+                        rect.fLeft, rect.fTop,
+                        rect.width(), rect.height());
+}
+
+void TransferQueue::blitTileFromQueue(GLuint fboID, BaseTileTexture* destTex,
+                                      GLuint srcTexId, GLenum srcTexTarget,
+                                      int index)
+{
+    blitRect(fboID, destTex, srcTexId, srcTexTarget,
+             m_transferQueue[index].dirtyRect);
+
+#if !GPU_UPLOAD_WITHOUT_DRAW
     // To workaround a sync issue on some platforms, we should insert the sync
     // here while in the current FBO.
     // This will essentially kick off the GPU command buffer, and the Tex Gen
@@ -294,29 +365,68 @@ void TransferQueue::updateDirtyBaseTiles()
             bool obsoleteBaseTile = checkObsolete(index);
             // Save the needed info, update the Surf Tex, clean up the item in
             // the queue. Then either move on to next item or copy the content.
+            BaseTile* baseTile = m_transferQueue[index].savedBaseTilePtr;
             BaseTileTexture* destTexture = 0;
-            if (!obsoleteBaseTile)
-                destTexture = m_transferQueue[index].savedBaseTilePtr->backTexture();
+            bool lostPartialUpdate = false;
+            if (!obsoleteBaseTile) {
+                destTexture = baseTile->backTexture();
+                lostPartialUpdate = !checkPartialUpdate(index, destTexture);
+            }
+            BaseTileTexture* sourceTexture = m_transferQueue[index].sourceBaseTileTexturePtr;
+            const SkIRect& dirtyRect = m_transferQueue[index].dirtyRect;
             if (m_transferQueue[index].uploadType == GpuUpload) {
                 status_t result = m_sharedSurfaceTexture->updateTexImage();
                 if (result != OK)
                     XLOGC("unexpected error: updateTexImage return %d", result);
             }
             m_transferQueue[index].savedBaseTilePtr = 0;
+            m_transferQueue[index].sourceBaseTileTexturePtr = 0;
             m_transferQueue[index].status = emptyItem;
             if (obsoleteBaseTile) {
                 XLOG("Warning: the texture is obsolete for this baseTile");
                 index = (index + 1) % ST_BUFFER_NUMBER;
                 continue;
             }
+            if (lostPartialUpdate) {
+                // Drop the back texture, so that the following updates for
+                // the tile are obsolete too, and the tile gets fully repainted.
+                XLOG("Warning: lost the content below the update of tile %p", baseTile);
+                baseTile->discardBackTexture();
+                index = (index + 1) % ST_BUFFER_NUMBER;
+                continue;
+            }
+
+            TilesProfiler* profiler = TilesManager::instance()->getProfiler();
+            double uploadStartTime = profiler->enabled() ? currentTimeMS() : 0;
 
             // guarantee that we have a texture to blit into
             destTexture->requireGLTexture();
 
+            // Bring in the previous content of the tile, the update only
+            // covers the dirty rect. This must be an identity copy: drawing
+            // it would invert it again when the screen is inverted.
+            if (sourceTexture) {
+                if (!usedFboForUpload) {
+                    saveGLState();
+                    usedFboForUpload = true;
+                }
+                copyRect(m_fboID, destTexture, sourceTexture->m_ownTextureId,
+                         SkIRect::MakeWH(destTexture->getSize().width(),
+                                         destTexture->getSize().height()));
+            }
+
             if (m_transferQueue[index].uploadType == CpuUpload) {
-                // Here we just need to upload the bitmap content to the GL Texture
-                GLUtils::updateTextureWithBitmap(destTexture->m_ownTextureId, 0, 0,
-                                                 *m_transferQueue[index].bitmap);
+                // Here we just need to upload the bitmap content to the GL
+                // Texture. The dirty rect is packed at the bitmap's origin.
+                SkBitmap* bitmap = m_transferQueue[index].bitmap;
+                SkBitmap dirtyBitmap;
+                dirtyBitmap.setConfig(bitmap->config(), dirtyRect.width(), dirtyRect.height());
+                bitmap->lockPixels();
+                dirtyBitmap.setPixels(bitmap->getPixels());
+                GLUtils::updateTextureWithBitmap(destTexture->m_ownTextureId,
+                                                 dirtyRect.fLeft, dirtyRect.fTop,
+                                                 dirtyBitmap);
+                bitmap->unlockPixels();
             } else {
                 if (!usedFboForUpload) {
                     saveGLState();
@@ -328,6 +438,11 @@ void TransferQueue::updateDirtyBaseTiles()
                                   index);
             }
 
+            if (uploadStartTime) {
+                profiler->recordTiming(TilesProfiler::TransferBlit,
+                                       (currentTimeMS() - uploadStartTime) * 1000);
+            }
+
             // After the base tile copied into the GL texture, we need to
             // update the texture's info such that at draw time, readyFor
             // will find the latest texture's info
@@ -372,6 +487,7 @@ void TransferQueue::updateQueueWithBitmap(const TileRenderInfo* renderInfo,
 bool TransferQueue::tryUpdateQueueWithBitmap(const TileRenderInfo* renderInfo,
                                           int x, int y, const SkBitmap& bitmap)
 {
+    android::Mutex::Autolock producerLock(m_producerLock);
     m_transferQueueItemLocks.lock();
     bool ready = readyForUpdate();
     TextureUploadType currentUploadType = m_currentUploadType;
@@ -392,29 +508,28 @@ bool TransferQueue::tryUpdateQueueWithBitmap(const TileRenderInfo* renderInfo,
         if (ANativeWindow_lock(m_ANW.get(), &buffer, 0))
             return false;
 
+        // Only the dirty rect is written, at its position in the tile. The
+        // rest of the buffer is left stale and won't be blitted.
+        SkIRect dirtyRect = tileDirtyRect(renderInfo, &bitmap);
         uint8_t* img = (uint8_t*)buffer.bits;
-        int row, col;
+        int row;
         int bpp = 4; // Now we only deal with RGBA8888 format.
-        int width = TilesManager::instance()->tileWidth();
-        int height = TilesManager::instance()->tileHeight();
-        if (!x && !y && bitmap.width() == width && bitmap.height() == height) {
-            bitmap.lockPixels();
-            uint8_t* bitmapOrigin = static_cast<uint8_t*>(bitmap.getPixels());
-            if (buffer.stride != bitmap.width())
-                // Copied line by line since we need to handle the offsets and stride.
-                for (row = 0 ; row < bitmap.height(); row ++) {
-                    uint8_t* dst = &(img[buffer.stride * row * bpp]);
-                    uint8_t* src = &(bitmapOrigin[bitmap.width() * row * bpp]);
-                    memcpy(dst, src, bpp * bitmap.width());
-                }
-            else
-                memcpy(img, bitmapOrigin, bpp * bitmap.width() * bitmap.height());
-
-            bitmap.unlockPixels();
-        } else {
-            // TODO: implement the partial invalidate here!
-            XLOG("ERROR: don't expect to get here yet before we support partial inval");
-        }
+        bitmap.lockPixels();
+        uint8_t* bitmapOrigin = static_cast<uint8_t*>(bitmap.getPixels());
+        const int rowBytes = bpp * dirtyRect.width();
+        if (!dirtyRect.fLeft && !dirtyRect.fTop
+            && buffer.stride == dirtyRect.width()
+            && bitmap.rowBytes() == static_cast<size_t>(rowBytes))
+            memcpy(img, bitmapOrigin, rowBytes * dirtyRect.height());
+        else
+            // Copied line by line since we need to handle the offsets and stride.
+            for (row = 0 ; row < dirtyRect.height(); row ++) {
+                uint8_t* dst = &(img[(buffer.stride * (dirtyRect.fTop + row)
+                                      + dirtyRect.fLeft) * bpp]);
+                uint8_t* src = &(bitmapOrigin[bitmap.rowBytes() * row]);
+                memcpy(dst, src, rowBytes);
+            }
+        bitmap.unlockPixels();
 
         ANativeWindow_unlockAndPost(m_ANW.get());
     }
@@ -443,19 +558,44 @@ void TransferQueue::addItemInTransferQueue(const TileRenderInfo* renderInfo,
         XLOG("ERROR update a tile which is dirty already @ index %d", index);
     }
 
+    SkIRect dirtyRect = tileDirtyRect(renderInfo, bitmap);
+
     m_transferQueue[index].savedBaseTileTexturePtr = renderInfo->baseTile->backTexture();
     m_transferQueue[index].savedBaseTilePtr = renderInfo->baseTile;
+    m_transferQueue[index].sourceBaseTileTexturePtr = renderInfo->sourceTexture;
     m_transferQueue[index].status = pendingBlit;
     m_transferQueue[index].uploadType = type;
+    m_transferQueue[index].dirtyRect = dirtyRect;
     if (type == CpuUpload && bitmap) {
-        // Lazily create the bitmap
-        if (!m_transferQueue[index].bitmap) {
-            m_transferQueue[index].bitmap = new SkBitmap();
-            int w = bitmap->width();
-            int h = bitmap->height();
-            m_transferQueue[index].bitmap->setConfig(bitmap->config(), w, h);
+        // Lazily create the bitmap, big enough to hold a whole tile
+        SkBitmap* dirtyBitmap = m_transferQueue[index].bitmap;
+        int w = bitmap->width();
+        int h = bitmap->height();
+        if (!dirtyBitmap) {
+            dirtyBitmap = new SkBitmap();
+            m_transferQueue[index].bitmap = dirtyBitmap;
+        }
+        if (dirtyBitmap->config() != bitmap->config()
+            || dirtyBitmap->width() * dirtyBitmap->height() < w * h) {
+            dirtyBitmap->setConfig(bitmap->config(), w, h);
+            dirtyBitmap->allocPixels(PixelBufferPool::instance(), 0);
+        }
+
+        // Only copy the dirty rect, packed at the origin of the bitmap.
+        const size_t rowBytes = dirtyRect.width() * bitmap->bytesPerPixel();
+        bitmap->lockPixels();
+        dirtyBitmap->lockPixels();
+        const uint8_t* src = static_cast<const uint8_t*>(bitmap->getPixels());
+        uint8_t* dst = static_cast<uint8_t*>(dirtyBitmap->getPixels());
+        if (src && dst) {
+            for (int row = 0; row < dirtyRect.height(); row++)
+                memcpy(dst + row * rowBytes, src + row * bitmap->rowBytes(), rowBytes);
         }
-        bitmap->copyTo(m_transferQueue[index].bitmap, bitmap->config());
+        dirtyBitmap->unlockPixels();
+        bitmap->unlockPixels();
+    } else if (m_transferQueue[index].bitmap) {
+        // Not uploading from the CPU anymore, give the pixels back
+        m_transferQueue[index].bitmap->reset();
     }
 
     // Now fill the tileInfo.
@@ -513,6 +653,7 @@ void TransferQueue::cleanupTransportQueue()
 
             m_transferQueue[index].savedBaseTilePtr = 0;
             m_transferQueue[index].savedBaseTileTexturePtr = 0;
+            m_transferQueue[index].sourceBaseTileTexturePtr = 0;
             m_transferQueue[index].status = emptyItem;
         }
         index = (index + 1) % ST_BUFFER_NUMBER;
@@ -551,6 +692,8 @@ void TransferQueue::restoreGLState()
 
     if (m_GLStateBeforeBlit.scissor[0])
         glEnable(GL_SCISSOR_TEST);
+    else
+        glDisable(GL_SCISSOR_TEST);
 
     if (m_GLStateBeforeBlit.depth[0])
         glEnable(GL_DEPTH_TEST);
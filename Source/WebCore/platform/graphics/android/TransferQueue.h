@@ -71,10 +71,12 @@ public:
     : status(emptyItem)
     , savedBaseTilePtr(0)
     , savedBaseTileTexturePtr(0)
+    , sourceBaseTileTexturePtr(0)
     , uploadType(DEFAULT_UPLOAD_TYPE)
     , bitmap(0)
     , m_syncKHR(EGL_NO_SYNC_KHR)
     {
+        dirtyRect.setEmpty();
     }
 
     ~TileTransferData()
@@ -86,8 +88,17 @@ public:
     TransferItemStatus status;
     BaseTile* savedBaseTilePtr;
     BaseTileTexture* savedBaseTileTexturePtr;
+    // Texture holding the tile's previous content, copied into the saved
+    // texture before blitting a partial update. Null if there is nothing to
+    // copy, i.e. the update covers the whole tile or goes on top of the
+    // content of the saved texture itself.
+    BaseTileTexture* sourceBaseTileTexturePtr;
     TextureTileInfo tileInfo;
     TextureUploadType uploadType;
+    // Area of the tile, in tile coordinates, this item updates. The Surface
+    // Texture buffer holds it at the same position, while the Cpu upload
+    // bitmap holds it tightly packed at its origin.
+    SkIRect dirtyRect;
     // This is only useful in Cpu upload code path, so it will be dynamically
     // lazily allocated.
     SkBitmap* bitmap;
@@ -158,6 +169,15 @@ private:
     // Check the current transfer queue item is obsolete or not.
     bool checkObsolete(int index);
 
+    // A partial update can only be applied on top of the content it was
+    // painted against. Check this content is still around.
+    bool checkPartialUpdate(int index, BaseTileTexture* destTex);
+
+    // Clip the renderInfo's inval rect to the tile, and to the bitmap
+    // holding its content if any.
+    static SkIRect tileDirtyRect(const TileRenderInfo* renderInfo,
+                                 const SkBitmap* bitmap);
+
     // Before each draw call and the blit operation, clean up all the
     // pendingDiscard items.
     void cleanupTransportQueue();
@@ -166,6 +186,17 @@ private:
                            GLuint srcTexId, GLenum srcTexTarget,
                            int index);
 
+    // Copy the rect of the source texture into the same rect of destTex.
+    void blitRect(GLuint fboID, BaseTileTexture* destTex,
+                  GLuint srcTexId, GLenum srcTexTarget,
+                  const SkIRect& rect);
+
+    // Same as blitRect() for a GL_TEXTURE_2D source, but never goes through
+    // the shader, so the pixels are copied as they are even when the
+    // screen is inverted.
+    void copyRect(GLuint fboID, BaseTileTexture* destTex,
+                  GLuint srcTexId, const SkIRect& rect);
+
     // Note that the m_transferQueueIndex only changed in the TexGen thread
     // where we are going to move on to update the next item in the queue.
     int m_transferQueueIndex;
@@ -196,6 +227,11 @@ private:
     android::Mutex m_transferQueueItemLocks;
     android::Condition m_transferQueueItemCond;
 
+    // Several TexturesGenerator threads can produce tiles at once. Only one
+    // of them at a time may reserve an item, fill the Surface Texture buffer
+    // and publish the item, so that buffers and items stay in the same order.
+    android::Mutex m_producerLock;
+
     EGLDisplay m_currentDisplay;
 
     // This should be GpuUpload for production, but for debug purpose or working
@@ -126,6 +126,7 @@ GLuint VideoLayerAndroid::createBackgroundTexture()
 {
     GLuint texture;
     glGenTextures(1, &texture);
+    TilesManager::instance()->shader()->forgetTexture(texture);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     GLubyte pixels[4 *3] = {
         128, 128, 128,
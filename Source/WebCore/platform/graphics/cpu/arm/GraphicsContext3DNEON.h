@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GraphicsContext3DNEON_h
+#define GraphicsContext3DNEON_h
+
+#include <wtf/Platform.h>
+
+#if CPU(ARM_NEON) && COMPILER(GCC)
+
+#include <arm_neon.h>
+#include <stdint.h>
+
+namespace WebCore {
+
+namespace SIMD {
+
+// Each routine converts as many whole blocks of eight RGBA8 (or BGRA8)
+// pixels as the row holds and returns the number of pixels converted.
+// The caller finishes the row with the scalar packing functions. The
+// alpha operations multiply in single precision with the same per-alpha
+// scale factors as the scalar code and truncate, so the results are
+// bit-exact with GraphicsContext3D.cpp.
+
+ALWAYS_INLINE uint8x8_t scaleChannel(uint8x8_t channel, float32x4_t scaleLow, float32x4_t scaleHigh)
+{
+    uint16x8_t wide = vmovl_u8(channel);
+    float32x4_t low = vcvtq_f32_u32(vmovl_u16(vget_low_u16(wide)));
+    float32x4_t high = vcvtq_f32_u32(vmovl_u16(vget_high_u16(wide)));
+    uint32x4_t scaledLow = vcvtq_u32_f32(vmulq_f32(low, scaleLow));
+    uint32x4_t scaledHigh = vcvtq_u32_f32(vmulq_f32(high, scaleHigh));
+    // Narrowing without saturation keeps the low byte, like the scalar cast.
+    return vmovn_u16(vcombine_u16(vmovn_u32(scaledLow), vmovn_u32(scaledHigh)));
+}
+
+ALWAYS_INLINE void loadScales(const uint8_t* source, const float* scaleTable,
+                              float32x4_t& scaleLow, float32x4_t& scaleHigh)
+{
+    float scales[8];
+    for (int i = 0; i < 8; ++i)
+        scales[i] = scaleTable[source[i * 4 + 3]];
+    scaleLow = vld1q_f32(scales);
+    scaleHigh = vld1q_f32(scales + 4);
+}
+
+ALWAYS_INLINE unsigned packOneRowOfRGBA8ToRGBA8Scaled(const uint8_t* source, uint8_t* destination,
+                                                      unsigned pixelCount, const float* scaleTable,
+                                                      bool swapRedAndBlue)
+{
+    unsigned blocks = pixelCount / 8;
+    for (unsigned i = 0; i < blocks; ++i) {
+        float32x4_t scaleLow, scaleHigh;
+        loadScales(source, scaleTable, scaleLow, scaleHigh);
+        uint8x8x4_t pixels = vld4_u8(source);
+        uint8x8_t red = swapRedAndBlue ? pixels.val[2] : pixels.val[0];
+        uint8x8_t blue = swapRedAndBlue ? pixels.val[0] : pixels.val[2];
+        pixels.val[0] = scaleChannel(red, scaleLow, scaleHigh);
+        pixels.val[1] = scaleChannel(pixels.val[1], scaleLow, scaleHigh);
+        pixels.val[2] = scaleChannel(blue, scaleLow, scaleHigh);
+        vst4_u8(destination, pixels);
+        source += 32;
+        destination += 32;
+    }
+    return blocks * 8;
+}
+
+ALWAYS_INLINE unsigned packOneRowOfRGBA8ToRGB8Scaled(const uint8_t* source, uint8_t* destination,
+                                                     unsigned pixelCount, const float* scaleTable)
+{
+    unsigned blocks = pixelCount / 8;
+    for (unsigned i = 0; i < blocks; ++i) {
+        float32x4_t scaleLow, scaleHigh;
+        loadScales(source, scaleTable, scaleLow, scaleHigh);
+        uint8x8x4_t pixels = vld4_u8(source);
+        uint8x8x3_t result;
+        result.val[0] = scaleChannel(pixels.val[0], scaleLow, scaleHigh);
+        result.val[1] = scaleChannel(pixels.val[1], scaleLow, scaleHigh);
+        result.val[2] = scaleChannel(pixels.val[2], scaleLow, scaleHigh);
+        vst3_u8(destination, result);
+        source += 32;
+        destination += 24;
+    }
+    return blocks * 8;
+}
+
+ALWAYS_INLINE unsigned packOneRowOfRGBA8ToRGB8(const uint8_t* source, uint8_t* destination,
+                                               unsigned pixelCount)
+{
+    unsigned blocks = pixelCount / 8;
+    for (unsigned i = 0; i < blocks; ++i) {
+        uint8x8x4_t pixels = vld4_u8(source);
+        uint8x8x3_t result;
+        result.val[0] = pixels.val[0];
+        result.val[1] = pixels.val[1];
+        result.val[2] = pixels.val[2];
+        vst3_u8(destination, result);
+        source += 32;
+        destination += 24;
+    }
+    return blocks * 8;
+}
+
+ALWAYS_INLINE unsigned packOneRowOfBGRA8ToRGBA8(const uint8_t* source, uint8_t* destination,
+                                                unsigned pixelCount)
+{
+    unsigned blocks = pixelCount / 8;
+    for (unsigned i = 0; i < blocks; ++i) {
+        uint8x8x4_t pixels = vld4_u8(source);
+        uint8x8_t blue = pixels.val[0];
+        pixels.val[0] = pixels.val[2];
+        pixels.val[2] = blue;
+        vst4_u8(destination, pixels);
+        source += 32;
+        destination += 32;
+    }
+    return blocks * 8;
+}
+
+ALWAYS_INLINE unsigned packOneRowOfRGBA8ToUnsignedShort565(const uint8_t* source, uint16_t* destination,
+                                                           unsigned pixelCount)
+{
+    unsigned blocks = pixelCount / 8;
+    for (unsigned i = 0; i < blocks; ++i) {
+        uint8x8x4_t pixels = vld4_u8(source);
+        uint16x8_t red = vshll_n_u8(vand_u8(pixels.val[0], vdup_n_u8(0xF8)), 8);
+        uint16x8_t green = vshll_n_u8(vand_u8(pixels.val[1], vdup_n_u8(0xFC)), 3);
+        uint16x8_t blue = vmovl_u8(vshr_n_u8(pixels.val[2], 3));
+        vst1q_u16(destination, vorrq_u16(vorrq_u16(red, green), blue));
+        source += 32;
+        destination += 8;
+    }
+    return blocks * 8;
+}
+
+} // namespace SIMD
+
+} // namespace WebCore
+
+#endif // CPU(ARM_NEON) && COMPILER(GCC)
+
+#endif // GraphicsContext3DNEON_h
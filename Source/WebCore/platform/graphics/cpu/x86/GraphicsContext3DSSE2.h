@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GraphicsContext3DSSE2_h
+#define GraphicsContext3DSSE2_h
+
+#include <wtf/Platform.h>
+
+#if (CPU(X86) || CPU(X86_64)) && defined(__SSE2__) && COMPILER(GCC)
+
+#include <emmintrin.h>
+#include <stdint.h>
+
+namespace WebCore {
+
+namespace SIMD {
+
+// Same contract as the NEON routines: whole blocks of four pixels are
+// converted, the number of pixels done is returned and the caller finishes
+// the row with the scalar code. Results are bit-exact with the scalar code.
+
+// Swaps bytes 0 and 2 of every 32-bit pixel.
+ALWAYS_INLINE __m128i swapRedAndBlue(__m128i pixels)
+{
+    const __m128i greenAndAlpha = _mm_set1_epi32(0xFF00FF00);
+    const __m128i lowByte = _mm_set1_epi32(0x000000FF);
+    __m128i red = _mm_and_si128(_mm_srli_epi32(pixels, 16), lowByte);
+    __m128i blue = _mm_slli_epi32(_mm_and_si128(pixels, lowByte), 16);
+    return _mm_or_si128(_mm_and_si128(pixels, greenAndAlpha), _mm_or_si128(red, blue));
+}
+
+// Scales the color channels of one pixel, given as four 32-bit integers,
+// leaving alpha untouched.
+ALWAYS_INLINE __m128i scalePixel(__m128i pixel, float scale)
+{
+    __m128 scaled = _mm_mul_ps(_mm_cvtepi32_ps(pixel), _mm_set_ps(1.0f, scale, scale, scale));
+    // Keep the low byte, like the scalar cast, so that packing cannot saturate.
+    return _mm_and_si128(_mm_cvttps_epi32(scaled), _mm_set1_epi32(0xFF));
+}
+
+ALWAYS_INLINE unsigned packOneRowOfRGBA8ToRGBA8Scaled(const uint8_t* source, uint8_t* destination,
+                                                      unsigned pixelCount, const float* scaleTable,
+                                                      bool swapRedAndBlueChannels)
+{
+    const __m128i zero = _mm_setzero_si128();
+    unsigned blocks = pixelCount / 4;
+    for (unsigned i = 0; i < blocks; ++i) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+        if (swapRedAndBlueChannels)
+            pixels = swapRedAndBlue(pixels);
+        __m128i low = _mm_unpacklo_epi8(pixels, zero);
+        __m128i high = _mm_unpackhi_epi8(pixels, zero);
+        __m128i pixel0 = scalePixel(_mm_unpacklo_epi16(low, zero), scaleTable[source[3]]);
+        __m128i pixel1 = scalePixel(_mm_unpackhi_epi16(low, zero), scaleTable[source[7]]);
+        __m128i pixel2 = scalePixel(_mm_unpacklo_epi16(high, zero), scaleTable[source[11]]);
+        __m128i pixel3 = scalePixel(_mm_unpackhi_epi16(high, zero), scaleTable[source[15]]);
+        __m128i result = _mm_packus_epi16(_mm_packs_epi32(pixel0, pixel1), _mm_packs_epi32(pixel2, pixel3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), result);
+        source += 16;
+        destination += 16;
+    }
+    return blocks * 4;
+}
+
+ALWAYS_INLINE unsigned packOneRowOfBGRA8ToRGBA8(const uint8_t* source, uint8_t* destination,
+                                                unsigned pixelCount)
+{
+    unsigned blocks = pixelCount / 4;
+    for (unsigned i = 0; i < blocks; ++i) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), swapRedAndBlue(pixels));
+        source += 16;
+        destination += 16;
+    }
+    return blocks * 4;
+}
+
+ALWAYS_INLINE unsigned packOneRowOfRGBA8ToUnsignedShort565(const uint8_t* source, uint16_t* destination,
+                                                           unsigned pixelCount)
+{
+    unsigned blocks = pixelCount / 8;
+    for (unsigned i = 0; i < blocks; ++i) {
+        __m128i packed[2];
+        for (int j = 0; j < 2; ++j) {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + j * 16));
+            __m128i red = _mm_slli_epi32(_mm_and_si128(pixels, _mm_set1_epi32(0xF8)), 8);
+            __m128i green = _mm_srli_epi32(_mm_and_si128(pixels, _mm_set1_epi32(0xFC00)), 5);
+            __m128i blue = _mm_srli_epi32(_mm_and_si128(pixels, _mm_set1_epi32(0xF80000)), 19);
+            // Sign extend so that the signed pack below keeps all 16 bits.
+            packed[j] = _mm_srai_epi32(_mm_slli_epi32(_mm_or_si128(red, _mm_or_si128(green, blue)), 16), 16);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_packs_epi32(packed[0], packed[1]));
+        source += 32;
+        destination += 8;
+    }
+    return blocks * 8;
+}
+
+} // namespace SIMD
+
+} // namespace WebCore
+
+#endif // (CPU(X86) || CPU(X86_64)) && defined(__SSE2__) && COMPILER(GCC)
+
+#endif // GraphicsContext3DSSE2_h
@@ -101,6 +101,11 @@ bool ImageFrame::setSize(int newWidth, int newHeight)
 NativeImagePtr ImageFrame::asNewNativeImage() const
 {
 #if PLATFORM(ANDROID)
+    // The decoder keeps writing into the pixels of a partial frame. Give each
+    // snapshot a new generation ID, so that caches keyed on it (e.g. the
+    // ImagesManager) don't mistake it for the previous one.
+    if (m_status != FrameComplete)
+        m_bitmap.notifyPixelsChanged();
     return new SkBitmapRef(m_bitmap);
 #else
     return new NativeImageSkia(m_bitmap);
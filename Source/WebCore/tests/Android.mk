@@ -4,6 +4,7 @@ include $(CLEAR_VARS)
 
 # Build the unit tests.
 test_src_files := \
+    GraphicsContext3DPacking_test.cpp \
     TreeManager_test.cpp
 
 shared_libraries := \
@@ -28,7 +29,9 @@ c_includes := \
     $(LOCAL_PATH)/.. \
     $(LOCAL_PATH)/../platform/graphics \
     $(LOCAL_PATH)/../platform/graphics/transforms \
-    $(LOCAL_PATH)/../platform/graphics/android
+    $(LOCAL_PATH)/../platform/graphics/android \
+    $(LOCAL_PATH)/../platform/graphics/cpu/arm \
+    $(LOCAL_PATH)/../platform/graphics/cpu/x86
 
     # external/webkit/Source/WebCore/platform/graphics/android
 
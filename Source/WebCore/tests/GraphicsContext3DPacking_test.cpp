@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2012 Sony Mobile Communications AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Sony Mobile Communications AB nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL SONY MOBILE COMMUNICATIONS AB BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <gtest/gtest.h>
+
+#include "GraphicsContext3DScaleTables.h"
+#include <vector>
+
+#if CPU(ARM_NEON) && COMPILER(GCC)
+#include "GraphicsContext3DNEON.h"
+#define HAVE_PACKING_SIMD 1
+#define HAVE_PACKING_SIMD_RGB8 1
+#elif (CPU(X86) || CPU(X86_64)) && defined(__SSE2__) && COMPILER(GCC)
+#include "GraphicsContext3DSSE2.h"
+#define HAVE_PACKING_SIMD 1
+#endif
+
+namespace WebCore {
+
+// The vectorized packing routines must give the same bytes as the scalar
+// packing functions of GraphicsContext3D.cpp, which are reproduced here,
+// for every (value, alpha) pair of every channel.
+
+static const unsigned pixelCount = 256 * 256;
+
+// One pixel per (value, alpha) pair. The three color channels are offset
+// from each other, so that a swapped channel shows up as a difference.
+static void fillAllPairs(std::vector<uint8_t>& pixels)
+{
+    pixels.resize(pixelCount * 4);
+    for (unsigned alpha = 0; alpha < 256; ++alpha) {
+        for (unsigned value = 0; value < 256; ++value) {
+            uint8_t* pixel = &pixels[0] + (alpha * 256 + value) * 4;
+            pixel[0] = value;
+            pixel[1] = (value + 85) & 0xFF;
+            pixel[2] = (value + 170) & 0xFF;
+            pixel[3] = alpha;
+        }
+    }
+}
+
+static void scalePixel(const uint8_t* source, uint8_t* destination, float scaleFactor, unsigned channels)
+{
+    destination[0] = static_cast<uint8_t>(static_cast<float>(source[0]) * scaleFactor);
+    destination[1] = static_cast<uint8_t>(static_cast<float>(source[1]) * scaleFactor);
+    destination[2] = static_cast<uint8_t>(static_cast<float>(source[2]) * scaleFactor);
+    if (channels == 4)
+        destination[3] = source[3];
+}
+
+static void packRGBA8ToRGBA8Premultiply(const uint8_t* source, uint8_t* destination)
+{
+    scalePixel(source, destination, source[3] / 255.0f, 4);
+}
+
+static void packRGBA8ToRGBA8Unmultiply(const uint8_t* source, uint8_t* destination)
+{
+    scalePixel(source, destination, 1.0f / (source[3] ? source[3] / 255.0f : 1.0f), 4);
+}
+
+static void packBGRA8ToRGBA8(const uint8_t* source, uint8_t* destination)
+{
+    destination[0] = source[2];
+    destination[1] = source[1];
+    destination[2] = source[0];
+    destination[3] = source[3];
+}
+
+static void packBGRA8ToRGBA8Premultiply(const uint8_t* source, uint8_t* destination)
+{
+    uint8_t rgba[4];
+    packBGRA8ToRGBA8(source, rgba);
+    packRGBA8ToRGBA8Premultiply(rgba, destination);
+}
+
+static void packRGBA8ToRGB8(const uint8_t* source, uint8_t* destination)
+{
+    destination[0] = source[0];
+    destination[1] = source[1];
+    destination[2] = source[2];
+}
+
+static void packRGBA8ToRGB8Premultiply(const uint8_t* source, uint8_t* destination)
+{
+    scalePixel(source, destination, source[3] / 255.0f, 3);
+}
+
+static void packRGBA8ToUnsignedShort565(const uint8_t* source, uint16_t* destination)
+{
+    *destination = (((source[0] & 0xF8) << 8)
+                    | ((source[1] & 0xFC) << 3)
+                    | ((source[2] & 0xF8) >> 3));
+}
+
+TEST(GraphicsContext3DPackingTest, ScaleTablesMatchScalarFactors)
+{
+    for (int alpha = 0; alpha < 256; ++alpha) {
+        // volatile rounds to single precision, as the scalar code stores it
+        volatile float premultiply = alpha / 255.0f;
+        volatile float unmultiply = 1.0f / (alpha ? alpha / 255.0f : 1.0f);
+        EXPECT_EQ(premultiply, SIMD::premultiplyScaleTable[alpha]) << "alpha " << alpha;
+        EXPECT_EQ(unmultiply, SIMD::unmultiplyScaleTable[alpha]) << "alpha " << alpha;
+    }
+}
+
+#if defined(HAVE_PACKING_SIMD)
+
+template<typename DestType>
+static void expectSameAsScalar(unsigned done, const std::vector<uint8_t>& source,
+                               const std::vector<DestType>& destination, unsigned channels,
+                               void packingFunc(const uint8_t*, DestType*))
+{
+    // the row holds whole blocks only, there is no scalar tail
+    ASSERT_EQ(pixelCount, done);
+    DestType expected[4];
+    for (unsigned i = 0; i < pixelCount; ++i) {
+        packingFunc(&source[0] + i * 4, expected);
+        for (unsigned c = 0; c < channels; ++c) {
+            ASSERT_EQ(expected[c], destination[i * channels + c])
+                << "value " << (i & 0xFF) << " alpha " << (i >> 8) << " channel " << c;
+        }
+    }
+}
+
+TEST(GraphicsContext3DPackingTest, RGBA8ToRGBA8Premultiply)
+{
+    std::vector<uint8_t> source;
+    fillAllPairs(source);
+    std::vector<uint8_t> destination(pixelCount * 4);
+    unsigned done = SIMD::packOneRowOfRGBA8ToRGBA8Scaled(&source[0], &destination[0], pixelCount,
+                                                         SIMD::premultiplyScaleTable, false);
+    expectSameAsScalar<uint8_t>(done, source, destination, 4, packRGBA8ToRGBA8Premultiply);
+}
+
+TEST(GraphicsContext3DPackingTest, RGBA8ToRGBA8Unmultiply)
+{
+    std::vector<uint8_t> source;
+    fillAllPairs(source);
+    std::vector<uint8_t> destination(pixelCount * 4);
+    unsigned done = SIMD::packOneRowOfRGBA8ToRGBA8Scaled(&source[0], &destination[0], pixelCount,
+                                                         SIMD::unmultiplyScaleTable, false);
+    expectSameAsScalar<uint8_t>(done, source, destination, 4, packRGBA8ToRGBA8Unmultiply);
+}
+
+TEST(GraphicsContext3DPackingTest, BGRA8ToRGBA8)
+{
+    std::vector<uint8_t> source;
+    fillAllPairs(source);
+    std::vector<uint8_t> destination(pixelCount * 4);
+    unsigned done = SIMD::packOneRowOfBGRA8ToRGBA8(&source[0], &destination[0], pixelCount);
+    expectSameAsScalar<uint8_t>(done, source, destination, 4, packBGRA8ToRGBA8);
+}
+
+TEST(GraphicsContext3DPackingTest, BGRA8ToRGBA8Premultiply)
+{
+    std::vector<uint8_t> source;
+    fillAllPairs(source);
+    std::vector<uint8_t> destination(pixelCount * 4);
+    unsigned done = SIMD::packOneRowOfRGBA8ToRGBA8Scaled(&source[0], &destination[0], pixelCount,
+                                                         SIMD::premultiplyScaleTable, true);
+    expectSameAsScalar<uint8_t>(done, source, destination, 4, packBGRA8ToRGBA8Premultiply);
+}
+
+TEST(GraphicsContext3DPackingTest, RGBA8ToUnsignedShort565)
+{
+    std::vector<uint8_t> source;
+    fillAllPairs(source);
+    std::vector<uint16_t> destination(pixelCount);
+    unsigned done = SIMD::packOneRowOfRGBA8ToUnsignedShort565(&source[0], &destination[0], pixelCount);
+    expectSameAsScalar<uint16_t>(done, source, destination, 1, packRGBA8ToUnsignedShort565);
+}
+
+#if defined(HAVE_PACKING_SIMD_RGB8)
+TEST(GraphicsContext3DPackingTest, RGBA8ToRGB8)
+{
+    std::vector<uint8_t> source;
+    fillAllPairs(source);
+    std::vector<uint8_t> destination(pixelCount * 3);
+    unsigned done = SIMD::packOneRowOfRGBA8ToRGB8(&source[0], &destination[0], pixelCount);
+    expectSameAsScalar<uint8_t>(done, source, destination, 3, packRGBA8ToRGB8);
+}
+
+TEST(GraphicsContext3DPackingTest, RGBA8ToRGB8Premultiply)
+{
+    std::vector<uint8_t> source;
+    fillAllPairs(source);
+    std::vector<uint8_t> destination(pixelCount * 3);
+    unsigned done = SIMD::packOneRowOfRGBA8ToRGB8Scaled(&source[0], &destination[0], pixelCount,
+                                                        SIMD::premultiplyScaleTable);
+    expectSameAsScalar<uint8_t>(done, source, destination, 3, packRGBA8ToRGB8Premultiply);
+}
+#endif // defined(HAVE_PACKING_SIMD_RGB8)
+
+#endif // defined(HAVE_PACKING_SIMD)
+
+} // namespace WebCore
@@ -115,7 +115,10 @@ PictureSet::PictureSet(SkPicture* picture) :
         Bucket* bucket = (*buckets)[i];
         for (unsigned int j = 0; j < bucket->size(); j++) {
             BucketPicture& bucketPicture = (*bucket)[j];
+            if (bucketPicture.mPicture)
+                continue;
             const SkIRect& inval = bucketPicture.mRealArea;
+            uint32_t startTime = getThreadMsec();
             SkPicture *splitPicture = new SkPicture();
             SkCanvas *canvas = splitPicture->beginRecording(
                     inval.width(), inval.height(),
@@ -123,8 +126,8 @@ PictureSet::PictureSet(SkPicture* picture) :
             canvas->translate(-inval.fLeft, -inval.fTop);
             picture->draw(canvas);
             splitPicture->endRecording();
-            SkSafeUnref(bucketPicture.mPicture);
             bucketPicture.mPicture = splitPicture;
+            bucketPicture.mRecordTime = getThreadMsec() - startTime;
         }
     }
     buckets->clear();
@@ -206,7 +209,7 @@ void PictureSet::displayBucket(Bucket* bucket)
     BucketPicture* first = bucket->begin();
     BucketPicture* last = bucket->end();
     for (BucketPicture* current = first; current != last; current++) {
-        XLOGC("- in %x, bucketPicture %d,%d,%d,%d - %dx%d, picture: %x, base: %x",
+        XLOGC("- in %x, bucketPicture %d,%d,%d,%d - %dx%d, picture: %x, base: %x, recorded in %dms",
               bucket,
               current->mArea.fLeft,
               current->mArea.fTop,
@@ -215,7 +218,8 @@ void PictureSet::displayBucket(Bucket* bucket)
               current->mArea.width(),
               current->mArea.height(),
               current->mPicture,
-              current->mBase);
+              current->mBase,
+              current->mRecordTime);
     }
 }
 
@@ -281,7 +285,7 @@ void PictureSet::addToBucket(Bucket* bucket, int dx, int dy, SkIRect& rect)
     SkRegion region;
     SkIRect area = totalArea;
     area.offset(dx, dy);
-    BucketPicture picture = { 0, totalArea, area, false };
+    BucketPicture picture = { 0, totalArea, area, false, 0 };
 
     bucket->append(picture);
 
@@ -349,6 +353,9 @@ void PictureSet::gatherBucketsForArea(WTF::Vector<Bucket*>& list, const SkIRect&
           rect.fLeft, rect.fTop, rect.fRight, rect.fBottom,
           rect.width(), rect.height());
 
+    if (rect.isEmpty())
+        return;
+
     if (!mBucketSizeX || !mBucketSizeY) {
         XLOGC("PictureSet::gatherBucketsForArea() called with bad bucket size: x=%d y=%d",
               mBucketSizeX, mBucketSizeY);
@@ -359,8 +366,8 @@ void PictureSet::gatherBucketsForArea(WTF::Vector<Bucket*>& list, const SkIRect&
     int y = rect.fTop;
     int firstTileX = rect.fLeft / mBucketSizeX;
     int firstTileY = rect.fTop / mBucketSizeY;
-    int lastTileX = rect.fRight / mBucketSizeX;
-    int lastTileY = rect.fBottom / mBucketSizeY;
+    int lastTileX = (rect.fRight - 1) / mBucketSizeX;
+    int lastTileY = (rect.fBottom - 1) / mBucketSizeY;
 
     for (int i = firstTileX; i <= lastTileX; i++) {
         for (int j = firstTileY; j <= lastTileY; j++) {
@@ -381,6 +388,9 @@ void PictureSet::splitAdd(const SkIRect& rect)
           rect.fLeft, rect.fTop, rect.fRight, rect.fBottom,
           rect.width(), rect.height());
 
+    if (rect.isEmpty())
+        return;
+
     if (!mBucketSizeX || !mBucketSizeY) {
         XLOGC("PictureSet::splitAdd() called with bad bucket size: x=%d y=%d",
               mBucketSizeX, mBucketSizeY);
@@ -392,8 +402,8 @@ void PictureSet::splitAdd(const SkIRect& rect)
     int y = rect.fTop;
     int firstTileX = rect.fLeft / mBucketSizeX;
     int firstTileY = rect.fTop / mBucketSizeY;
-    int lastTileX = rect.fRight / mBucketSizeX;
-    int lastTileY = rect.fBottom / mBucketSizeY;
+    int lastTileX = (rect.fRight - 1) / mBucketSizeX;
+    int lastTileY = (rect.fBottom - 1) / mBucketSizeY;
 
     XLOG("--- firstTile(%d, %d) lastTile(%d, %d)",
           firstTileX, firstTileY,
@@ -410,18 +420,32 @@ void PictureSet::splitAdd(const SkIRect& rect)
             int deltaY = j * mBucketSizeY;
             int left = (i == firstTileX) ? rect.fLeft - deltaX : 0;
             int top = (j == firstTileY) ? rect.fTop - deltaY : 0;
-            int right = (i == lastTileX) ? rect.fRight % mBucketSizeX : mBucketSizeX;
-            int bottom = (j == lastTileY) ? rect.fBottom % mBucketSizeY : mBucketSizeY;
+            int right = (i == lastTileX) ? rect.fRight - deltaX : mBucketSizeX;
+            int bottom = (j == lastTileY) ? rect.fBottom - deltaY : mBucketSizeY;
 
             newRect.set(left, top, right, bottom);
             addToBucket(bucket, deltaX, deltaY, newRect);
-            mUpdatedBuckets.append(bucket);
+            // only the pictures invalidated in the bucket will be recorded again
+            if (!mUpdatedBuckets.contains(bucket))
+                mUpdatedBuckets.append(bucket);
         }
     }
 
     XLOG("--- splitAdd DONE\n");
 }
 
+void PictureSet::gatherRecordTimes(WTF::Vector<BucketRecordTime>& times) const
+{
+    for (BucketMap::const_iterator iter = mBuckets.begin(); iter != mBuckets.end(); ++iter) {
+        uint32_t recordTime = 0;
+        Bucket* bucket = iter->second;
+        for (unsigned int i = 0; i < bucket->size(); i++)
+            recordTime += bucket->at(i).mRecordTime;
+        BucketPosition position(iter->first.first - 1, iter->first.second - 1);
+        times.append(BucketRecordTime(position, recordTime));
+    }
+}
+
 #endif // FAST_PICTURESET
 
 // This function is used to maintain the list of Pictures.
@@ -678,9 +702,10 @@ void PictureSet::clear()
              SkSafeUnref(current->mPicture);
              current->mPicture = 0;
          }
-         bucket->clear();
+         delete bucket;
     }
     mBuckets.clear();
+    mUpdatedBuckets.clear();
     mBucketSizeX = mBucketSizeY = BUCKET_SIZE;
 #else
     Pictures* last = mPictures.end();
@@ -998,7 +1023,8 @@ void PictureSet::set(const PictureSet& src)
                   iter->first.first, iter->first.second);
              SkSafeRef(current->mPicture);
              BucketPicture picture = { current->mPicture, current->mArea,
-                                       current->mRealArea, current->mBase };
+                                       current->mRealArea, current->mBase,
+                                       current->mRecordTime };
              targetBucket->append(picture);
          }
     }
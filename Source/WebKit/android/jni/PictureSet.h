@@ -45,7 +45,7 @@
 #include <wtf/Vector.h>
 #include <wtf/HashMap.h>
 
-// #define FAST_PICTURESET // use a hierarchy of pictures
+#define FAST_PICTURESET // use a hierarchy of pictures
 
 class SkCanvas;
 class SkPicture;
@@ -59,11 +59,13 @@ namespace android {
         SkIRect mArea;
         SkIRect mRealArea;
         bool mBase;
+        uint32_t mRecordTime; // ms spent recording mPicture
     };
 
     typedef std::pair<int, int> BucketPosition;
     typedef WTF::Vector<BucketPicture> Bucket;
     typedef WTF::HashMap<BucketPosition , Bucket* > BucketMap;
+    typedef std::pair<BucketPosition, uint32_t> BucketRecordTime;
 #endif
 
     class PictureSet {
@@ -81,6 +83,8 @@ namespace android {
         void addToBucket(Bucket* bucket, int dx, int dy, SkIRect& rect);
         void gatherBucketsForArea(WTF::Vector<Bucket*>& list, const SkIRect& rect);
         void splitAdd(const SkIRect& rect);
+        // record time of the pictures of each bucket, in ms
+        void gatherRecordTimes(WTF::Vector<BucketRecordTime>& times) const;
 #endif
 
         void add(const SkRegion& area, SkPicture* picture,
@@ -127,6 +127,11 @@
 #include "autofill/WebAutofill.h"
 #endif
 
+#if ENABLE(WEBGL)
+#include "GraphicsContext3DImageCache.h"
+#include "GraphicsContext3DShaderCache.h"
+#endif
+
 using namespace JSC::Bindings;
 
 static String* gUploadFileLabel;
@@ -1922,6 +1927,11 @@ static void ClearWebCoreCache()
     WebCore::pageCache()->setCapacity(0);
     WebCore::pageCache()->releaseAutoreleasedPagesNow();
     WebCore::pageCache()->setCapacity(pageCapacity);
+
+#if ENABLE(WEBGL)
+    WebCore::GraphicsContext3DImageCache::instance()->clear();
+    WebCore::GraphicsContext3DShaderCache::instance()->clear();
+#endif
 }
 
 static void ClearWebViewCache()
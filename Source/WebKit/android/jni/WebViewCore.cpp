@@ -163,6 +163,11 @@ FILE* gRenderTreeFile = 0;
 #include "RenderLayerCompositor.h"
 #endif
 
+#if ENABLE(WEBGL)
+#include "GraphicsContext3DImageCache.h"
+#include "GraphicsContext3DShaderCache.h"
+#endif
+
 #if USE(V8)
 #include <v8.h>
 #endif
@@ -859,10 +864,16 @@ void WebViewCore::rebuildPictureSet(PictureSet* pictureSet)
         Bucket* bucket = (*buckets)[i];
         for (unsigned int j = 0; j < bucket->size(); j++) {
             BucketPicture& bucketPicture = (*bucket)[j];
+            // pictures outside of the invalidated area are still valid
+            if (bucketPicture.mPicture)
+                continue;
             const SkIRect& inval = bucketPicture.mRealArea;
-            SkPicture* picture = rebuildPicture(inval);
-            SkSafeUnref(bucketPicture.mPicture);
-            bucketPicture.mPicture = picture;
+            uint32_t startTime = getThreadMsec();
+            bucketPicture.mPicture = rebuildPicture(inval);
+            bucketPicture.mRecordTime = getThreadMsec() - startTime;
+            DBG_SET_LOGD("pictSet=%p bucket=%p {%d,%d,w=%d,h=%d} recorded in %dms",
+                pictureSet, bucket, inval.fLeft, inval.fTop, inval.width(),
+                inval.height(), bucketPicture.mRecordTime);
         }
     }
     buckets->clear();
@@ -4533,6 +4544,11 @@ static void Resume(JNIEnv* env, jobject obj)
 
 static void FreeMemory(JNIEnv* env, jobject obj)
 {
+#if ENABLE(WEBGL)
+    GraphicsContext3DImageCache::instance()->clear();
+    GraphicsContext3DShaderCache::instance()->clear();
+#endif
+
     ANPEvent event;
     SkANP::InitEvent(&event, kLifecycle_ANPEventType);
     event.data.lifecycle.action = kFreeMemory_ANPLifecycleAction;
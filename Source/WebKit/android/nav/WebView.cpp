@@ -37,13 +37,18 @@
 #include "FindCanvas.h"
 #include "Frame.h"
 #include "GraphicsJNI.h"
+#if ENABLE(WEBGL)
+#include "GraphicsContext3DInternal.h"
+#endif
 #include "HTMLInputElement.h"
+#include "ImagesManager.h"
 #include "IntPoint.h"
 #include "IntRect.h"
 #include "LayerAndroid.h"
 #include "Node.h"
 #include "utils/Functor.h"
 #include "private/hwui/DrawGlInfo.h"
+#include "PixelBufferPool.h"
 #include "PlatformGraphicsContext.h"
 #include "PlatformString.h"
 #include "ScrollableLayerAndroid.h"
@@ -2606,11 +2611,87 @@ static bool nativeSetProperty(JNIEnv *env, jobject obj, jstring jkey, jstring jv
         TilesManager::instance()->setUseMinimalMemory(value == "true");
         return true;
     }
+    else if (key == "textures_generator_count") {
+        TilesManager::instance()->setTexturesGeneratorCount(value.toInt());
+        return true;
+    }
+#if ENABLE(WEBGL)
+    else if (key == "webgl_max_swap_chain_depth") {
+        GraphicsContext3DInternal::setMaxSwapChainDepth(value.toInt());
+        return true;
+    }
+#endif
+    else if (key == "tile_profiling_dump") {
+        // value is the path of the file to write the timings to
+        return TilesManager::instance()->getProfiler()->dumpTimings(value.utf8().data());
+    }
     return false;
 }
 
-static jstring nativeGetProperty(JNIEnv *env, jobject obj, jstring key)
+static jstring nativeGetProperty(JNIEnv *env, jobject obj, jstring jkey)
 {
+    WTF::String key = jstringToWtfString(env, jkey);
+    if (key == "texture_picks") {
+        unsigned int freePicks = 0;
+        unsigned int scalePicks = 0;
+        unsigned int stolenPicks = 0;
+        unsigned int failedPicks = 0;
+        TilesManager::instance()->gatherTexturePicks(&freePicks, &scalePicks,
+                                                     &stolenPicks, &failedPicks);
+        WTF::String value = WTF::String::format("free=%u scale=%u stolen=%u failed=%u",
+                                                freePicks, scalePicks,
+                                                stolenPicks, failedPicks);
+        return wtfStringToJstring(env, value);
+    } else if (key == "pixel_buffers") {
+        size_t inUseBytes = 0;
+        size_t idleBytes = 0;
+        size_t highWaterBytes = 0;
+        unsigned int reused = 0;
+        unsigned int allocated = 0;
+        PixelBufferPool::instance()->gatherStats(&inUseBytes, &idleBytes, &highWaterBytes,
+                                                 &reused, &allocated);
+        WTF::String value = WTF::String::format("in_use=%u idle=%u high_water=%u "
+                                                "reused=%u allocated=%u",
+                                                inUseBytes, idleBytes, highWaterBytes,
+                                                reused, allocated);
+        return wtfStringToJstring(env, value);
+#if ENABLE(WEBGL)
+    } else if (key == "webgl_swap_chain") {
+        GraphicsContext3DInternal::SwapChainStatistics stats =
+            GraphicsContext3DInternal::swapChainStatistics();
+        WTF::String value = WTF::String::format("max_depth=%d dequeues=%u waits=%u "
+                                                "total_wait_ms=%.1f max_wait_ms=%.1f",
+                                                stats.depth, stats.dequeueCount, stats.waitCount,
+                                                stats.totalWaitTime * 1000, stats.maxWaitTime * 1000);
+        return wtfStringToJstring(env, value);
+#endif
+    } else if (key == "gl_calls") {
+        unsigned int counts[ShaderProgram::GLCallTypeCount];
+        TilesManager::instance()->shader()->gatherGLCalls(counts);
+        WTF::String value = WTF::String::format("draws=%u programs=%u binds=%u "
+                                                "texparams=%u uniforms=%u elided=%u",
+                                                counts[ShaderProgram::DrawCall],
+                                                counts[ShaderProgram::ProgramSwitch],
+                                                counts[ShaderProgram::TextureBind],
+                                                counts[ShaderProgram::TexParameterCall],
+                                                counts[ShaderProgram::UniformUpload],
+                                                counts[ShaderProgram::ElidedCall]);
+        return wtfStringToJstring(env, value);
+    } else if (key == "picture_record_times") {
+        BaseLayerAndroid* baseLayer = GET_NATIVE_VIEW(env, obj)->getBaseLayer();
+        if (!baseLayer)
+            return 0;
+        WTF::Vector<BucketRecordTime> times;
+        baseLayer->content()->gatherRecordTimes(times);
+        WTF::String value;
+        for (unsigned int i = 0; i < times.size(); i++) {
+            value.append(WTF::String::format("%s%d,%d=%u", i ? " " : "",
+                                             times[i].first.first,
+                                             times[i].first.second,
+                                             times[i].second));
+        }
+        return wtfStringToJstring(env, value);
+    }
     return 0;
 }
 
@@ -2619,6 +2700,8 @@ static void nativeOnTrimMemory(JNIEnv *env, jobject obj, jint level)
     if (TilesManager::hardwareAccelerationEnabled()) {
         bool freeAllTextures = (level > TRIM_MEMORY_UI_HIDDEN);
         TilesManager::instance()->deallocateTextures(freeAllTextures);
+        ImagesManager::instance()->releaseUnusedImages();
+        PixelBufferPool::instance()->trim();
     }
 }
 